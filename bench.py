@@ -0,0 +1,106 @@
+#!/usr/bin/python3
+
+# build and run every benchmark under map/bench and priority_queue/bench,
+# collect their JSON lines and optionally compare them against a stored baseline.
+#
+#     ./bench.py                                   run everything up to n = 1e6
+#     ./bench.py --max-n 100000000                 go up to 1e8 elements
+#     ./bench.py --only map --filter find          a subset
+#     ./bench.py --save-baseline baseline.json     store this run as the baseline
+#     ./bench.py --baseline baseline.json          fail if something got slower than the threshold
+
+import argparse
+import glob
+import json
+import os
+import subprocess
+import sys
+
+root = os.path.dirname(os.path.abspath(__file__))
+build = os.path.join(root, '_bench_build')
+suites = ('map', 'priority_queue')
+
+
+def key_of(r):
+    return (r['suite'], r['op'], r['impl'], r['key'], r['dist'], r['n'])
+
+
+def compile_bench(suite, src):
+    exe = os.path.join(build, suite + '_' + os.path.splitext(os.path.basename(src))[0])
+    cmd = ['g++', '-O2', '-std=c++14', '-pthread', '-I' + os.path.join(root, suite), src, '-o', exe]
+    if subprocess.call(cmd) != 0:
+        sys.exit('failed to compile ' + src)
+    return exe
+
+
+def run_bench(exe, args):
+    argv = [exe, '--min-n', str(args.min_n), '--max-n', str(args.max_n), '--min-time', str(args.min_time)]
+    if args.filter:
+        argv += ['--filter', args.filter]
+    out = subprocess.run(argv, cwd=build, stdout=subprocess.PIPE, universal_newlines=True).stdout
+    results = []
+    for line in out.splitlines():
+        line = line.strip()
+        if line.startswith('{'):
+            results.append(json.loads(line))
+            print(line)
+    return results
+
+
+def compare(results, baseline, threshold):
+    old = {key_of(r): r['ns_per_op'] for r in baseline}
+    bad = 0
+    for r in results:
+        k = key_of(r)
+        if k not in old or old[k] <= 0:
+            continue
+        ratio = r['ns_per_op'] / old[k]
+        if ratio > 1 + threshold:
+            bad += 1
+            print('REGRESSION %-60s %10.3f -> %10.3f ns/op (%+.1f%%)' %
+                  ('/'.join(str(x) for x in k), old[k], r['ns_per_op'], (ratio - 1) * 100))
+        elif ratio < 1 - threshold:
+            print('improved   %-60s %10.3f -> %10.3f ns/op (%+.1f%%)' %
+                  ('/'.join(str(x) for x in k), old[k], r['ns_per_op'], (ratio - 1) * 100))
+    return bad
+
+
+def run():
+    p = argparse.ArgumentParser()
+    p.add_argument('--only', choices=suites)
+    p.add_argument('--bench', help='only run benchmarks whose file name contains this')
+    p.add_argument('--filter', help='passed to every benchmark, selects cases by name')
+    p.add_argument('--min-n', type=int, default=1000)
+    p.add_argument('--max-n', type=int, default=1000000)
+    p.add_argument('--min-time', type=float, default=100, help='milliseconds per measurement')
+    p.add_argument('--out', default=os.path.join(root, 'bench_results.json'))
+    p.add_argument('--baseline', help='compare against this file')
+    p.add_argument('--save-baseline', help='also write the results here')
+    p.add_argument('--threshold', type=float, default=0.10, help='allowed slowdown, 0.10 = 10%%')
+    args = p.parse_args()
+
+    os.makedirs(build, exist_ok=True)
+    results = []
+    for suite in suites:
+        if args.only and args.only != suite:
+            continue
+        for src in sorted(glob.glob(os.path.join(root, suite, 'bench', '*.cpp'))):
+            if args.bench and args.bench not in os.path.basename(src):
+                continue
+            results += run_bench(compile_bench(suite, src), args)
+
+    for path in (args.out, args.save_baseline):
+        if path:
+            with open(path, 'w') as f:
+                json.dump(results, f, indent=1)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            bad = compare(results, json.load(f), args.threshold)
+        if bad:
+            print('%d regression(s) over %.0f%%' % (bad, args.threshold * 100))
+            sys.exit(1)
+        print('no regression over %.0f%%' % (args.threshold * 100))
+
+
+run()
@@ -0,0 +1,983 @@
+#ifndef SJTU_ART_MAP_HPP
+#define SJTU_ART_MAP_HPP
+
+// an ordered map for string keys, an adaptive radix tree.
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu
+{
+	/**
+	 * a map from std::string, ordered like std::less<std::string>, as an adaptive radix tree:
+	 * an inner node branches on one byte of the key and comes in four sizes,
+	 * 4 and 16 children with a sorted array of bytes, 48 with a 256-byte index,
+	 * and 256 with a direct array, so a node grows and shrinks with its fan-out.
+	 * a node remembers the byte it branches on, so the bytes shared by its whole subtree
+	 * are skipped (path compression); the first of them are kept in the node to stop
+	 * most misses early, and a lookup ends with one comparison of the full key at the leaf,
+	 * instead of one per level as in the red-black map.
+	 * a key that is a prefix of other keys sits in the node where it ends, before its children.
+	 *
+	 * leaves are threaded by nxt/pre in key order like the nodes of RBTree,
+	 * which gives ordered iteration, lower_bound and prefix_range in one descent.
+	 * leaves never move: iterators stay valid until their element is erased.
+	 * keys are limited to 4 GiB, longer ones throw runtime_error on insert.
+	 */
+	template <class T>
+	class art_map
+	{
+	public:
+		typedef std::string key_type;
+		typedef T mapped_type;
+		typedef pair<const std::string, T> value_type;
+
+	private:
+		typedef std::uintptr_t Slot; // a tagged child: 0 for none, low bit set for a leaf
+		typedef const unsigned char *Bytes;
+
+		static const size_t MaxPrefix = 5; // with the fields before it, the header of a node fits in 20 bytes
+
+		struct Leaf
+		{
+			value_type ValueField;
+			Leaf *nxt, *pre;
+
+			Leaf(const std::string &_Key, const T &_Val) : ValueField(_Key, _Val), nxt(nullptr), pre(nullptr) {}
+		};
+
+		enum Kind : unsigned char
+		{
+			N4,
+			N16,
+			N48,
+			N256
+		};
+
+		struct Node
+		{
+			Leaf *Term;						 // the element whose key ends at Depth
+			std::uint32_t Depth;			 // the byte this node branches on, the bytes before it are shared below
+			unsigned short Count;			 // children, Term not included
+			Kind Type;
+			unsigned char Prefix[MaxPrefix]; // the first bytes skipped between the parent and Depth
+
+			Node(Kind _Type, size_t _Depth) : Term(nullptr), Depth(std::uint32_t(_Depth)), Count(0), Type(_Type) {}
+		};
+
+		struct Node4 : Node
+		{
+			unsigned char Keys[4];
+			Slot Child[4];
+
+			explicit Node4(size_t _Depth) : Node(N4, _Depth) {}
+		};
+
+		struct Node16 : Node
+		{
+			unsigned char Keys[16];
+			Slot Child[16];
+
+			explicit Node16(size_t _Depth) : Node(N16, _Depth) { std ::memset(Keys, 0, sizeof(Keys)); }
+		};
+
+		struct Node48 : Node
+		{
+			unsigned char Index[256]; // 1 + the slot of the child of each byte, 0 for none
+			Slot Child[48];
+
+			explicit Node48(size_t _Depth) : Node(N48, _Depth) { std ::memset(Index, 0, sizeof(Index)); }
+		};
+
+		struct Node256 : Node
+		{
+			Slot Child[256];
+
+			explicit Node256(size_t _Depth) : Node(N256, _Depth) { std ::memset(Child, 0, sizeof(Child)); }
+		};
+
+		static bool is_leaf(Slot s) { return s & 1; }
+		static Leaf *as_leaf(Slot s) { return reinterpret_cast<Leaf *>(s & ~Slot(1)); }
+		static Node *as_node(Slot s) { return reinterpret_cast<Node *>(s); }
+		static Slot tag(Leaf *x) { return reinterpret_cast<Slot>(x) | 1; }
+		static Slot tag(Node *x) { return reinterpret_cast<Slot>(x); }
+
+		static Bytes bytes(const std::string &s) { return reinterpret_cast<Bytes>(s.data()); }
+		static Bytes bytes(const Leaf *x) { return bytes(x->ValueField.first); }
+		static size_t length(const Leaf *x) { return x->ValueField.first.size(); }
+
+		/**
+		 * compare like std::string::compare, bytes as unsigned char.
+		 */
+		static int compare(Bytes a, size_t an, Bytes b, size_t bn)
+		{
+			int c = std ::memcmp(a, b, an < bn ? an : bn);
+			return c ? c : (an < bn ? -1 : an > bn);
+		}
+
+		static size_t capacity(Kind t)
+		{
+			static const size_t Cap[] = {4, 16, 48, 256};
+			return Cap[t];
+		}
+
+		/**
+		 * below this many children a node is rebuilt one size smaller,
+		 * a bit under the capacity of that size so that it does not flip back at once.
+		 */
+		static size_t shrink_at(Kind t)
+		{
+			static const size_t At[] = {0, 3, 12, 40};
+			return At[t];
+		}
+
+		static void free_node(Node *x)
+		{
+			switch (x->Type)
+			{
+			case N4:
+				delete static_cast<Node4 *>(x);
+				break;
+			case N16:
+				delete static_cast<Node16 *>(x);
+				break;
+			case N48:
+				delete static_cast<Node48 *>(x);
+				break;
+			default:
+				delete static_cast<Node256 *>(x);
+			}
+		}
+
+		static Slot *find(Node *x, unsigned char b)
+		{
+			switch (x->Type)
+			{
+			case N4:
+			{
+				Node4 *y = static_cast<Node4 *>(x);
+				for (int i = 0; i < x->Count; i++)
+					if (y->Keys[i] == b)
+						return y->Child + i;
+				return nullptr;
+			}
+			case N16:
+			{
+				Node16 *y = static_cast<Node16 *>(x);
+#ifdef __SSE2__
+				__m128i Eq = _mm_cmpeq_epi8(_mm_set1_epi8(char(b)), _mm_loadu_si128(reinterpret_cast<const __m128i *>(y->Keys)));
+				int Hit = _mm_movemask_epi8(Eq) & ((1 << x->Count) - 1);
+				return Hit ? y->Child + __builtin_ctz(Hit) : nullptr;
+#else
+				for (int i = 0; i < x->Count; i++)
+					if (y->Keys[i] == b)
+						return y->Child + i;
+				return nullptr;
+#endif
+			}
+			case N48:
+			{
+				Node48 *y = static_cast<Node48 *>(x);
+				return y->Index[b] ? y->Child + y->Index[b] - 1 : nullptr;
+			}
+			default:
+			{
+				Node256 *y = static_cast<Node256 *>(x);
+				return y->Child[b] ? y->Child + b : nullptr;
+			}
+			}
+		}
+
+		/**
+		 * the child of the least byte greater than b, 0 if none; b = -1 gives the first child.
+		 */
+		static Slot next(Node *x, int b)
+		{
+			switch (x->Type)
+			{
+			case N4:
+			case N16:
+			{
+				const unsigned char *Keys = x->Type == N4 ? static_cast<Node4 *>(x)->Keys : static_cast<Node16 *>(x)->Keys;
+				const Slot *Child = x->Type == N4 ? static_cast<Node4 *>(x)->Child : static_cast<Node16 *>(x)->Child;
+				for (int i = 0; i < x->Count; i++)
+					if (Keys[i] > b)
+						return Child[i];
+				return 0;
+			}
+			case N48:
+			{
+				Node48 *y = static_cast<Node48 *>(x);
+				for (int c = b + 1; c < 256; c++)
+					if (y->Index[c])
+						return y->Child[y->Index[c] - 1];
+				return 0;
+			}
+			default:
+			{
+				Node256 *y = static_cast<Node256 *>(x);
+				for (int c = b + 1; c < 256; c++)
+					if (y->Child[c])
+						return y->Child[c];
+				return 0;
+			}
+			}
+		}
+
+		static Slot last(Node *x)
+		{
+			switch (x->Type)
+			{
+			case N4:
+				return static_cast<Node4 *>(x)->Child[x->Count - 1];
+			case N16:
+				return static_cast<Node16 *>(x)->Child[x->Count - 1];
+			case N48:
+			{
+				Node48 *y = static_cast<Node48 *>(x);
+				for (int c = 255;; c--)
+					if (y->Index[c])
+						return y->Child[y->Index[c] - 1];
+			}
+			default:
+			{
+				Node256 *y = static_cast<Node256 *>(x);
+				for (int c = 255;; c--)
+					if (y->Child[c])
+						return y->Child[c];
+			}
+			}
+		}
+
+		/**
+		 * call f(byte, child) for every child in the order of the bytes.
+		 */
+		template <class F>
+		static void each(Node *x, F f)
+		{
+			switch (x->Type)
+			{
+			case N4:
+				for (int i = 0; i < x->Count; i++)
+					f(static_cast<Node4 *>(x)->Keys[i], static_cast<Node4 *>(x)->Child[i]);
+				break;
+			case N16:
+				for (int i = 0; i < x->Count; i++)
+					f(static_cast<Node16 *>(x)->Keys[i], static_cast<Node16 *>(x)->Child[i]);
+				break;
+			case N48:
+			{
+				Node48 *y = static_cast<Node48 *>(x);
+				for (int c = 0; c < 256; c++)
+					if (y->Index[c])
+						f((unsigned char)c, y->Child[y->Index[c] - 1]);
+				break;
+			}
+			default:
+			{
+				Node256 *y = static_cast<Node256 *>(x);
+				for (int c = 0; c < 256; c++)
+					if (y->Child[c])
+						f((unsigned char)c, y->Child[c]);
+			}
+			}
+		}
+
+		static void put_sorted(unsigned char *Keys, Slot *Child, int Count, unsigned char b, Slot s)
+		{
+			int i = Count;
+			for (; i && Keys[i - 1] > b; i--)
+			{
+				Keys[i] = Keys[i - 1];
+				Child[i] = Child[i - 1];
+			}
+			Keys[i] = b;
+			Child[i] = s;
+		}
+
+		static void take_sorted(unsigned char *Keys, Slot *Child, int Count, unsigned char b)
+		{
+			int i = 0;
+			while (Keys[i] != b)
+				i++;
+			std ::memmove(Keys + i, Keys + i + 1, Count - i - 1);
+			std ::memmove(Child + i, Child + i + 1, sizeof(Slot) * (Count - i - 1));
+		}
+
+		/**
+		 * add the child s at byte b to x, which has room for it. one overload per size, so that
+		 * a node is only ever written through its own type.
+		 */
+		static void put(Node4 *x, unsigned char b, Slot s)
+		{
+			put_sorted(x->Keys, x->Child, x->Count++, b, s);
+		}
+
+		static void put(Node16 *x, unsigned char b, Slot s)
+		{
+			put_sorted(x->Keys, x->Child, x->Count++, b, s);
+		}
+
+		static void put(Node48 *x, unsigned char b, Slot s)
+		{
+			x->Child[x->Count] = s;
+			x->Index[b] = (unsigned char)(x->Count + 1);
+			x->Count++;
+		}
+
+		static void put(Node256 *x, unsigned char b, Slot s)
+		{
+			x->Child[b] = s;
+			x->Count++;
+		}
+
+		/**
+		 * a copy of x as a To, x is freed.
+		 */
+		template <class To>
+		static To *rebuild(Node *x)
+		{
+			To *y = new To(x->Depth);
+			y->Term = x->Term;
+			std ::memcpy(y->Prefix, x->Prefix, MaxPrefix);
+			each(x, [&](unsigned char b, Slot s) { put(y, b, s); });
+			free_node(x);
+			return y;
+		}
+
+		/**
+		 * add the child s at byte b to x in *p, growing it into a To if full.
+		 */
+		template <class From, class To>
+		static void add(Slot *p, From *x, unsigned char b, Slot s)
+		{
+			if (x->Count < capacity(x->Type))
+				put(x, b, s);
+			else
+			{
+				To *y = rebuild<To>(x);
+				put(y, b, s);
+				*p = tag(y);
+			}
+		}
+
+		/**
+		 * add the child s at byte b to the node in *p, growing it into the next size if full.
+		 */
+		static void add(Slot *p, unsigned char b, Slot s)
+		{
+			Node *x = as_node(*p);
+			switch (x->Type)
+			{
+			case N4:
+				add<Node4, Node16>(p, static_cast<Node4 *>(x), b, s);
+				break;
+			case N16:
+				add<Node16, Node48>(p, static_cast<Node16 *>(x), b, s);
+				break;
+			case N48:
+				add<Node48, Node256>(p, static_cast<Node48 *>(x), b, s);
+				break;
+			default:
+				put(static_cast<Node256 *>(x), b, s);
+			}
+		}
+
+		/**
+		 * remove the child at byte b from the node in *p, shrinking it if it got sparse.
+		 */
+		static void remove(Slot *p, unsigned char b)
+		{
+			Node *x = as_node(*p);
+			switch (x->Type)
+			{
+			case N4:
+				take_sorted(static_cast<Node4 *>(x)->Keys, static_cast<Node4 *>(x)->Child, x->Count, b);
+				break;
+			case N16:
+				take_sorted(static_cast<Node16 *>(x)->Keys, static_cast<Node16 *>(x)->Child, x->Count, b);
+				break;
+			case N48:
+			{
+				// keep the children packed: the last one moves into the hole
+				Node48 *y = static_cast<Node48 *>(x);
+				int i = y->Index[b] - 1, Last = x->Count - 1;
+				y->Index[b] = 0;
+				if (i != Last)
+				{
+					y->Child[i] = y->Child[Last];
+					for (int c = 0; c < 256; c++)
+						if (y->Index[c] == Last + 1)
+						{
+							y->Index[c] = (unsigned char)(i + 1);
+							break;
+						}
+				}
+				break;
+			}
+			default:
+				static_cast<Node256 *>(x)->Child[b] = 0;
+			}
+			x->Count--;
+			if (x->Type == N4 || x->Count > shrink_at(x->Type))
+				return;
+			switch (x->Type)
+			{
+			case N16:
+				*p = tag(rebuild<Node4>(x));
+				break;
+			case N48:
+				*p = tag(rebuild<Node16>(x));
+				break;
+			default:
+				*p = tag(rebuild<Node48>(x));
+			}
+		}
+
+		static Leaf *min_leaf(Slot s)
+		{
+			while (!is_leaf(s))
+			{
+				Node *x = as_node(s);
+				if (x->Term)
+					return x->Term;
+				s = next(x, -1);
+			}
+			return as_leaf(s);
+		}
+
+		static Leaf *max_leaf(Slot s)
+		{
+			while (!is_leaf(s))
+				s = last(as_node(s));
+			return as_leaf(s);
+		}
+
+		/**
+		 * keep the first skipped bytes of x, which start at From, taken from key k.
+		 */
+		static void set_prefix(Node *x, size_t From, Bytes k)
+		{
+			size_t Len = x->Depth - From;
+			std ::memcpy(x->Prefix, k + From, Len < MaxPrefix ? Len : MaxPrefix);
+		}
+
+		/**
+		 * the first position in [From, Depth) where the skipped bytes of x and key k of length n
+		 * differ or k ends, Depth if they match; p is set to the skipped bytes, p[0] at From.
+		 * long prefixes are read from a leaf below, every leaf of the subtree has them.
+		 */
+		static size_t mismatch(Node *x, size_t From, Bytes k, size_t n, Bytes &p)
+		{
+			p = x->Depth - From <= MaxPrefix ? x->Prefix : bytes(min_leaf(tag(x))) + From;
+			size_t End = x->Depth < n ? x->Depth : n, m = From;
+			while (m < End && p[m - From] == k[m])
+				m++;
+			return m;
+		}
+
+		Slot Root;
+		Leaf *Begin, *End;
+		size_t Size;
+
+		/**
+		 * the branch bytes lead to the only candidate, checked in full at the end;
+		 * the kept skipped bytes just stop a miss early.
+		 */
+		Leaf *locate(Bytes k, size_t n) const
+		{
+			Slot s = Root;
+			size_t From = 0;
+			while (s && !is_leaf(s))
+			{
+				Node *x = as_node(s);
+				if (n < x->Depth)
+					return nullptr;
+				size_t Len = x->Depth - From;
+				if (std ::memcmp(x->Prefix, k + From, Len < MaxPrefix ? Len : MaxPrefix))
+					return nullptr;
+				if (n == x->Depth)
+				{
+					s = x->Term ? tag(x->Term) : 0;
+					break;
+				}
+				Slot *p = find(x, k[x->Depth]);
+				s = p ? *p : 0;
+				From = x->Depth + 1;
+			}
+			if (!s)
+				return nullptr;
+			Leaf *l = as_leaf(s);
+			return length(l) == n && !std ::memcmp(bytes(l), k, n) ? l : nullptr;
+		}
+
+		Leaf *locate(const std::string &key) const { return locate(bytes(key), key.size()); }
+
+		/**
+		 * the first leaf of the subtree s whose key is not less than k, nullptr if none.
+		 * the bytes before From are known to match.
+		 */
+		static Leaf *lower(Slot s, size_t From, Bytes k, size_t n)
+		{
+			if (is_leaf(s))
+				return compare(bytes(as_leaf(s)), length(as_leaf(s)), k, n) >= 0 ? as_leaf(s) : nullptr;
+
+			Node *x = as_node(s);
+			Bytes p;
+			size_t m = mismatch(x, From, k, n, p);
+			if (m < x->Depth)
+				return m == n || p[m - From] > k[m] ? min_leaf(s) : nullptr;
+			if (n == x->Depth)
+				return min_leaf(s);
+
+			int b = k[x->Depth];
+			if (Slot *c = find(x, (unsigned char)b))
+				if (Leaf *ans = lower(*c, x->Depth + 1, k, n))
+					return ans;
+			Slot nb = next(x, b);
+			return nb ? min_leaf(nb) : nullptr;
+		}
+
+		Leaf *lower(const std::string &key) const
+		{
+			return Root ? lower(Root, 0, bytes(key), key.size()) : nullptr;
+		}
+
+		Leaf *upper(const std::string &key) const
+		{
+			Leaf *x = lower(key);
+			return x && x->ValueField.first == key ? x->nxt : x;
+		}
+
+		/**
+		 * hang leaf l, whose key k of length n agrees with the subtree of x up to Depth, on x.
+		 */
+		static void place(Node4 *x, Leaf *l, Bytes k, size_t n)
+		{
+			if (n == x->Depth)
+				x->Term = l;
+			else
+				put(x, k[x->Depth], tag(l));
+		}
+
+		std ::pair<Leaf *, bool> insert(const std::string &key, const T &val)
+		{
+			Leaf *Succ = lower(key);
+			if (Succ && Succ->ValueField.first == key)
+				return std ::make_pair(Succ, false);
+
+			if (key.size() > UINT32_MAX)
+				throw runtime_error();
+			Leaf *l = new Leaf(key, val);
+			l->nxt = Succ;
+			l->pre = Succ ? Succ->pre : End;
+			(l->pre ? l->pre->nxt : Begin) = l;
+			(Succ ? Succ->pre : End) = l;
+			Size++;
+
+			Bytes k = bytes(l);
+			size_t n = key.size(), From = 0;
+			Slot *p = &Root;
+			while (*p)
+			{
+				if (is_leaf(*p))
+				{
+					// two leaves: a node where they part
+					Leaf *o = as_leaf(*p);
+					Bytes ok = bytes(o);
+					size_t on = length(o), m = From;
+					while (m < n && m < on && ok[m] == k[m])
+						m++;
+					Node4 *y = new Node4(m);
+					set_prefix(y, From, k);
+					place(y, o, ok, on);
+					place(y, l, k, n);
+					*p = tag(y);
+					return std ::make_pair(l, true);
+				}
+
+				Node *x = as_node(*p);
+				Bytes pk;
+				size_t m = mismatch(x, From, k, n, pk);
+				if (m < x->Depth)
+				{
+					// the key leaves the skipped bytes of x: a node where they part, above x
+					Node4 *y = new Node4(m);
+					set_prefix(y, From, k);
+					put(y, pk[m - From], *p);
+					set_prefix(x, m + 1, bytes(min_leaf(*p)));
+					place(y, l, k, n);
+					*p = tag(y);
+					return std ::make_pair(l, true);
+				}
+
+				if (n == x->Depth)
+				{
+					x->Term = l;
+					return std ::make_pair(l, true);
+				}
+				Slot *q = find(x, k[x->Depth]);
+				if (!q)
+				{
+					add(p, k[x->Depth], tag(l));
+					return std ::make_pair(l, true);
+				}
+				p = q;
+				From = x->Depth + 1;
+			}
+			*p = tag(l);
+			return std ::make_pair(l, true);
+		}
+
+		void erase(Leaf *l)
+		{
+			(l->pre ? l->pre->nxt : Begin) = l->nxt;
+			(l->nxt ? l->nxt->pre : End) = l->pre;
+			Size--;
+
+			Bytes k = bytes(l);
+			size_t From = 0, XFrom = 0;
+			Slot *p = &Root, *px = nullptr;
+			Node *x = nullptr;
+			while (*p != tag(l))
+			{
+				px = p;
+				x = as_node(*p);
+				XFrom = From;
+				if (x->Term == l)
+					break;
+				p = find(x, k[x->Depth]);
+				From = x->Depth + 1;
+			}
+
+			if (!x)
+				Root = 0;
+			else
+			{
+				if (x->Term == l)
+					x->Term = nullptr;
+				else
+					remove(px, k[x->Depth]);
+				x = as_node(*px);
+
+				// a node left with one element is replaced by it; a node without children
+				// holds its Term, or it would not have branched
+				if (!x->Count)
+				{
+					assert(x->Term);
+					*px = tag(x->Term);
+					free_node(x);
+				}
+				else if (x->Count == 1 && !x->Term)
+				{
+					Slot c = next(x, -1);
+					if (!is_leaf(c))
+						set_prefix(as_node(c), XFrom, bytes(min_leaf(c)));
+					*px = c;
+					free_node(x);
+				}
+			}
+			delete l;
+		}
+
+		static void destroy(Slot s)
+		{
+			if (!s)
+				return;
+			if (is_leaf(s))
+			{
+				delete as_leaf(s);
+				return;
+			}
+			Node *x = as_node(s);
+			each(x, [](unsigned char, Slot c) { destroy(c); });
+			delete x->Term;
+			free_node(x);
+		}
+
+		void copy_from(const art_map &other)
+		{
+			for (Leaf *x = other.Begin; x; x = x->nxt)
+				insert(x->ValueField.first, x->ValueField.second);
+		}
+
+		/**
+		 * the first and one past the last leaf whose key starts with k, both nullptr if none.
+		 * the branch bytes of k lead to the only subtree that can hold them,
+		 * and they share whatever its first leaf shares with k.
+		 */
+		std ::pair<Leaf *, Leaf *> cover(Bytes k, size_t n) const
+		{
+			Slot s = Root;
+			while (s && !is_leaf(s) && n > as_node(s)->Depth)
+			{
+				Slot *p = find(as_node(s), k[as_node(s)->Depth]);
+				s = p ? *p : 0;
+			}
+			if (!s)
+				return std ::make_pair((Leaf *)nullptr, (Leaf *)nullptr);
+			Leaf *First = min_leaf(s);
+			if (length(First) < n || std ::memcmp(bytes(First), k, n))
+				return std ::make_pair((Leaf *)nullptr, (Leaf *)nullptr);
+			return std ::make_pair(First, max_leaf(s)->nxt);
+		}
+
+	public:
+		class const_iterator;
+		class iterator
+		{
+			friend class art_map;
+
+		private:
+			art_map *Belong;
+			Leaf *Ptr;
+
+		public:
+			iterator() : Belong(nullptr), Ptr(nullptr) {}
+
+			iterator(art_map *_Belong, Leaf *node) : Belong(_Belong), Ptr(node) {}
+
+			iterator operator++(int)
+			{
+				iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+
+			iterator &operator++()
+			{
+				if (!Ptr)
+					throw invalid_iterator();
+				Ptr = Ptr->nxt;
+				return *this;
+			}
+
+			iterator operator--(int)
+			{
+				iterator tmp = *this;
+				--*this;
+				return tmp;
+			}
+
+			iterator &operator--()
+			{
+				Leaf *p = Ptr ? Ptr->pre : Belong->End;
+				if (!p)
+					throw invalid_iterator();
+				Ptr = p;
+				return *this;
+			}
+
+			value_type &operator*() const { return Ptr->ValueField; }
+
+			bool operator==(const iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+
+			bool operator==(const const_iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+
+			bool operator!=(const iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+
+			bool operator!=(const const_iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+
+			value_type *operator->() const noexcept { return &(Ptr->ValueField); }
+		};
+		class const_iterator
+		{
+			friend class art_map;
+
+		private:
+			const art_map *Belong;
+			Leaf *Ptr;
+
+		public:
+			const_iterator() : Belong(nullptr), Ptr(nullptr) {}
+
+			const_iterator(const art_map *_Belong, Leaf *node) : Belong(_Belong), Ptr(node) {}
+
+			const_iterator(const iterator &other) : Belong(other.Belong), Ptr(other.Ptr) {}
+
+			const_iterator operator++(int)
+			{
+				const_iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+
+			const_iterator &operator++()
+			{
+				if (!Ptr)
+					throw invalid_iterator();
+				Ptr = Ptr->nxt;
+				return *this;
+			}
+
+			const_iterator operator--(int)
+			{
+				const_iterator tmp = *this;
+				--*this;
+				return tmp;
+			}
+
+			const_iterator &operator--()
+			{
+				Leaf *p = Ptr ? Ptr->pre : Belong->End;
+				if (!p)
+					throw invalid_iterator();
+				Ptr = p;
+				return *this;
+			}
+
+			const value_type &operator*() const { return Ptr->ValueField; }
+
+			bool operator==(const iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+
+			bool operator==(const const_iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+
+			bool operator!=(const iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+
+			bool operator!=(const const_iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+
+			const value_type *operator->() const noexcept { return &(Ptr->ValueField); }
+		};
+
+		art_map() : Root(0), Begin(nullptr), End(nullptr), Size(0) {}
+
+		art_map(const art_map &other) : Root(0), Begin(nullptr), End(nullptr), Size(0)
+		{
+			copy_from(other);
+		}
+
+		art_map &operator=(const art_map &other)
+		{
+			if (this == &other)
+				return *this;
+			clear();
+			copy_from(other);
+			return *this;
+		}
+
+		~art_map() { destroy(Root); }
+
+		T &at(const std::string &key)
+		{
+			Leaf *x = locate(key);
+			if (!x)
+				throw index_out_of_bound();
+			return x->ValueField.second;
+		}
+
+		const T &at(const std::string &key) const
+		{
+			Leaf *x = locate(key);
+			if (!x)
+				throw index_out_of_bound();
+			return x->ValueField.second;
+		}
+
+		T &operator[](const std::string &key)
+		{
+			Leaf *x = locate(key);
+			return x ? x->ValueField.second : insert(key, T()).first->ValueField.second;
+		}
+
+		const T &operator[](const std::string &key) const
+		{
+			return at(key);
+		}
+
+		iterator begin() { return iterator(this, Begin); }
+
+		const_iterator cbegin() const { return const_iterator(this, Begin); }
+
+		iterator end() { return iterator(this, nullptr); }
+
+		const_iterator cend() const { return const_iterator(this, nullptr); }
+
+		bool empty() const { return !Size; }
+
+		size_t size() const { return Size; }
+
+		void clear()
+		{
+			destroy(Root);
+			Root = 0;
+			Begin = End = nullptr;
+			Size = 0;
+		}
+
+		pair<iterator, bool> insert(const value_type &value)
+		{
+			std ::pair<Leaf *, bool> ans = insert(value.first, value.second);
+			return pair<iterator, bool>(iterator(this, ans.first), ans.second);
+		}
+
+		void erase(iterator pos)
+		{
+			if (pos.Belong == this && pos.Ptr && locate(pos.Ptr->ValueField.first) == pos.Ptr)
+				erase(pos.Ptr);
+			else
+				throw invalid_iterator();
+		}
+
+		size_t count(const std::string &key) const
+		{
+			return locate(key) != nullptr;
+		}
+
+		iterator find(const std::string &key)
+		{
+			return iterator(this, locate(key));
+		}
+
+		const_iterator find(const std::string &key) const
+		{
+			return const_iterator(this, locate(key));
+		}
+
+		/**
+		 * the first element whose key is not less than key.
+		 */
+		iterator lower_bound(const std::string &key) { return iterator(this, lower(key)); }
+
+		const_iterator lower_bound(const std::string &key) const { return const_iterator(this, lower(key)); }
+
+		/**
+		 * the first element whose key is greater than key.
+		 */
+		iterator upper_bound(const std::string &key) { return iterator(this, upper(key)); }
+
+		const_iterator upper_bound(const std::string &key) const { return const_iterator(this, upper(key)); }
+
+		/**
+		 * the elements whose keys start with prefix, as [first, second) in key order;
+		 * both are lower_bound(prefix) if there is none.
+		 *
+		 *     for (auto r = m.prefix_range("/usr/lib/"); r.first != r.second; ++r.first) ...
+		 */
+		pair<iterator, iterator> prefix_range(const std::string &prefix)
+		{
+			std ::pair<Leaf *, Leaf *> r = cover(bytes(prefix), prefix.size());
+			if (!r.first)
+				r.first = r.second = lower(prefix);
+			return pair<iterator, iterator>(iterator(this, r.first), iterator(this, r.second));
+		}
+
+		pair<const_iterator, const_iterator> prefix_range(const std::string &prefix) const
+		{
+			std ::pair<Leaf *, Leaf *> r = cover(bytes(prefix), prefix.size());
+			if (!r.first)
+				r.first = r.second = lower(prefix);
+			return pair<const_iterator, const_iterator>(const_iterator(this, r.first), const_iterator(this, r.second));
+		}
+	};
+}
+
+#endif
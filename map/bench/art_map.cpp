@@ -0,0 +1,167 @@
+// art_map against the red-black sjtu::map on string keys with long shared prefixes,
+// URLs over a few hosts and paths in a deep directory tree.
+// "insert" also reports the bytes per key, the nodes plus the copies of the keys;
+// "prefix" counts the elements under a random directory.
+
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+#include "art_map.hpp"
+
+// every allocation is counted, so the bytes a container asks for can be reported
+static long long Allocated;
+
+void *operator new(size_t n)
+{
+	Allocated += n;
+	if (void *p = std::malloc(n ? n : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+const char *const Dists[] = {"url", "path"};
+
+/**
+ * the directory part of the i-th key, a prefix shared by many keys.
+ */
+std::string dir(const std::string &dist, std::mt19937_64 &rng)
+{
+	static const char *const Words[] = {"static", "images", "api", "v2", "users", "docs", "assets", "archive"};
+	std::string s;
+	if (dist == "url")
+		s = "https://www.example-" + std::to_string(rng() % 16) + ".com/";
+	else
+		s = "/home/user" + std::to_string(rng() % 4) + "/projects/";
+	for (int d = 0; d < 3; d++)
+		s = s + Words[rng() % 8] + "/";
+	return s;
+}
+
+/**
+ * n distinct keys in random order, and as many absent keys of the same shape.
+ */
+void make(const std::string &dist, long long n, std::vector<std::string> &keys, std::vector<std::string> &misses)
+{
+	std::mt19937_64 rng(19260817);
+	for (long long i = 0; i < n; i++)
+	{
+		keys.push_back(dir(dist, rng) + "item-" + std::to_string(i) + ".html");
+		misses.push_back(dir(dist, rng) + "item-" + std::to_string(i) + ".htm");
+	}
+	std::shuffle(keys.begin(), keys.end(), rng);
+}
+
+template <class Map>
+long long count_prefix(Map &m, const std::string &prefix)
+{
+	long long c = 0;
+	for (typename Map::iterator it = m.lower_bound(prefix); it != m.end() && !it->first.compare(0, prefix.size(), prefix); ++it)
+		c++;
+	return c;
+}
+
+template <class T>
+long long count_prefix(sjtu::art_map<T> &m, const std::string &prefix)
+{
+	long long c = 0;
+	for (sjtu::pair<typename sjtu::art_map<T>::iterator, typename sjtu::art_map<T>::iterator> r = m.prefix_range(prefix); r.first != r.second; ++r.first)
+		c++;
+	return c;
+}
+
+template <class Map>
+void run(const bench::options &opt, const char *impl)
+{
+	for (const char *dist : Dists)
+		for (long long n : opt.sizes())
+		{
+			std::vector<std::string> keys, misses;
+			make(dist, n, keys, misses);
+
+			if (opt.wants("insert"))
+			{
+				Map *m = nullptr;
+				long long bytes = 0;
+				double ns = bench::measure(
+					opt, n, [&] { delete m; m = new Map(); },
+					[&] {
+						long long before = Allocated;
+						for (long long i = 0; i < n; i++)
+							m->insert(typename Map::value_type(keys[i], int(i)));
+						bytes = Allocated - before;
+					});
+				delete m;
+				bench::report("art_map", "insert", impl, "string", dist, n, ns, "bytes_per_key", double(bytes) / n);
+			}
+
+			Map full;
+			for (long long i = 0; i < n; i++)
+				full.insert(typename Map::value_type(keys[i], int(i)));
+
+			if (opt.wants("find"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					long long sum = 0;
+					for (long long i = 0; i < n; i++)
+						sum += full.find(keys[n - 1 - i])->second;
+					bench::keep(sum);
+				});
+				bench::report("art_map", "find", impl, "string", dist, n, ns);
+			}
+
+			if (opt.wants("miss"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					long long sum = 0;
+					for (long long i = 0; i < n; i++)
+						sum += full.count(misses[i]);
+					bench::keep(sum);
+				});
+				bench::report("art_map", "miss", impl, "string", dist, n, ns);
+			}
+
+			if (opt.wants("scan"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					long long sum = 0;
+					for (typename Map::iterator it = full.begin(); it != full.end(); ++it)
+						sum += it->second;
+					bench::keep(sum);
+				});
+				bench::report("art_map", "scan", impl, "string", dist, n, ns);
+			}
+
+			if (opt.wants("prefix"))
+			{
+				const long long Scans = 1000;
+				std::mt19937_64 rng(1024);
+				std::vector<std::string> prefixes;
+				for (long long i = 0; i < Scans; i++)
+					prefixes.push_back(dir(dist, rng));
+				double ns = bench::measure(opt, Scans, [&] {
+					long long sum = 0;
+					for (long long i = 0; i < Scans; i++)
+						sum += count_prefix(full, prefixes[i]);
+					bench::keep(sum);
+				});
+				bench::report("art_map", "prefix", impl, "string", dist, n, ns);
+			}
+		}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	run<sjtu::art_map<int> >(opt, "sjtu::art_map");
+	run<sjtu::map<std::string, int> >(opt, "sjtu::map");
+	return 0;
+}
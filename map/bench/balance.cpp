@@ -0,0 +1,113 @@
+// the balancing policies of sjtu::map over a matrix of workloads, to choose one:
+// "insert" builds the map in the order of the distribution, "lookup" finds n keys drawn from it
+// and "mixed" does 90% lookups and 10% erase + insert of the drawn key. "zipf" draws with
+// exponent 1 over a shuffled ranking, so the hot keys are scattered over the key range.
+// the height after the run is reported next to the time.
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+const char *const Dists[] = {"uniform", "zipf", "sequential"};
+
+/**
+ * n keys of 0 .. n - 1 drawn from dist.
+ */
+std::vector<long long> make_accesses(const std::string &dist, long long n)
+{
+	if (dist == "sequential")
+		return bench::make_order("sequential", n);
+	std::mt19937_64 rng(998244353);
+	std::vector<long long> ans(n);
+	if (dist == "uniform")
+	{
+		for (long long &x : ans)
+			x = (long long)(rng() % n);
+		return ans;
+	}
+	std::vector<long long> rank = bench::make_order("uniform", n);
+	std::vector<double> cdf(n);
+	double sum = 0;
+	for (long long i = 0; i < n; i++)
+		cdf[i] = sum += 1.0 / (i + 1);
+	std::uniform_real_distribution<double> u(0, sum);
+	for (long long &x : ans)
+		x = rank[std::lower_bound(cdf.begin(), cdf.end(), u(rng)) - cdf.begin()];
+	return ans;
+}
+
+template <class Balance>
+void run(const bench::options &opt, const char *impl)
+{
+	typedef sjtu::map<long long, long long, std::less<long long>, sjtu::tree_no_stats, sjtu::iterator_checks, Balance> Map;
+	for (long long n : opt.sizes())
+		for (const char *dist : Dists)
+		{
+			std::vector<long long> order = bench::make_order(std::string(dist) == "sequential" ? "sequential" : "uniform", n);
+			std::vector<long long> access = make_accesses(dist, n);
+			Map full;
+			for (long long x : order)
+				full.insert(typename Map::value_type(x, x));
+
+			if (opt.wants("insert"))
+			{
+				int height = 0;
+				double ns = bench::measure(opt, n, [&] {
+					Map m;
+					for (long long x : order)
+						m.insert(typename Map::value_type(x, x));
+					height = m.height();
+				});
+				bench::report("balance", "insert", impl, "int64", dist, n, ns, "height", height);
+			}
+
+			if (opt.wants("lookup"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					long long sum = 0;
+					for (long long x : access)
+						sum += full.find(x)->second;
+					bench::keep(sum);
+				});
+				bench::report("balance", "lookup", impl, "int64", dist, n, ns, "height", full.height());
+			}
+
+			if (opt.wants("mixed"))
+			{
+				Map *m = nullptr;
+				double ns = bench::measure(
+					opt, n, [&] { delete m; m = new Map(full); },
+					[&] {
+						long long sum = 0;
+						for (long long i = 0; i < n; i++)
+						{
+							long long x = access[i];
+							if (i % 10)
+								sum += m->find(x)->second;
+							else
+							{
+								m->erase(m->find(x));
+								m->insert(typename Map::value_type(x, x));
+							}
+						}
+						bench::keep(sum);
+					});
+				bench::report("balance", "mixed", impl, "int64", dist, n, ns, "height", m->height());
+				delete m;
+			}
+		}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	run<sjtu::red_black_balance>(opt, "sjtu::map/red_black");
+	run<sjtu::avl_balance>(opt, "sjtu::map/avl");
+	run<sjtu::splay_balance>(opt, "sjtu::map/splay");
+	run<sjtu::treap_balance>(opt, "sjtu::map/treap");
+	return 0;
+}
@@ -0,0 +1,180 @@
+#ifndef SJTU_BENCH_HPP
+#define SJTU_BENCH_HPP
+
+// a tiny benchmark harness.
+// every measurement is printed as one JSON object per line,
+// bench.py at the top of the repository collects them and compares against a baseline.
+//
+// every benchmark accepts
+//     --min-n N      smallest size (default 1000)
+//     --max-n N      largest size, sizes go up by powers of 10 (default 1000000)
+//     --min-time MS  minimal time spent on each measurement (default 100)
+//     --filter S     only run cases whose name contains S
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+	typedef std::chrono::steady_clock Clock;
+
+	inline double ns_since(Clock::time_point t)
+	{
+		return std::chrono::duration<double, std::nano>(Clock::now() - t).count();
+	}
+
+	/**
+	 * keep the optimizer from dropping a result.
+	 */
+	template <class T>
+	inline void keep(const T &x)
+	{
+		asm volatile("" : : "r"(&x) : "memory");
+	}
+
+	struct options
+	{
+		long long MinN, MaxN;
+		double MinTime;
+		std::string Filter;
+
+		options(int argc, char **argv) : MinN(1000), MaxN(1000000), MinTime(100)
+		{
+			for (int i = 1; i + 1 < argc; i += 2)
+			{
+				if (!strcmp(argv[i], "--min-n"))
+					MinN = atoll(argv[i + 1]);
+				else if (!strcmp(argv[i], "--max-n"))
+					MaxN = atoll(argv[i + 1]);
+				else if (!strcmp(argv[i], "--min-time"))
+					MinTime = atof(argv[i + 1]);
+				else if (!strcmp(argv[i], "--filter"))
+					Filter = argv[i + 1];
+			}
+		}
+
+		bool wants(const std::string &name) const
+		{
+			return Filter.empty() || name.find(Filter) != std::string::npos;
+		}
+
+		std::vector<long long> sizes() const
+		{
+			std::vector<long long> ans;
+			for (long long n = MinN; n <= MaxN; n *= 10)
+				ans.push_back(n);
+			return ans;
+		}
+	};
+
+	/**
+	 * run setup() then time body() until MinTime has passed and at least 3 runs were made.
+	 * the time spent in setup() counts too, so a fast body behind a slow setup does not loop for ages.
+	 * return the best time per op in nanoseconds.
+	 */
+	inline double measure(const options &opt, long long ops, const std::function<void()> &setup, const std::function<void()> &body)
+	{
+		double best = 1e300;
+		Clock::time_point start = Clock::now();
+		for (int run = 0; run < 3 || ns_since(start) < opt.MinTime * 1e6; run++)
+		{
+			setup();
+			Clock::time_point t = Clock::now();
+			body();
+			best = std::min(best, ns_since(t));
+		}
+		return best / (ops ? ops : 1);
+	}
+
+	inline double measure(const options &opt, long long ops, const std::function<void()> &body)
+	{
+		return measure(opt, ops, [] {}, body);
+	}
+
+	/**
+	 * print one result.
+	 * suite/op/impl/key/dist/n identify the measurement across runs.
+	 */
+	inline void report(const char *suite, const char *op, const char *impl, const char *key, const char *dist, long long n, double ns_per_op)
+	{
+		printf("{\"suite\": \"%s\", \"op\": \"%s\", \"impl\": \"%s\", \"key\": \"%s\", \"dist\": \"%s\", \"n\": %lld, \"ns_per_op\": %.3f}\n",
+			   suite, op, impl, key, dist, n, ns_per_op);
+		fflush(stdout);
+	}
+
+	/**
+	 * print one result with an extra metric (allocations per op, bytes per element...),
+	 * which is kept in the results but not compared against the baseline.
+	 */
+	inline void report(const char *suite, const char *op, const char *impl, const char *key, const char *dist, long long n, double ns_per_op,
+					   const char *extra, double value)
+	{
+		printf("{\"suite\": \"%s\", \"op\": \"%s\", \"impl\": \"%s\", \"key\": \"%s\", \"dist\": \"%s\", \"n\": %lld, \"ns_per_op\": %.3f, \"%s\": %.3f}\n",
+			   suite, op, impl, key, dist, n, ns_per_op, extra, value);
+		fflush(stdout);
+	}
+
+	/**
+	 * the i-th key of a key type, keys compare in the same order as i.
+	 */
+	template <class K>
+	inline K make_key(long long i) { return K(i); }
+
+	template <>
+	inline std::string make_key<std::string>(long long i)
+	{
+		char buf[32];
+		snprintf(buf, sizeof(buf), "key-%016lld", i);
+		return buf;
+	}
+
+	template <class K>
+	inline const char *key_name();
+
+	template <>
+	inline const char *key_name<int>() { return "int"; }
+
+	template <>
+	inline const char *key_name<long long>() { return "int64"; }
+
+	template <>
+	inline const char *key_name<std::string>() { return "string"; }
+
+	static const char *const dists[] = {"sequential", "reverse", "uniform"};
+
+	/**
+	 * a permutation of 0 .. n - 1 in the given order.
+	 */
+	inline std::vector<long long> make_order(const std::string &dist, long long n, unsigned seed = 19260817)
+	{
+		std::vector<long long> ans(n);
+		for (long long i = 0; i < n; i++)
+			ans[i] = dist == "reverse" ? n - 1 - i : i;
+		if (dist == "uniform")
+			std::shuffle(ans.begin(), ans.end(), std::mt19937_64(seed));
+		return ans;
+	}
+
+	/**
+	 * keys of make_order() as the given key type.
+	 */
+	template <class K>
+	inline std::vector<K> make_keys(const std::string &dist, long long n, unsigned seed = 19260817)
+	{
+		std::vector<long long> order = make_order(dist, n, seed);
+		std::vector<K> ans;
+		ans.reserve(n);
+		for (long long i = 0; i < n; i++)
+			ans.push_back(make_key<K>(order[i]));
+		return ans;
+	}
+}
+
+#endif
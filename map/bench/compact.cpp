@@ -0,0 +1,108 @@
+// a long-lived map fragmented by churn, before and after compact():
+// the map is built between allocations of other objects, then keys are erased and inserted
+// at random for a while, so the nodes end up scattered over the heap in no order.
+// "scan" walks the whole map, "find" looks up random keys, "compact" is the cost of one full
+// pass per element, in steps of 4096.
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+typedef sjtu::map<long long, long long> Map;
+
+/**
+ * a map of n keys out of 0 .. 2n - 1 after 4n random erases and inserts; filler keeps the
+ * other allocations alive.
+ */
+void churn(Map &m, long long n, std::vector<void *> &filler)
+{
+	std::mt19937_64 rng(19260817);
+	for (long long x : bench::make_order("uniform", 2 * n))
+	{
+		m.insert(Map::value_type(x, x));
+		filler.push_back(std::malloc(16 + rng() % 240));
+	}
+	for (long long i = 0; i < 4 * n; i++)
+	{
+		long long x = rng() % (2 * n);
+		Map::iterator it = m.find(x);
+		if (it != m.end())
+			m.erase(it);
+		else
+			m.insert(Map::value_type(x, x));
+		if (rng() % 4 == 0)
+		{
+			size_t j = rng() % filler.size();
+			std::free(filler[j]);
+			filler[j] = std::malloc(16 + rng() % 240);
+		}
+	}
+	while (m.size() > size_t(n))
+	{
+		Map::iterator it = m.find(rng() % (2 * n));
+		if (it != m.end())
+			m.erase(it);
+	}
+}
+
+void run(const bench::options &opt, Map &m, long long n, const std::vector<long long> &probes, const char *impl)
+{
+	if (opt.wants("scan"))
+	{
+		double ns = bench::measure(opt, n, [&] {
+			long long sum = 0;
+			for (Map::const_iterator it = m.cbegin(); it != m.cend(); ++it)
+				sum += it->second;
+			bench::keep(sum);
+		});
+		bench::report("compact", "scan", impl, "int64", "churned", n, ns);
+	}
+
+	if (opt.wants("find"))
+	{
+		double ns = bench::measure(opt, n, [&] {
+			long long sum = 0;
+			for (long long i = 0; i < n; i++)
+				sum += m.count(probes[i]);
+			bench::keep(sum);
+		});
+		bench::report("compact", "find", impl, "int64", "churned", n, ns);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	for (long long n : opt.sizes())
+	{
+		std::vector<void *> filler;
+		Map m;
+		churn(m, n, filler);
+		std::vector<long long> probes;
+		for (Map::const_iterator it = m.cbegin(); it != m.cend(); ++it)
+			probes.push_back(it->first);
+		std::shuffle(probes.begin(), probes.end(), std::mt19937_64(1024));
+
+		run(opt, m, n, probes, "sjtu::map");
+
+		if (opt.wants("compact"))
+		{
+			double ns = bench::measure(opt, n, [&] {
+				while (!m.compact(4096))
+					;
+			});
+			bench::report("compact", "compact", "sjtu::map", "int64", "churned", n, ns);
+		}
+		else
+			m.compact();
+
+		run(opt, m, n, probes, "sjtu::map/compact()");
+
+		for (void *p : filler)
+			std::free(p);
+	}
+	return 0;
+}
@@ -0,0 +1,109 @@
+// inserting nearly sorted keys, timestamps i * 64 + jitter, with and without a finger:
+// plain insert() descends from the root, insert(hint) starts from the last inserted element or
+// from end(). "find_sorted" looks every key up in increasing order, from the previous answer.
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+typedef sjtu::map<long long, long long> Map;
+
+const long long Jitters[] = {64, 4096};
+
+std::vector<long long> make_timestamps(long long n, long long jitter)
+{
+	std::mt19937_64 rng(19260817);
+	std::vector<long long> ans(n);
+	for (long long i = 0; i < n; i++)
+		ans[i] = i * 64 + (long long)(rng() % jitter);
+	return ans;
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	for (long long n : opt.sizes())
+		for (long long jitter : Jitters)
+		{
+			std::vector<long long> keys = make_timestamps(n, jitter);
+			std::string dist = "jitter" + std::to_string(jitter);
+
+			if (opt.wants("insert"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					Map m;
+					for (long long k : keys)
+						m.insert(Map::value_type(k, k));
+					bench::keep(m.size());
+				});
+				bench::report("finger", "insert", "sjtu::map", "int64", dist.c_str(), n, ns);
+
+				ns = bench::measure(opt, n, [&] {
+					Map m;
+					Map::iterator last = m.end();
+					for (long long k : keys)
+						last = m.insert(last, Map::value_type(k, k));
+					bench::keep(m.size());
+				});
+				bench::report("finger", "insert", "sjtu::map/hint=last", "int64", dist.c_str(), n, ns);
+
+				ns = bench::measure(opt, n, [&] {
+					Map m;
+					for (long long k : keys)
+						m.insert(m.cend(), Map::value_type(k, k));
+					bench::keep(m.size());
+				});
+				bench::report("finger", "insert", "sjtu::map/hint=end", "int64", dist.c_str(), n, ns);
+
+				ns = bench::measure(opt, n, [&] {
+					std::map<long long, long long> m;
+					for (long long k : keys)
+						m.insert(std::make_pair(k, k));
+					bench::keep(m.size());
+				});
+				bench::report("finger", "insert", "std::map", "int64", dist.c_str(), n, ns);
+
+				ns = bench::measure(opt, n, [&] {
+					std::map<long long, long long> m;
+					for (long long k : keys)
+						m.insert(m.end(), std::make_pair(k, k));
+					bench::keep(m.size());
+				});
+				bench::report("finger", "insert", "std::map/hint=end", "int64", dist.c_str(), n, ns);
+			}
+
+			if (opt.wants("find_sorted"))
+			{
+				Map m;
+				for (long long k : keys)
+					m.insert(m.cend(), Map::value_type(k, k));
+				std::vector<long long> sorted(keys);
+				std::sort(sorted.begin(), sorted.end());
+
+				double ns = bench::measure(opt, n, [&] {
+					long long sum = 0;
+					for (long long k : sorted)
+						sum += m.find(k)->second;
+					bench::keep(sum);
+				});
+				bench::report("finger", "find_sorted", "sjtu::map", "int64", dist.c_str(), n, ns);
+
+				ns = bench::measure(opt, n, [&] {
+					long long sum = 0;
+					Map::const_iterator at = m.cbegin();
+					for (long long k : sorted)
+					{
+						at = m.find(at, k);
+						sum += at->second;
+					}
+					bench::keep(sum);
+				});
+				bench::report("finger", "find_sorted", "sjtu::map/hint=previous", "int64", dist.c_str(), n, ns);
+			}
+		}
+	return 0;
+}
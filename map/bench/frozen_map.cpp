@@ -0,0 +1,94 @@
+// lookups in a frozen_map against the sjtu::map it was frozen from and std::lower_bound on a
+// sorted array of pairs, and the cost of freeze() itself. "find" looks up n independent random
+// keys, half of them misses, "find_chained" makes every key depend on the previous answer so the
+// loads cannot overlap, which is the latency the layout is for.
+// pass --max-n 10000000 or more to leave the L3.
+
+#include <algorithm>
+#include <climits>
+#include <random>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+#include "frozen_map.hpp"
+
+typedef sjtu::map<long long, long long> Map;
+typedef sjtu::frozen_map<long long, long long, std::less<long long> > Frozen;
+
+/**
+ * n keys drawn uniformly from the n keys 0, 2, .., 2n - 2 and their misses.
+ */
+std::vector<long long> make_lookups(long long n)
+{
+	std::mt19937_64 rng(20240229);
+	std::vector<long long> ans(n);
+	for (long long &x : ans)
+		x = (long long)(rng() % (2 * n));
+	return ans;
+}
+
+template <class Find>
+void run_lookups(const bench::options &opt, const char *impl, long long n, const std::vector<long long> &keys, Find find)
+{
+	if (opt.wants("find"))
+	{
+		double ns = bench::measure(opt, n, [&] {
+			long long sum = 0;
+			for (long long k : keys)
+				sum += find(k);
+			bench::keep(sum);
+		});
+		bench::report("frozen_map", "find", impl, "int64", "uniform", n, ns);
+	}
+
+	if (opt.wants("find_chained"))
+	{
+		double ns = bench::measure(opt, n, [&] {
+			long long last = 0;
+			for (long long k : keys)
+				last = find((k + (last & 1)) % (2 * n));
+			bench::keep(last);
+		});
+		bench::report("frozen_map", "find_chained", impl, "int64", "uniform", n, ns);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	for (long long n : opt.sizes())
+	{
+		Map m;
+		for (long long x : bench::make_order("uniform", n))
+			m.insert(Map::value_type(2 * x, x));
+		std::vector<long long> keys = make_lookups(n);
+
+		if (opt.wants("freeze"))
+		{
+			double ns = bench::measure(opt, n, [&] { bench::keep(m.freeze().size()); });
+			bench::report("frozen_map", "freeze", "sjtu::frozen_map", "int64", "uniform", n, ns);
+		}
+
+		Frozen f = m.freeze();
+		std::vector<std::pair<long long, long long> > sorted;
+		for (Map::const_iterator it = m.cbegin(); it != m.cend(); ++it)
+			sorted.push_back(std::make_pair(it->first, it->second));
+
+		// every find returns the mapped value, or -1 on a miss, so the answers feed the chain
+		run_lookups(opt, "sjtu::map", n, keys, [&](long long k) {
+			const long long *v = m.find_value(k);
+			return v ? *v : -1;
+		});
+		run_lookups(opt, "sjtu::frozen_map", n, keys, [&](long long k) {
+			const long long *v = f.find_value(k);
+			return v ? *v : -1;
+		});
+		run_lookups(opt, "std::lower_bound", n, keys, [&](long long k) {
+			std::vector<std::pair<long long, long long> >::const_iterator it =
+				std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(k, LLONG_MIN));
+			return it != sorted.end() && it->first == k ? it->second : -1;
+		});
+	}
+	return 0;
+}
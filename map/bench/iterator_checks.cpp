@@ -0,0 +1,65 @@
+// the three iterator checking policies of sjtu::map: a full scan with ++ and one with --,
+// and erasing every element through begin(), where the default policy looks each key up.
+
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+template <class Checks>
+void run(const bench::options &opt, const char *impl)
+{
+	typedef sjtu::map<long long, long long, std::less<long long>, sjtu::tree_no_stats, Checks> Map;
+	for (long long n : opt.sizes())
+	{
+		Map m;
+		for (long long x : bench::make_order("uniform", n))
+			m.insert(typename Map::value_type(x, x));
+
+		if (opt.wants("scan"))
+		{
+			double ns = bench::measure(opt, n, [&] {
+				long long sum = 0;
+				for (typename Map::const_iterator it = m.cbegin(); it != m.cend(); ++it)
+					sum += it->second;
+				bench::keep(sum);
+			});
+			bench::report("iterator_checks", "scan", impl, "int64", "uniform", n, ns);
+		}
+
+		if (opt.wants("scan_back"))
+		{
+			double ns = bench::measure(opt, n, [&] {
+				long long sum = 0;
+				typename Map::iterator it = m.end();
+				for (long long i = 0; i < n; i++)
+					sum += (--it)->second;
+				bench::keep(sum);
+			});
+			bench::report("iterator_checks", "scan_back", impl, "int64", "uniform", n, ns);
+		}
+
+		if (opt.wants("erase_begin"))
+		{
+			Map *q = nullptr;
+			double ns = bench::measure(
+				opt, n, [&] { delete q; q = new Map(m); },
+				[&] {
+					while (!q->empty())
+						q->erase(q->begin());
+				});
+			delete q;
+			bench::report("iterator_checks", "erase_begin", impl, "int64", "uniform", n, ns);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	run<sjtu::unchecked_iterators>(opt, "sjtu::map/unchecked_iterators");
+	run<sjtu::iterator_checks>(opt, "sjtu::map/iterator_checks");
+	run<sjtu::checked_iterators>(opt, "sjtu::map/checked_iterators");
+	return 0;
+}
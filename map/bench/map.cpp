@@ -0,0 +1,96 @@
+// insert / find / erase / iterate / copy of sjtu::map against std::map.
+
+#include <map>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+template <class K>
+void insert_one(sjtu::map<K, int> &m, const K &k, int v) { m.insert(sjtu::pair<const K, int>(k, v)); }
+
+template <class K>
+void insert_one(std::map<K, int> &m, const K &k, int v) { m.insert(std::pair<const K, int>(k, v)); }
+
+template <class K, class Map>
+void run(const bench::options &opt, const char *impl)
+{
+	const char *key = bench::key_name<K>();
+
+	for (const char *dist : bench::dists)
+		for (long long n : opt.sizes())
+		{
+			std::vector<K> keys = bench::make_keys<K>(dist, n);
+			Map full;
+			for (long long i = 0; i < n; i++)
+				insert_one(full, keys[i], int(i));
+
+			if (opt.wants("insert"))
+			{
+				Map *m = nullptr;
+				double ns = bench::measure(
+					opt, n, [&] { delete m; m = new Map(); },
+					[&] {
+						for (long long i = 0; i < n; i++)
+							insert_one(*m, keys[i], int(i));
+					});
+				delete m;
+				bench::report("map", "insert", impl, key, dist, n, ns);
+			}
+
+			if (opt.wants("find"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					long long sum = 0;
+					for (long long i = 0; i < n; i++)
+						sum += full.find(keys[i])->second;
+					bench::keep(sum);
+				});
+				bench::report("map", "find", impl, key, dist, n, ns);
+			}
+
+			if (opt.wants("erase"))
+			{
+				Map *m = nullptr;
+				double ns = bench::measure(
+					opt, n, [&] { delete m; m = new Map(full); },
+					[&] {
+						for (long long i = 0; i < n; i++)
+							m->erase(m->find(keys[i]));
+					});
+				delete m;
+				bench::report("map", "erase", impl, key, dist, n, ns);
+			}
+
+			if (opt.wants("iterate"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					long long sum = 0;
+					for (typename Map::iterator it = full.begin(); it != full.end(); ++it)
+						sum += it->second;
+					bench::keep(sum);
+				});
+				bench::report("map", "iterate", impl, key, dist, n, ns);
+			}
+
+			if (opt.wants("copy"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					Map m(full);
+					bench::keep(m);
+				});
+				bench::report("map", "copy", impl, key, dist, n, ns);
+			}
+		}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	run<int, sjtu::map<int, int> >(opt, "sjtu::map");
+	run<int, std::map<int, int> >(opt, "std::map");
+	run<std::string, sjtu::map<std::string, int> >(opt, "sjtu::map");
+	run<std::string, std::map<std::string, int> >(opt, "std::map");
+	return 0;
+}
@@ -0,0 +1,94 @@
+// cold-start vs warm-start of a file-backed map.
+// the file is written to the working directory and removed afterwards.
+
+#include <random>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+#include "mapped_map.hpp"
+
+typedef sjtu::mapped_map<long long, long long> Mapped;
+
+static const char *const Path = "mapped_map.bench";
+
+static void drop_cache()
+{
+	int fd = open(Path, O_RDONLY);
+	if (fd < 0)
+		return;
+	fdatasync(fd);
+	posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+	close(fd);
+}
+
+static long long lookup(const Mapped &m, long long q, long long n)
+{
+	std::mt19937_64 rng(42);
+	long long sum = 0;
+	for (long long i = 0; i < q; i++)
+		sum += m.at((long long)(rng() % n));
+	return sum;
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+
+	for (long long n : opt.sizes())
+	{
+		long long q = std::min(n, 100000LL);
+
+		if (opt.wants("build"))
+		{
+			double ns = bench::measure(
+				opt, n, [] { unlink(Path); },
+				[&] {
+					Mapped m(Path);
+					for (long long i = 0; i < n; i++)
+						m[i] = i;
+				});
+			bench::report("mapped_map", "build", "sjtu::mapped_map", "int64", "sequential", n, ns);
+
+			ns = bench::measure(opt, n, [&] {
+				sjtu::map<long long, long long> m;
+				for (long long i = 0; i < n; i++)
+					m[i] = i;
+				bench::keep(m);
+			});
+			bench::report("mapped_map", "build", "sjtu::map", "int64", "sequential", n, ns);
+		}
+
+		unlink(Path);
+		{
+			Mapped m(Path);
+			for (long long i = 0; i < n; i++)
+				m[i] = i;
+		}
+
+		// a cold start can only be observed once per drop of the page cache, so these are single shots.
+		const char *const mode[2] = {"cold", "warm"};
+		for (int k = 0; k < 2; k++)
+		{
+			if (!opt.wants(mode[k]))
+				continue;
+			if (k == 0)
+				drop_cache();
+
+			bench::Clock::time_point t = bench::Clock::now();
+			Mapped m(Path, true);
+			double open_ns = bench::ns_since(t);
+
+			t = bench::Clock::now();
+			bench::keep(lookup(m, q, n));
+			double find_ns = bench::ns_since(t) / q;
+
+			bench::report("mapped_map", (std::string(mode[k]) + "-open").c_str(), "sjtu::mapped_map", "int64", "uniform", n, open_ns);
+			bench::report("mapped_map", (std::string(mode[k]) + "-find").c_str(), "sjtu::mapped_map", "int64", "uniform", n, find_ns);
+		}
+	}
+
+	unlink(Path);
+	return 0;
+}
@@ -0,0 +1,98 @@
+// an ordered scan over n elements spread over k map shards, k = 2 .. 1024:
+// merged_view (a loser tree of cursors), a binary heap of cursors (std::priority_queue)
+// and what is done without a view, copying every shard into one map and scanning it.
+// "seek" starts at lower_bound of a random key and reads 64 elements.
+
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+#include "merged_view.hpp"
+
+typedef sjtu::map<long long, long long> Map;
+
+const size_t Ks[] = {2, 4, 16, 64, 256, 1024};
+
+struct cursor
+{
+	Map::const_iterator At, End;
+
+	bool operator<(const cursor &rhs) const { return rhs.At->first < At->first; }
+};
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	for (long long n : opt.sizes())
+		for (size_t k : Ks)
+		{
+			std::string dist = "k=" + std::to_string(k);
+			std::vector<long long> keys = bench::make_order("uniform", n);
+			std::vector<Map> Shards(k);
+			std::mt19937_64 rng(1024);
+			for (long long x : keys)
+				Shards[rng() % k].insert(Map::value_type(x, x));
+			sjtu::merged_view<Map> All(Shards.begin(), Shards.end());
+
+			if (opt.wants("scan"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					long long sum = 0;
+					for (sjtu::merged_view<Map>::const_iterator it = All.begin(); it != All.end(); ++it)
+						sum += it->second;
+					bench::keep(sum);
+				});
+				bench::report("merged_view", "scan", "sjtu::merged_view", "int64", dist.c_str(), n, ns);
+
+				ns = bench::measure(opt, n, [&] {
+					std::priority_queue<cursor> Heap;
+					for (size_t i = 0; i < k; i++)
+						if (Shards[i].cbegin() != Shards[i].cend())
+							Heap.push(cursor{Shards[i].cbegin(), Shards[i].cend()});
+					long long sum = 0;
+					while (!Heap.empty())
+					{
+						cursor c = Heap.top();
+						Heap.pop();
+						sum += c.At->second;
+						if (++c.At != c.End)
+							Heap.push(c);
+					}
+					bench::keep(sum);
+				});
+				bench::report("merged_view", "scan", "std::priority_queue", "int64", dist.c_str(), n, ns);
+
+				ns = bench::measure(opt, n, [&] {
+					Map One;
+					for (size_t i = 0; i < k; i++)
+						for (Map::const_iterator it = Shards[i].cbegin(); it != Shards[i].cend(); ++it)
+							One.insert(*it);
+					long long sum = 0;
+					for (Map::const_iterator it = One.cbegin(); it != One.cend(); ++it)
+						sum += it->second;
+					bench::keep(sum);
+				});
+				bench::report("merged_view", "scan", "sjtu::map/copy", "int64", dist.c_str(), n, ns);
+			}
+
+			if (opt.wants("seek"))
+			{
+				const long long Seeks = 1000, Len = 64;
+				double ns = bench::measure(opt, Seeks, [&] {
+					long long sum = 0;
+					for (long long s = 0; s < Seeks; s++)
+					{
+						sjtu::merged_view<Map>::const_iterator it = All.lower_bound(keys[s % n]);
+						for (long long i = 0; i < Len && it != All.end(); i++, ++it)
+							sum += it->second;
+					}
+					bench::keep(sum);
+				});
+				bench::report("merged_view", "seek", "sjtu::merged_view", "int64", dist.c_str(), n, ns);
+			}
+		}
+	return 0;
+}
@@ -0,0 +1,81 @@
+// scaling of parallel_for_each / parallel_reduce over sjtu::map from 1 thread to every core.
+// the speedup against a plain sequential loop is reported next to the time.
+
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "map.hpp"
+#include "parallel.hpp"
+
+typedef sjtu::map<long long, long long> Map;
+
+/**
+ * a few dozen cycles of work per element, so that for_each is not only bound by memory.
+ */
+inline long long mix(long long x)
+{
+	unsigned long long h = (unsigned long long)x;
+	for (int i = 0; i < 4; i++)
+		h = (h ^ (h >> 31)) * 0x9E3779B97F4A7C15ull;
+	return (long long)(h >> 1);
+}
+
+std::vector<unsigned> thread_counts()
+{
+	unsigned most = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<unsigned> ans;
+	for (unsigned t = 1; t < most; t *= 2)
+		ans.push_back(t);
+	ans.push_back(most);
+	return ans;
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	for (long long n : opt.sizes())
+	{
+		Map m;
+		for (long long x : bench::make_order("uniform", n))
+			m.insert(Map::value_type(x, x));
+
+		double seq_reduce = bench::measure(opt, n, [&] {
+			long long sum = 0;
+			for (Map::const_iterator it = m.cbegin(); it != m.cend(); ++it)
+				sum += it->second;
+			bench::keep(sum);
+		});
+		double seq_for_each = bench::measure(opt, n, [&] {
+			for (Map::iterator it = m.begin(); it != m.end(); ++it)
+				it->second = mix(it->second);
+		});
+		if (opt.wants("reduce"))
+			bench::report("parallel", "reduce", "sequential", "int64", "uniform", n, seq_reduce);
+		if (opt.wants("for_each"))
+			bench::report("parallel", "for_each", "sequential", "int64", "uniform", n, seq_for_each);
+
+		for (unsigned t : thread_counts())
+		{
+			sjtu::work_stealing_pool pool(t);
+			std::string impl = "sjtu::parallel/" + std::to_string(t);
+
+			if (opt.wants("reduce"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					bench::keep(sjtu::parallel_reduce(m, 0LL, std::plus<long long>(), pool));
+				});
+				bench::report("parallel", "reduce", impl.c_str(), "int64", "uniform", n, ns, "speedup", seq_reduce / ns);
+			}
+
+			if (opt.wants("for_each"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					sjtu::parallel_for_each(m, [](Map::value_type &v) { v.second = mix(v.second); }, pool);
+				});
+				bench::report("parallel", "for_each", impl.c_str(), "int64", "uniform", n, ns, "speedup", seq_for_each / ns);
+			}
+		}
+	}
+	return 0;
+}
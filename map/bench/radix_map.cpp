@@ -0,0 +1,120 @@
+// radix_map against the red-black sjtu::map on dense and sparse integer keys.
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+#include "radix_map.hpp"
+
+template <class K>
+void insert_one(sjtu::map<K, int> &m, K k, int v) { m.insert(sjtu::pair<const K, int>(k, v)); }
+
+template <class K>
+void insert_one(sjtu::radix_map<K, int> &m, K k, int v) { m.insert(sjtu::pair<const K, int>(k, v)); }
+
+/**
+ * dense: a shuffled 0 .. n - 1, sparse: n random keys over the whole range.
+ */
+template <class K>
+std::vector<K> make(const std::string &dist, long long n)
+{
+	std::vector<K> ans;
+	if (dist == "dense")
+		for (long long x : bench::make_order("uniform", n))
+			ans.push_back(K(x));
+	else
+	{
+		std::mt19937_64 rng(19260817);
+		for (long long i = 0; i < n; i++)
+			ans.push_back(K(rng()));
+	}
+	return ans;
+}
+
+/**
+ * probes are reduced modulo Range unless it is 0.
+ */
+template <class K>
+void run_lower_bound(const bench::options &opt, sjtu::radix_map<K, int> &full, long long Range, const std::vector<K> &probes,
+					 const char *impl, const char *key, const char *dist, long long n)
+{
+	double ns = bench::measure(opt, n, [&] {
+		long long sum = 0;
+		for (long long i = 0; i < n; i++)
+			sum += full.lower_bound(Range ? K(probes[i] % Range) : probes[i]) != full.end();
+		bench::keep(sum);
+	});
+	bench::report("radix_map", "lower_bound", impl, key, dist, n, ns);
+}
+
+/**
+ * sjtu::map has no lower_bound to compare with.
+ */
+template <class K>
+void run_lower_bound(const bench::options &, sjtu::map<K, int> &, long long, const std::vector<K> &,
+					 const char *, const char *, const char *, long long) {}
+
+template <class K, class Map>
+void run(const bench::options &opt, const char *impl, const char *key)
+{
+	const char *const dists[] = {"dense", "sparse"};
+	for (const char *dist : dists)
+		for (long long n : opt.sizes())
+		{
+			std::vector<K> keys = make<K>(dist, n);
+			std::vector<K> probes = make<K>("sparse", n);
+			Map full;
+			for (long long i = 0; i < n; i++)
+				insert_one(full, keys[i], int(i));
+
+			if (opt.wants("insert"))
+			{
+				Map *m = nullptr;
+				double ns = bench::measure(
+					opt, n, [&] { delete m; m = new Map(); },
+					[&] {
+						for (long long i = 0; i < n; i++)
+							insert_one(*m, keys[i], int(i));
+					});
+				delete m;
+				bench::report("radix_map", "insert", impl, key, dist, n, ns);
+			}
+
+			if (opt.wants("find"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					long long sum = 0;
+					for (long long i = 0; i < n; i++)
+						sum += full.find(keys[i])->second;
+					bench::keep(sum);
+				});
+				bench::report("radix_map", "find", impl, key, dist, n, ns);
+			}
+
+			if (opt.wants("lower_bound"))
+				run_lower_bound(opt, full, dist[0] == 'd' ? n : 0, probes, impl, key, dist, n);
+
+			if (opt.wants("iterate"))
+			{
+				double ns = bench::measure(opt, n, [&] {
+					long long sum = 0;
+					for (typename Map::iterator it = full.begin(); it != full.end(); ++it)
+						sum += it->second;
+					bench::keep(sum);
+				});
+				bench::report("radix_map", "iterate", impl, key, dist, n, ns);
+			}
+		}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	run<uint32_t, sjtu::radix_map<uint32_t, int> >(opt, "sjtu::radix_map", "uint32");
+	run<uint32_t, sjtu::map<uint32_t, int> >(opt, "sjtu::map", "uint32");
+	run<uint64_t, sjtu::radix_map<uint64_t, int> >(opt, "sjtu::radix_map", "uint64");
+	run<uint64_t, sjtu::map<uint64_t, int> >(opt, "sjtu::map", "uint64");
+	return 0;
+}
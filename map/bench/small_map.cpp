@@ -0,0 +1,92 @@
+// n tiny maps of k elements each, with and without small_buffer<8>:
+// "construct" builds and destroys all of them (ns per map) and reports the bytes each one
+// takes, the map object plus what it allocated; "lookup" finds one random key in each map.
+// k = 16 does not fit, so it shows the cost of growing into a tree.
+
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+// every allocation is counted, so the bytes a container asks for can be reported
+static long long Allocated;
+
+void *operator new(size_t n)
+{
+	Allocated += n;
+	if (void *p = std::malloc(n ? n : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+const int Ks[] = {0, 1, 4, 8, 16};
+
+template <class Map>
+void insert(Map &m, int k, int v) { m.insert(typename Map::value_type(k, v)); }
+
+void insert(std::map<int, int> &m, int k, int v) { m.insert(std::make_pair(k, v)); }
+
+template <class Map>
+void run(const bench::options &opt, const char *impl)
+{
+	for (long long n : opt.sizes())
+		for (int k : Ks)
+		{
+			std::string dist = "k=" + std::to_string(k);
+			std::mt19937 rng(20260101);
+			std::vector<int> keys(n * k);
+			for (int &x : keys)
+				x = int(rng() % (4 * k));
+
+			if (opt.wants("construct"))
+			{
+				long long bytes = 0;
+				double ns = bench::measure(opt, n, [&] {
+					long long before = Allocated;
+					std::vector<Map> maps(n);
+					for (long long i = 0; i < n; i++)
+						for (int j = 0; j < k; j++)
+							insert(maps[i], keys[i * k + j], j);
+					bytes = Allocated - before;
+				});
+				bench::report("small_map", "construct", impl, "int32", dist.c_str(), n, ns, "bytes_per_map", double(bytes) / n);
+			}
+
+			if (opt.wants("lookup"))
+			{
+				std::vector<Map> maps(n);
+				for (long long i = 0; i < n; i++)
+					for (int j = 0; j < k; j++)
+						insert(maps[i], keys[i * k + j], j);
+				std::vector<int> probes(n);
+				for (int &x : probes)
+					x = k ? int(rng() % (4 * k)) : 0;
+
+				double ns = bench::measure(opt, n, [&] {
+					long long sum = 0;
+					for (long long i = 0; i < n; i++)
+						sum += maps[i].count(probes[i]);
+					bench::keep(sum);
+				});
+				bench::report("small_map", "lookup", impl, "int32", dist.c_str(), n, ns);
+			}
+		}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	run<sjtu::map<int, int> >(opt, "sjtu::map");
+	run<sjtu::map<int, int, std::less<int>, sjtu::tree_no_stats, sjtu::iterator_checks, sjtu::red_black_balance, sjtu::small_buffer<8> > >(opt, "sjtu::map/small_buffer<8>");
+	run<std::map<int, int> >(opt, "std::map");
+	return 0;
+}
@@ -0,0 +1,88 @@
+// lookups in a compile-time static_map against sjtu::map and std::map loaded at startup.
+// map/test/containers.cpp checks that the same table is built at compile time.
+
+#include <map>
+#include <random>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+#include "static_map.hpp"
+
+enum opcode
+{
+	NOP, LOAD, STORE, ADD, SUB, MUL, DIV, MOD, AND, OR, XOR, NOT, SHL, SHR, JMP, JZ,
+	JNZ, CALL, RET, PUSH, POP, CMP, MOV, LEA, INC, DEC, NEG, HALT, IN, OUT, INT, IRET
+};
+
+constexpr sjtu::pair<int, int> Init[] = {
+	{HALT, 1}, {NOP, 1}, {LOAD, 3}, {STORE, 3}, {ADD, 2}, {SUB, 2}, {MUL, 4}, {DIV, 20},
+	{MOD, 20}, {AND, 1}, {OR, 1}, {XOR, 1}, {NOT, 1}, {SHL, 1}, {SHR, 1}, {JMP, 2},
+	{JZ, 2}, {JNZ, 2}, {CALL, 5}, {RET, 5}, {PUSH, 2}, {POP, 2}, {CMP, 1}, {MOV, 1},
+	{LEA, 1}, {INC, 1}, {DEC, 1}, {NEG, 1}, {IN, 50}, {OUT, 50}, {INT, 100}, {IRET, 100}};
+
+constexpr auto Cycles = sjtu::make_static_map(Init);
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	const int n = sizeof(Init) / sizeof(Init[0]);
+
+	std::vector<int> queries(opt.MaxN);
+	std::mt19937 rng(42);
+	for (int &q : queries)
+		q = rng() % n;
+
+	if (opt.wants("startup"))
+	{
+		double ns = bench::measure(opt, 1, [&] {
+			sjtu::map<int, int> m;
+			for (int i = 0; i < n; i++)
+				m[Init[i].first] = Init[i].second;
+			bench::keep(m);
+		});
+		bench::report("static_map", "startup", "sjtu::map", "int", "opcodes", n, ns);
+
+		ns = bench::measure(opt, 1, [&] {
+			std::map<int, int> m;
+			for (int i = 0; i < n; i++)
+				m[Init[i].first] = Init[i].second;
+			bench::keep(m);
+		});
+		bench::report("static_map", "startup", "std::map", "int", "opcodes", n, ns);
+	}
+
+	if (opt.wants("find"))
+	{
+		sjtu::map<int, int> sm;
+		std::map<int, int> stdm;
+		for (int i = 0; i < n; i++)
+			sm[Init[i].first] = stdm[Init[i].first] = Init[i].second;
+
+		long long q = queries.size();
+		double ns = bench::measure(opt, q, [&] {
+			long long sum = 0;
+			for (int k : queries)
+				sum += Cycles.at(k);
+			bench::keep(sum);
+		});
+		bench::report("static_map", "find", "sjtu::static_map", "int", "uniform", n, ns);
+
+		ns = bench::measure(opt, q, [&] {
+			long long sum = 0;
+			for (int k : queries)
+				sum += sm.at(k);
+			bench::keep(sum);
+		});
+		bench::report("static_map", "find", "sjtu::map", "int", "uniform", n, ns);
+
+		ns = bench::measure(opt, q, [&] {
+			long long sum = 0;
+			for (int k : queries)
+				sum += stdm.at(k);
+			bench::keep(sum);
+		});
+		bench::report("static_map", "find", "std::map", "int", "uniform", n, ns);
+	}
+	return 0;
+}
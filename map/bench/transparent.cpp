@@ -0,0 +1,109 @@
+// lookups of a sjtu::map<std::string, int> from const char * and from string slices,
+// with and without a transparent comparator.
+// the global operator new is replaced to count the allocations each lookup makes.
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+static long long Allocs = 0;
+
+void *operator new(std::size_t n)
+{
+	Allocs++;
+	if (void *p = std::malloc(n ? n : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+/**
+ * a piece of a parse buffer, what a tokenizer hands out.
+ */
+struct slice
+{
+	const char *Ptr;
+	std::size_t Len;
+
+	slice(const char *p) : Ptr(p), Len(strlen(p)) {}
+
+	operator std::string() const { return std::string(Ptr, Len); }
+};
+
+static int compare(const char *a, std::size_t n, const char *b, std::size_t m)
+{
+	int r = memcmp(a, b, n < m ? n : m);
+	return r ? r : (n > m) - (n < m);
+}
+
+struct slice_less
+{
+	typedef void is_transparent;
+
+	bool operator()(const std::string &a, const std::string &b) const { return a < b; }
+	bool operator()(const std::string &a, const slice &b) const { return compare(a.data(), a.size(), b.Ptr, b.Len) < 0; }
+	bool operator()(const slice &a, const std::string &b) const { return compare(a.Ptr, a.Len, b.data(), b.size()) < 0; }
+};
+
+template <class Map, class Query>
+void run(const bench::options &opt, const char *impl, const char *key)
+{
+	const char *dist = "uniform";
+	for (long long n : opt.sizes())
+	{
+		std::vector<std::string> keys = bench::make_keys<std::string>(dist, n);
+		std::vector<Query> queries;
+		for (const std::string &k : keys)
+			queries.push_back(Query(k.c_str()));
+
+		Map m;
+		for (long long i = 0; i < n; i++)
+			m[keys[i]] = int(i);
+
+		if (opt.wants("find"))
+		{
+			std::function<void()> body = [&] {
+				long long sum = 0;
+				for (const Query &q : queries)
+					sum += m.find(q)->second;
+				bench::keep(sum);
+			};
+			double ns = bench::measure(opt, n, body);
+			long long before = Allocs;
+			body();
+			bench::report("transparent", "find", impl, key, dist, n, ns, "allocs_per_op", double(Allocs - before) / n);
+		}
+
+		if (opt.wants("count"))
+		{
+			std::function<void()> body = [&] {
+				long long sum = 0;
+				for (const Query &q : queries)
+					sum += m.count(q);
+				bench::keep(sum);
+			};
+			double ns = bench::measure(opt, n, body);
+			long long before = Allocs;
+			body();
+			bench::report("transparent", "count", impl, key, dist, n, ns, "allocs_per_op", double(Allocs - before) / n);
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	run<sjtu::map<std::string, int>, const char *>(opt, "sjtu::map<std::less<std::string>>", "const char *");
+	run<sjtu::map<std::string, int, std::less<> >, const char *>(opt, "sjtu::map<std::less<>>", "const char *");
+	run<sjtu::map<std::string, int>, slice>(opt, "sjtu::map<std::less<std::string>>", "slice");
+	run<sjtu::map<std::string, int, slice_less>, slice>(opt, "sjtu::map<slice_less>", "slice");
+	return 0;
+}
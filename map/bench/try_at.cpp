@@ -0,0 +1,90 @@
+// lookups of which a given share misses, through at() with a catch, find_value(), try_at() and
+// find(). the map holds the even keys 0, 2, ..., 2n - 2 and the misses ask for odd ones.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+typedef sjtu::map<long long, long long> Map;
+
+const int MissPercent[] = {0, 50, 90, 100};
+
+std::vector<long long> make_queries(long long n, int miss)
+{
+	std::mt19937_64 rng(19260817);
+	std::vector<long long> ans(n);
+	for (long long i = 0; i < n; i++)
+	{
+		long long k = (long long)(rng() % n) * 2;
+		ans[i] = (long long)(rng() % 100) < miss ? k + 1 : k;
+	}
+	return ans;
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	for (long long n : opt.sizes())
+	{
+		Map m;
+		for (long long x : bench::make_order("uniform", n))
+			m.insert(Map::value_type(2 * x, x));
+
+		for (int miss : MissPercent)
+		{
+			std::string op = "lookup_miss" + std::to_string(miss);
+			if (!opt.wants(op))
+				continue;
+			std::vector<long long> q = make_queries(n, miss);
+
+			double ns = bench::measure(opt, n, [&] {
+				long long sum = 0;
+				for (long long k : q)
+					try
+					{
+						sum += m.at(k);
+					}
+					catch (const sjtu::index_out_of_bound &)
+					{
+						sum--;
+					}
+				bench::keep(sum);
+			});
+			bench::report("try_at", op.c_str(), "sjtu::map/at+catch", "int64", "uniform", n, ns);
+
+			ns = bench::measure(opt, n, [&] {
+				long long sum = 0;
+				for (long long k : q)
+					if (const long long *v = m.find_value(k))
+						sum += *v;
+					else
+						sum--;
+				bench::keep(sum);
+			});
+			bench::report("try_at", op.c_str(), "sjtu::map/find_value", "int64", "uniform", n, ns);
+
+			ns = bench::measure(opt, n, [&] {
+				long long sum = 0, v;
+				for (long long k : q)
+					sum += m.try_at(k, v) ? v : -1;
+				bench::keep(sum);
+			});
+			bench::report("try_at", op.c_str(), "sjtu::map/try_at", "int64", "uniform", n, ns);
+
+			ns = bench::measure(opt, n, [&] {
+				long long sum = 0;
+				for (long long k : q)
+				{
+					Map::const_iterator it = m.find(k);
+					sum += it == m.cend() ? -1 : it->second;
+				}
+				bench::keep(sum);
+			});
+			bench::report("try_at", op.c_str(), "sjtu::map/find", "int64", "uniform", n, ns);
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,106 @@
+// sjtu::unordered_map at several load factors against sjtu::map and std::unordered_map.
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+#include "unordered_map.hpp"
+
+template <class K>
+void insert_one(sjtu::map<K, int> &m, const K &k, int v) { m.insert(sjtu::pair<const K, int>(k, v)); }
+
+template <class K>
+void insert_one(sjtu::unordered_map<K, int> &m, const K &k, int v) { m.insert(sjtu::pair<const K, int>(k, v)); }
+
+template <class K>
+void insert_one(std::unordered_map<K, int> &m, const K &k, int v) { m.insert(std::pair<const K, int>(k, v)); }
+
+template <class Map>
+Map *make(float) { return new Map(); }
+
+template <>
+sjtu::unordered_map<int, int> *make<sjtu::unordered_map<int, int> >(float load) { return new sjtu::unordered_map<int, int>(load); }
+
+template <>
+sjtu::unordered_map<std::string, int> *make<sjtu::unordered_map<std::string, int> >(float load) { return new sjtu::unordered_map<std::string, int>(load); }
+
+template <class K, class Map>
+void run(const bench::options &opt, const char *impl, float load = 0.8f)
+{
+	const char *key = bench::key_name<K>();
+	const char *dist = "uniform";
+
+	for (long long n : opt.sizes())
+	{
+		std::vector<K> keys = bench::make_keys<K>(dist, 2 * n);
+		Map *full = make<Map>(load);
+		for (long long i = 0; i < n; i++)
+			insert_one(*full, keys[i], int(i));
+
+		if (opt.wants("insert"))
+		{
+			Map *m = nullptr;
+			double ns = bench::measure(
+				opt, n, [&] { delete m; m = make<Map>(load); },
+				[&] {
+					for (long long i = 0; i < n; i++)
+						insert_one(*m, keys[i], int(i));
+				});
+			delete m;
+			bench::report("unordered_map", "insert", impl, key, dist, n, ns);
+		}
+
+		if (opt.wants("find-hit"))
+		{
+			double ns = bench::measure(opt, n, [&] {
+				long long sum = 0;
+				for (long long i = 0; i < n; i++)
+					sum += full->find(keys[i])->second;
+				bench::keep(sum);
+			});
+			bench::report("unordered_map", "find-hit", impl, key, dist, n, ns);
+		}
+
+		if (opt.wants("find-miss"))
+		{
+			double ns = bench::measure(opt, n, [&] {
+				long long sum = 0;
+				for (long long i = n; i < 2 * n; i++)
+					sum += full->count(keys[i]);
+				bench::keep(sum);
+			});
+			bench::report("unordered_map", "find-miss", impl, key, dist, n, ns);
+		}
+
+		if (opt.wants("erase"))
+		{
+			Map *m = nullptr;
+			double ns = bench::measure(
+				opt, n, [&] { delete m; m = new Map(*full); },
+				[&] {
+					for (long long i = 0; i < n; i++)
+						m->erase(m->find(keys[i]));
+				});
+			delete m;
+			bench::report("unordered_map", "erase", impl, key, dist, n, ns);
+		}
+
+		delete full;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	run<int, sjtu::unordered_map<int, int> >(opt, "sjtu::unordered_map@0.5", 0.5f);
+	run<int, sjtu::unordered_map<int, int> >(opt, "sjtu::unordered_map@0.8", 0.8f);
+	run<int, sjtu::unordered_map<int, int> >(opt, "sjtu::unordered_map@0.9", 0.9f);
+	run<int, sjtu::map<int, int> >(opt, "sjtu::map");
+	run<int, std::unordered_map<int, int> >(opt, "std::unordered_map");
+	run<std::string, sjtu::unordered_map<std::string, int> >(opt, "sjtu::unordered_map@0.8", 0.8f);
+	run<std::string, sjtu::map<std::string, int> >(opt, "sjtu::map");
+	run<std::string, std::unordered_map<std::string, int> >(opt, "std::unordered_map");
+	return 0;
+}
@@ -0,0 +1,289 @@
+#ifndef SJTU_FROZEN_MAP_HPP
+#define SJTU_FROZEN_MAP_HPP
+
+// a read-only copy of a sjtu::map laid out for lookups, see map::freeze().
+
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+namespace sjtu
+{
+	/**
+	 * an immutable map built from a sjtu::map, for tables built once and read for a long time.
+	 * the elements sit in one sorted array, which is what iteration walks; the keys are copied
+	 * once more into an array in Eytzinger (breadth-first) order, the children of slot k at
+	 * 2k and 2k + 1, which is what the searches walk. a search is a loop without branches on
+	 * the keys that touches one slot per level. the 64 / sizeof(Key) slots log2 of that many
+	 * levels down share one cache line (16 slots 4 levels down for 4-byte keys, 8 slots 3
+	 * levels down for 8-byte ones), so they are prefetched while the levels above are compared.
+	 *
+	 * the read-only interface of sjtu::map: at, operator[], find, find_value, count,
+	 * lower_bound, upper_bound and iteration, with const_iterator a plain pointer.
+	 */
+	template <
+		class Key,
+		class T,
+		class Compare>
+	class frozen_map
+	{
+	public:
+		typedef pair<const Key, T> value_type;
+		typedef const value_type *const_iterator;
+
+	private:
+		value_type *Data; // sorted
+		Key *Keys;		  // Keys[1 .. Size] in Eytzinger order, Keys[0] unused, on a cache line boundary
+		void *KeyBlock;	  // what was allocated for Keys
+		size_t *Rank;	  // Rank[k] is the index in Data of Keys[k]
+		size_t Size;
+		Compare cmp;
+
+		static const size_t Ahead = sizeof(Key) < 64 ? 64 / sizeof(Key) : 1;
+
+		/**
+		 * put Data[i ..] into the subtree of slot k in order, return the next i.
+		 */
+		size_t layout(size_t k, size_t i)
+		{
+			if (k > Size)
+				return i;
+			i = layout(2 * k, i);
+			new (Keys + k) Key(Data[i].first);
+			Rank[k] = i;
+			return layout(2 * k + 1, i + 1);
+		}
+
+		/**
+		 * walk down the Eytzinger tree going right while go_right(key of slot) holds; the answer
+		 * is the last slot where it went left, found by dropping the trailing right turns.
+		 * return that slot, 0 if it never went left.
+		 */
+		template <class Right>
+		size_t descend(Right go_right) const
+		{
+			size_t k = 1;
+			while (k <= Size)
+			{
+				if (Ahead * k <= Size)
+					__builtin_prefetch(Keys + Ahead * k);
+				k = 2 * k + go_right(Keys[k]);
+			}
+			return k >> __builtin_ffsll(~(long long)k);
+		}
+
+		size_t rank(size_t k) const
+		{
+			return k ? Rank[k] : Size;
+		}
+
+		template <class K>
+		size_t lower(const K &key) const
+		{
+			return rank(descend([&](const Key &x) { return cmp(x, key); }));
+		}
+
+		template <class K>
+		size_t upper(const K &key) const
+		{
+			return rank(descend([&](const Key &x) { return !cmp(key, x); }));
+		}
+
+		/**
+		 * the index in Data of key, Size if there is no such key; a miss does not touch Data.
+		 */
+		template <class K>
+		size_t locate(const K &key) const
+		{
+			size_t k = descend([&](const Key &x) { return cmp(x, key); });
+			return k && !cmp(key, Keys[k]) ? Rank[k] : Size;
+		}
+
+		/**
+		 * Keys starts on a cache line, so that the Ahead slots prefetched together share one.
+		 */
+		void allocate(size_t n)
+		{
+			Size = n;
+			Data = static_cast<value_type *>(::operator new(n * sizeof(value_type)));
+			KeyBlock = ::operator new((n + 1) * sizeof(Key) + 63);
+			Keys = reinterpret_cast<Key *>((reinterpret_cast<uintptr_t>(KeyBlock) + 63) & ~uintptr_t(63));
+			Rank = static_cast<size_t *>(::operator new((n + 1) * sizeof(size_t)));
+		}
+
+		void build(const value_type *first, size_t n)
+		{
+			allocate(n);
+			for (size_t i = 0; i < n; i++)
+				new (Data + i) value_type(first[i]);
+			layout(1, 0);
+		}
+
+		void release()
+		{
+			for (size_t i = 0; i < Size; i++)
+				Data[i].~value_type();
+			for (size_t k = 1; k <= Size; k++)
+				Keys[k].~Key();
+			::operator delete(Data);
+			::operator delete(KeyBlock);
+			::operator delete(Rank);
+		}
+
+	public:
+		/**
+		 * copy the elements of m, in O(n).
+		 */
+		template <class Stats, class Checks, class Balance, class Small>
+		explicit frozen_map(const map<Key, T, Compare, Stats, Checks, Balance, Small> &m)
+		{
+			allocate(m.size());
+			size_t i = 0;
+			for (typename map<Key, T, Compare, Stats, Checks, Balance, Small>::const_iterator it = m.cbegin(); it != m.cend(); ++it)
+				new (Data + i++) value_type(*it);
+			layout(1, 0);
+		}
+
+		frozen_map(const frozen_map &other) : cmp(other.cmp) { build(other.Data, other.Size); }
+
+		frozen_map(frozen_map &&other)
+			: Data(other.Data), Keys(other.Keys), KeyBlock(other.KeyBlock), Rank(other.Rank), Size(other.Size), cmp(other.cmp)
+		{
+			other.Data = nullptr, other.Keys = nullptr, other.KeyBlock = nullptr, other.Rank = nullptr, other.Size = 0;
+		}
+
+		frozen_map &operator=(const frozen_map &other)
+		{
+			if (this == &other)
+				return *this;
+			release();
+			cmp = other.cmp;
+			build(other.Data, other.Size);
+			return *this;
+		}
+
+		frozen_map &operator=(frozen_map &&other)
+		{
+			if (this == &other)
+				return *this;
+			release();
+			Data = other.Data, Keys = other.Keys, KeyBlock = other.KeyBlock, Rank = other.Rank, Size = other.Size;
+			cmp = other.cmp;
+			other.Data = nullptr, other.Keys = nullptr, other.KeyBlock = nullptr, other.Rank = nullptr, other.Size = 0;
+			return *this;
+		}
+
+		~frozen_map() { release(); }
+
+		/**
+		 * throw index_out_of_bound if the key does not exist.
+		 */
+		const T &at(const Key &key) const
+		{
+			size_t i = locate(key);
+			if (i == Size)
+				throw index_out_of_bound();
+			return Data[i].second;
+		}
+
+		const T &operator[](const Key &key) const
+		{
+			return at(key);
+		}
+
+		/**
+		 * the mapped value of key, or nullptr if there is no such key.
+		 */
+		const T *find_value(const Key &key) const
+		{
+			size_t i = locate(key);
+			return i == Size ? nullptr : &Data[i].second;
+		}
+
+		const_iterator find(const Key &key) const
+		{
+			return Data + locate(key);
+		}
+
+		size_t count(const Key &key) const
+		{
+			return locate(key) != Size;
+		}
+
+		/**
+		 * the first element whose key is not less than key, end() if none.
+		 */
+		const_iterator lower_bound(const Key &key) const
+		{
+			return Data + lower(key);
+		}
+
+		/**
+		 * the first element whose key is greater than key, end() if none.
+		 */
+		const_iterator upper_bound(const Key &key) const
+		{
+			return Data + upper(key);
+		}
+
+		/**
+		 * the lookups with anything Compare can compare with Key, if Compare is transparent.
+		 */
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		const T &at(const K &key) const
+		{
+			size_t i = locate(key);
+			if (i == Size)
+				throw index_out_of_bound();
+			return Data[i].second;
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		const_iterator find(const K &key) const
+		{
+			return Data + locate(key);
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		size_t count(const K &key) const
+		{
+			return locate(key) != Size;
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		const_iterator lower_bound(const K &key) const
+		{
+			return Data + lower(key);
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		const_iterator upper_bound(const K &key) const
+		{
+			return Data + upper(key);
+		}
+
+		const_iterator begin() const { return Data; }
+
+		const_iterator cbegin() const { return Data; }
+
+		const_iterator end() const { return Data + Size; }
+
+		const_iterator cend() const { return Data + Size; }
+
+		bool empty() const { return !Size; }
+
+		size_t size() const { return Size; }
+	};
+
+	template <class Key, class T, class Compare, class Stats, class Checks, class Balance, class Small>
+	frozen_map<Key, T, Compare> map<Key, T, Compare, Stats, Checks, Balance, Small>::freeze() const
+	{
+		return frozen_map<Key, T, Compare>(*this);
+	}
+}
+
+#endif
@@ -5,114 +5,1212 @@
 
 #include <functional>
 #include <cstddef>
+#include <cmath>
+#include <new>
+#include <ostream>
+#include <type_traits>
 #include "utility.hpp"
 #include "exceptions.hpp"
 
 namespace sjtu
 {
 
+	/**
+	 * where the nodes of a RBTree live.
+	 * the default one keeps every node on the heap and links them by raw pointers,
+	 * see mapped_map.hpp for a file-backed one linked by offsets.
+	 *
+	 * RBTree::compact() moves nodes into arenas, blocks of nodes side by side handed out in
+	 * order; a node of an arena is destroyed in place and the arena is freed with its last node.
+	 */
+	struct heap_storage
+	{
+		template <class N>
+		struct rebind
+		{
+			typedef N *link;
+		};
+
+		struct arena
+		{
+			arena *Prev;
+			char *First, *Last; // the nodes, [First, Last)
+			size_t Used, Live;	// bytes handed out, nodes not released
+		};
+
+		arena *Arenas;	// linked by Prev, the newest first
+		arena *Filling; // the one open_arena() made, until close_arena()
+
+		heap_storage() : Arenas(nullptr), Filling(nullptr) {}
+
+		// a copy of a tree makes its own nodes
+		heap_storage(const heap_storage &) : Arenas(nullptr), Filling(nullptr) {}
+
+		heap_storage &operator=(const heap_storage &) { return *this; }
+
+		// the tree has released every node by now, only an empty open arena can be left
+		~heap_storage() { close_arena(); }
+
+		template <class N, class... Args>
+		N *create(Args &&...args) { return new N(std ::forward<Args>(args)...); }
+
+		template <class N>
+		void destroy(N *x)
+		{
+			if (arena *a = owner(x))
+			{
+				x->~N();
+				vacate(a);
+			}
+			else
+				delete x;
+		}
+
+		/**
+		 * free the memory of x, whose value is already destroyed.
+		 */
+		template <class N>
+		void release(N *x)
+		{
+			if (arena *a = owner(x))
+				vacate(a);
+			else
+				::operator delete(static_cast<void *>(x));
+		}
+
+		/**
+		 * the arena x lies in, nullptr for a node of its own.
+		 * there are only a few: an arena empties when the next compaction moves its nodes out.
+		 */
+		arena *owner(const void *x) const
+		{
+			const char *p = static_cast<const char *>(x);
+			for (arena *a = Arenas; a; a = a->Prev)
+				if (std ::less_equal<const char *>()(a->First, p) && std ::less<const char *>()(p, a->Last))
+					return a;
+			return nullptr;
+		}
+
+		/**
+		 * open an arena of n nodes of type N for from_arena().
+		 */
+		template <class N>
+		void open_arena(size_t n)
+		{
+			const size_t Head = (sizeof(arena) + alignof(N) - 1) / alignof(N) * alignof(N);
+			char *p = static_cast<char *>(::operator new(Head + n * sizeof(N)));
+			arena *a = reinterpret_cast<arena *>(p);
+			a->Prev = Arenas;
+			a->First = p + Head;
+			a->Last = a->First + n * sizeof(N);
+			a->Used = a->Live = 0;
+			Arenas = Filling = a;
+		}
+
+		/**
+		 * the next node of the open arena, nullptr once it is full.
+		 */
+		template <class N, class... Args>
+		N *from_arena(Args &&...args)
+		{
+			if (Filling->First + Filling->Used == Filling->Last)
+				return nullptr;
+			N *x = new (Filling->First + Filling->Used) N(std ::forward<Args>(args)...);
+			Filling->Used += sizeof(N);
+			Filling->Live++;
+			return x;
+		}
+
+		void close_arena()
+		{
+			arena *a = Filling;
+			Filling = nullptr;
+			if (a && !a->Live)
+				unlink(a);
+		}
+
+		/**
+		 * take over the arenas of other, for a tree taking over the nodes of another.
+		 */
+		void adopt(heap_storage &other)
+		{
+			other.close_arena();
+			if (!other.Arenas)
+				return;
+			arena *a = other.Arenas;
+			while (a->Prev)
+				a = a->Prev;
+			a->Prev = Arenas;
+			Arenas = other.Arenas;
+			other.Arenas = nullptr;
+		}
+
+	private:
+		/**
+		 * a node of arena a left it; free a once it has no live nodes and is not the one being filled.
+		 */
+		void vacate(arena *a)
+		{
+			if (!--a->Live && a != Filling)
+				unlink(a);
+		}
+
+		void unlink(arena *a)
+		{
+			arena **p = &Arenas;
+			while (*p != a)
+				p = &(*p)->Prev;
+			*p = a->Prev;
+			::operator delete(static_cast<void *>(a));
+		}
+	};
+
+	/**
+	 * statistics policy of RBTree which counts nothing.
+	 * every hook is empty so the counting calls vanish.
+	 */
+	struct tree_no_stats
+	{
+		void compare() {}
+		void find() {}
+		void insert() {}
+		void erase() {}
+		void rotate() {}
+		void recolor(int = 1) {}
+		void reset() {}
+		void dump(std ::ostream &) const {}
+	};
+
+	/**
+	 * statistics policy of RBTree which counts what the tree does.
+	 * rotations and recolorings are charged to the insert or erase in progress.
+	 */
+	struct tree_stats
+	{
+		unsigned long long Comparisons, Finds, Inserts, Erases;
+		unsigned long long InsertRotations, EraseRotations, InsertRecolors, EraseRecolors;
+		bool Erasing;
+
+		tree_stats() { reset(); }
+
+		void compare() { Comparisons++; }
+		void find() { Finds++; }
+		void insert() { Inserts++, Erasing = false; }
+		void erase() { Erases++, Erasing = true; }
+		void rotate() { (Erasing ? EraseRotations : InsertRotations)++; }
+		void recolor(int k = 1) { (Erasing ? EraseRecolors : InsertRecolors) += k; }
+
+		void reset()
+		{
+			Comparisons = Finds = Inserts = Erases = 0;
+			InsertRotations = EraseRotations = InsertRecolors = EraseRecolors = 0;
+			Erasing = false;
+		}
+
+		void dump(std ::ostream &os) const
+		{
+			os << "comparisons " << Comparisons << " in " << Finds << " descents ("
+			   << (Finds ? double(Comparisons) / Finds : 0) << " per descent)\n"
+			   << "inserts " << Inserts << ": rotations " << InsertRotations << ", recolorings " << InsertRecolors << "\n"
+			   << "erases " << Erases << ": rotations " << EraseRotations << ", recolorings " << EraseRecolors << "\n";
+		}
+	};
+
+	/**
+	 * the serial number of a node, remembered by the iterators pointing to it.
+	 * no_serial is the empty one of the policies which do not check generations.
+	 */
+	struct no_serial
+	{
+		unsigned long long serial() const { return 0; }
+		void set_serial(unsigned long long) {}
+	};
+
+	struct node_serial
+	{
+		unsigned long long Serial;
+
+		unsigned long long serial() const { return Serial; }
+		void set_serial(unsigned long long s) { Serial = s; }
+	};
+
+	/**
+	 * iterator checking policy of map, the default:
+	 * ++end(), --begin() and erase(end()) throw invalid_iterator,
+	 * and erase() looks the key up to make sure the iterator belongs to the map.
+	 */
+	struct iterator_checks
+	{
+		static const bool Bounds = true, Generations = false;
+		typedef no_serial serial;
+	};
+
+	/**
+	 * iterator checking policy of map which checks nothing:
+	 * ++ and -- are one pointer step and erase() trusts its argument,
+	 * a bad iterator is undefined behaviour as with std::map.
+	 */
+	struct unchecked_iterators
+	{
+		static const bool Bounds = false, Generations = false;
+		typedef no_serial serial;
+	};
+
+	/**
+	 * iterator checking policy of map which also catches, in O(1), iterators used after their
+	 * element was erased (or the map cleared or assigned to) and iterators of another map.
+	 * every node gets a new serial number when it is made and the iterators remember it;
+	 * an erased node is kept by the tree for the next insert instead of freed, so a stale
+	 * iterator still points to a node, whose serial no longer matches.
+	 */
+	struct checked_iterators
+	{
+		static const bool Bounds = true, Generations = true;
+		typedef node_serial serial;
+	};
+
+	/**
+	 * balancing policy of RBTree, the default: a red-black tree.
+	 * the height stays under 2 log2(n + 1) with at most 2 rotations per insert and 3 per erase.
+	 */
+	struct red_black_balance
+	{
+		enum ColorSet
+		{
+			Red,
+			Black
+		};
+
+		struct node
+		{
+			bool Col;
+		};
+
+		/**
+		 * x was just linked in as a leaf.
+		 */
+		template <class Tree, class Node>
+		void inserted(Tree &t, Node *x)
+		{
+			x->Col = Red;
+			Node *Fa = x->Fa;
+			while (Fa && Fa->Col == Red)
+			{
+				Node *Gfa = Fa->Fa;
+				Node *Unc = (Fa == Gfa->LT) ? Gfa->RT : Gfa->LT;
+
+				if (Unc && Unc->Col == Red)
+				{
+					Fa->Col = Unc->Col = Black;
+					Gfa->Col = Red;
+					t.St.recolor(3);
+					x = Gfa;
+					Fa = x->Fa;
+				}
+				else
+				{
+					if (Fa == Gfa->LT)
+					{
+						if (x == Fa->RT)
+							t.left_rotate(Fa), std ::swap(x, Fa);
+
+						Fa->Col = Black;
+						Gfa->Col = Red;
+						t.St.recolor(2);
+						t.right_rotate(Gfa);
+					}
+					else
+					{
+						if (x == Fa->LT)
+							t.right_rotate(Fa), std ::swap(x, Fa);
+
+						Fa->Col = Black;
+						Gfa->Col = Red;
+						t.St.recolor(2);
+						t.left_rotate(Gfa);
+					}
+				}
+			}
+
+			if (!Fa && x->Col == Red)
+				x->Col = Black, t.St.recolor();
+		}
+
+		/**
+		 * take z out of the shape of the tree; its nxt / pre thread is still intact.
+		 */
+		template <class Tree, class Node>
+		void erase(Tree &t, Node *z)
+		{
+			bool DelCol = z->LT && z->RT ? t.leftmost(z->RT)->Col : z->Col;
+			Node *Fa, *x;
+			t.unlink(z, Fa, x);
+
+			if (DelCol == Black)
+			{
+				while (x != t.Root && (!x || x->Col == Black))
+				{
+					if (x == Fa->LT)
+					{
+						Node *Bro = Fa->RT;
+						if (Bro->Col == Red)
+						{
+							Bro->Col = Black;
+							Fa->Col = Red;
+							t.St.recolor(2);
+							t.left_rotate(Fa);
+							Bro = Fa->RT;
+						}
+
+						if ((!Bro->LT || Bro->LT->Col == Black) && (!Bro->RT || Bro->RT->Col == Black))
+						{
+							Bro->Col = Red;
+							t.St.recolor();
+							x = Fa;
+							Fa = x->Fa;
+						}
+						else
+						{
+							if (!Bro->RT || Bro->RT->Col == Black)
+							{
+								Node *Nie = Bro->LT;
+								Nie->Col = Black;
+								Bro->Col = Red;
+								t.St.recolor(2);
+								t.right_rotate(Bro);
+								Bro = Nie;
+							}
+
+							Bro->Col = Fa->Col;
+							Fa->Col = Black;
+							Bro->RT->Col = Black;
+							t.St.recolor(3);
+							t.left_rotate(Fa);
+							x = t.Root;
+						}
+					}
+					else
+					{
+						Node *Bro = Fa->LT;
+						if (Bro->Col == Red)
+						{
+							Bro->Col = Black;
+							Fa->Col = Red;
+							t.St.recolor(2);
+							t.right_rotate(Fa);
+							Bro = Fa->LT;
+						}
+						if ((!Bro->LT || Bro->LT->Col == Black) && (!Bro->RT || Bro->RT->Col == Black))
+						{
+							Bro->Col = Red;
+							t.St.recolor();
+							x = Fa;
+							Fa = x->Fa;
+						}
+						else
+						{
+							if (!Bro->LT || Bro->LT->Col == Black)
+							{
+								Node *Nie = Bro->RT;
+								Nie->Col = Black;
+								Bro->Col = Red;
+								t.St.recolor(2);
+								t.left_rotate(Bro);
+								Bro = Nie;
+							}
+
+							Bro->Col = Fa->Col;
+							Fa->Col = Black;
+							Bro->LT->Col = Black;
+							t.St.recolor(3);
+							t.right_rotate(Fa);
+							x = t.Root;
+						}
+					}
+				}
+
+				if (x)
+					x->Col = Black, t.St.recolor();
+			}
+		}
+
+		/**
+		 * a lookup found x.
+		 */
+		template <class Tree, class Node>
+		void accessed(Tree &, Node *) {}
+
+		/**
+		 * the black height of the subtree of x, or -1 if a red node has a red child
+		 * or two paths differ in black nodes.
+		 */
+		template <class Node>
+		int black_height(const Node *x) const
+		{
+			if (!x)
+				return 1;
+			const Node *l = x->LT, *r = x->RT;
+			if (x->Col == Red && ((l && l->Col == Red) || (r && r->Col == Red)))
+				return -1;
+			int lh = black_height(l), rh = black_height(r);
+			if (lh < 0 || lh != rh)
+				return -1;
+			return lh + (x->Col == Black);
+		}
+
+		template <class Tree>
+		bool validate(const Tree &t) const
+		{
+			return !t.Root || (t.Root->Col == Black && black_height<typename Tree::Node>(t.Root) >= 0);
+		}
+	};
+
+	/**
+	 * balancing policy of RBTree: an AVL tree.
+	 * the height stays under 1.44 log2(n + 2), so lookups visit fewer nodes than in a red-black
+	 * tree, for more rotations on updates.
+	 */
+	struct avl_balance
+	{
+		struct node
+		{
+			int Height;
+		};
+
+		template <class Node>
+		static int height(const Node *x) { return x ? x->Height : 0; }
+
+		template <class Node>
+		static void update(Node *x)
+		{
+			int l = height<Node>(x->LT), r = height<Node>(x->RT);
+			x->Height = (l > r ? l : r) + 1;
+		}
+
+		/**
+		 * recompute the height of x, rotating if its children differ by 2.
+		 * return the node now at the place of x.
+		 */
+		template <class Tree, class Node>
+		static Node *fix(Tree &t, Node *x)
+		{
+			Node *l = x->LT, *r = x->RT;
+			int b = height(l) - height(r);
+			if (b > 1)
+			{
+				if (height<Node>(l->LT) < height<Node>(l->RT))
+					t.left_rotate(l), update(l), update<Node>(l->Fa);
+				t.right_rotate(x);
+			}
+			else if (b < -1)
+			{
+				if (height<Node>(r->RT) < height<Node>(r->LT))
+					t.right_rotate(r), update(r), update<Node>(r->Fa);
+				t.left_rotate(x);
+			}
+			update(x);
+			Node *y = b > 1 || b < -1 ? static_cast<Node *>(x->Fa) : x;
+			update(y);
+			return y;
+		}
+
+		/**
+		 * fix the heights from x up, until a subtree keeps its height.
+		 */
+		template <class Tree, class Node>
+		static void retrace(Tree &t, Node *x)
+		{
+			while (x)
+			{
+				int Old = x->Height;
+				x = fix(t, x);
+				if (x->Height == Old)
+					break;
+				x = x->Fa;
+			}
+		}
+
+		template <class Tree, class Node>
+		void inserted(Tree &t, Node *x)
+		{
+			x->Height = 1;
+			retrace(t, static_cast<Node *>(x->Fa));
+		}
+
+		template <class Tree, class Node>
+		void erase(Tree &t, Node *x)
+		{
+			Node *Fa, *p;
+			t.unlink(x, Fa, p);
+			retrace(t, Fa);
+		}
+
+		template <class Tree, class Node>
+		void accessed(Tree &, Node *) {}
+
+		template <class Tree>
+		bool validate(const Tree &t) const
+		{
+			typedef typename Tree::Node Node;
+			for (const Node *x = t.Begin; x; x = x->nxt)
+			{
+				int l = height<Node>(x->LT), r = height<Node>(x->RT);
+				if (x->Height != (l > r ? l : r) + 1 || l - r > 1 || r - l > 1)
+					return false;
+			}
+			return true;
+		}
+	};
+
+	/**
+	 * balancing policy of RBTree: a splay tree.
+	 * every lookup, insert and erase moves its node to the root, so keys used often stay near
+	 * the top; O(log n) amortized, but the tree may be a long path for a while (sorted inserts
+	 * build one). lookups change the tree even through a const map, so it is not for concurrent
+	 * readers.
+	 */
+	struct splay_balance
+	{
+		struct node
+		{
+		};
+
+		/**
+		 * move x above its parent.
+		 */
+		template <class Tree, class Node>
+		static void rotate(Tree &t, Node *x)
+		{
+			Node *f = x->Fa;
+			if (f->LT == x)
+				t.right_rotate(f);
+			else
+				t.left_rotate(f);
+		}
+
+		/**
+		 * rotate x up until its parent is Goal.
+		 */
+		template <class Tree, class Node>
+		static void splay(Tree &t, Node *x, Node *Goal)
+		{
+			while (x->Fa != Goal)
+			{
+				Node *f = x->Fa, *g = f->Fa;
+				if (g != Goal)
+					rotate(t, (g->LT == f) == (f->LT == x) ? f : x);
+				rotate(t, x);
+			}
+		}
+
+		template <class Tree, class Node>
+		void inserted(Tree &t, Node *x) { splay(t, x, static_cast<Node *>(nullptr)); }
+
+		/**
+		 * splay x to the root, then its predecessor to the top of its left subtree
+		 * and hang the right subtree there.
+		 */
+		template <class Tree, class Node>
+		void erase(Tree &t, Node *x)
+		{
+			splay(t, x, static_cast<Node *>(nullptr));
+			Node *l = x->LT, *r = x->RT;
+			if (!l)
+			{
+				t.Root = r;
+				if (r)
+					r->Fa = nullptr;
+				return;
+			}
+			Node *m = x->pre;
+			splay(t, m, x);
+			m->RT = r;
+			if (r)
+				r->Fa = m;
+			m->Fa = nullptr;
+			t.Root = m;
+		}
+
+		template <class Tree, class Node>
+		void accessed(Tree &t, Node *x) { splay(t, x, static_cast<Node *>(nullptr)); }
+
+		template <class Tree>
+		bool validate(const Tree &) const { return true; }
+	};
+
+	/**
+	 * balancing policy of RBTree: a treap, a search tree on the keys and a heap on random
+	 * priorities, for O(log n) expected depth with few rotations and nothing to recompute.
+	 * the priorities come from a counter through a mixer, so a tree is built the same every run.
+	 */
+	struct treap_balance
+	{
+		struct node
+		{
+			unsigned Priority;
+		};
+
+		unsigned long long Seed;
+
+		treap_balance() : Seed(0) {}
+
+		unsigned priority()
+		{
+			unsigned long long z = (Seed += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return unsigned(z ^ (z >> 31));
+		}
+
+		template <class Tree, class Node>
+		void inserted(Tree &t, Node *x)
+		{
+			x->Priority = priority();
+			for (Node *f = x->Fa; f && f->Priority < x->Priority; f = x->Fa)
+				if (f->LT == x)
+					t.right_rotate(f);
+				else
+					t.left_rotate(f);
+		}
+
+		/**
+		 * rotate x down below its children until it has at most one, then splice it out.
+		 */
+		template <class Tree, class Node>
+		void erase(Tree &t, Node *x)
+		{
+			while (x->LT && x->RT)
+			{
+				Node *l = x->LT, *r = x->RT;
+				if (l->Priority > r->Priority)
+					t.right_rotate(x);
+				else
+					t.left_rotate(x);
+			}
+			Node *Fa, *p;
+			t.unlink(x, Fa, p);
+		}
+
+		template <class Tree, class Node>
+		void accessed(Tree &, Node *) {}
+
+		/**
+		 * cut the treap x into the nodes whose key is less than Key, returned, and the others,
+		 * left in r, along one path down: O(log n) expected. the threads are left alone.
+		 */
+		template <class Tree, class Node, class K>
+		static Node *split(Tree &t, Node *x, const K &Key, Node *&r)
+		{
+			Node *l = nullptr, *lt = nullptr, *rt = nullptr; // lt and rt wait for a right and a left child
+			r = nullptr;
+			while (x)
+				if (t.less(x->Key(), Key))
+				{
+					(lt ? lt->RT : l) = x;
+					x->Fa = lt;
+					lt = x, x = x->RT;
+				}
+				else
+				{
+					(rt ? rt->LT : r) = x;
+					x->Fa = rt;
+					rt = x, x = x->LT;
+				}
+			if (lt)
+				lt->RT = nullptr;
+			if (rt)
+				rt->LT = nullptr;
+			return l;
+		}
+
+		/**
+		 * the treap of the nodes of l and r, every key of l less than every key of r,
+		 * merging the right spine of l with the left spine of r: O(log n) expected.
+		 */
+		template <class Node>
+		static Node *join(Node *l, Node *r)
+		{
+			Node *Root = nullptr, *Fa = nullptr;
+			bool Right = false; // the hole to fill is the right child of Fa, or the left one
+			while (l && r)
+			{
+				Node *x = l->Priority > r->Priority ? l : r;
+				(Fa ? (Right ? Fa->RT : Fa->LT) : Root) = x;
+				x->Fa = Fa;
+				Fa = x;
+				if ((Right = x == l))
+					l = l->RT;
+				else
+					r = r->LT;
+			}
+			Node *x = l ? l : r;
+			(Fa ? (Right ? Fa->RT : Fa->LT) : Root) = x;
+			if (x)
+				x->Fa = Fa;
+			return Root;
+		}
+
+		template <class Tree>
+		bool validate(const Tree &t) const
+		{
+			typedef typename Tree::Node Node;
+			for (const Node *x = t.Begin; x; x = x->nxt)
+			{
+				const Node *l = x->LT, *r = x->RT;
+				if ((l && l->Priority > x->Priority) || (r && r->Priority > x->Priority))
+					return false;
+			}
+			return true;
+		}
+	};
+
+	/**
+	 * small-size policy of map: up to N elements are kept in a sorted array inside the map
+	 * object, and the tree is only allocated for the N + 1-th, so a map that never holds more
+	 * than N elements makes no allocation at all. once grown, a map keeps its tree.
+	 * while the elements are inline, insert() and erase() move the elements after the
+	 * position and so, as with a vector, invalidate the iterators at and after it;
+	 * growing into a tree invalidates all of them. under checked_iterators any change of
+	 * the inline elements makes the iterators taken before it throw.
+	 * no_small_buffer, the default, always has a tree and keeps no array.
+	 */
+	template <size_t N>
+	struct small_buffer
+	{
+		static const size_t Capacity = N;
+	};
+
+	typedef small_buffer<0> no_small_buffer;
+
+	/**
+	 * the array of small_elements, with the serial of its content under checked_iterators.
+	 */
+	template <class V, class Serial, size_t N>
+	struct small_storage : Serial
+	{
+		size_t Count;
+		alignas(V) unsigned char Raw[N * sizeof(V)];
+
+		V *data() const { return reinterpret_cast<V *>(const_cast<unsigned char *>(Raw)); }
+		size_t size() const { return Count; }
+		void resize(size_t n) { Count = n; }
+	};
+
+	template <class V, class Serial>
+	struct small_storage<V, Serial, 0> : no_serial
+	{
+		V *data() const { return nullptr; }
+		size_t size() const { return 0; }
+		void resize(size_t) {}
+	};
+
+	/**
+	 * where an iterator of inline elements is: the array, and the element or nullptr for end().
+	 */
+	template <class E, class V, size_t N>
+	struct small_position
+	{
+		E *Of;
+		V *Elem;
+
+		small_position() : Of(nullptr), Elem(nullptr) {}
+		small_position(E *_Of, V *_Elem) : Of(_Of), Elem(_Elem) {}
+
+		E *of() const { return Of; }
+		V *elem() const { return Elem; }
+		void set_elem(V *x) { Elem = x; }
+	};
+
+	template <class E, class V>
+	struct small_position<E, V, 0>
+	{
+		small_position() {}
+		small_position(E *, V *) {}
+
+		E *of() const { return nullptr; }
+		V *elem() const { return nullptr; }
+		void set_elem(V *) {}
+	};
+
+	/**
+	 * the sorted inline array of a map under small_buffer<N>, empty for N = 0.
+	 * the searches are binary, and never count comparisons in the Stats of the map.
+	 */
+	template <class Key, class T, class Compare, class Checks, size_t N>
+	class small_elements : small_storage<pair<const Key, T>, typename Checks::serial, N>
+	{
+	public:
+		typedef pair<const Key, T> value_type;
+		typedef small_position<small_elements, value_type, N> position;
+
+		using small_storage<value_type, typename Checks::serial, N>::data;
+		using small_storage<value_type, typename Checks::serial, N>::size;
+		using small_storage<value_type, typename Checks::serial, N>::serial;
+
+	private:
+		/**
+		 * every change gives the array a new serial, see small_buffer.
+		 */
+		void changed() { this->set_serial(serial() + 1); }
+
+		/**
+		 * the number of elements for which before(element key) holds, a prefix of the array.
+		 */
+		template <class Before>
+		size_t prefix(Before before) const
+		{
+			size_t l = 0, r = size();
+			while (l < r)
+			{
+				size_t mid = (l + r) / 2;
+				if (before(data()[mid].first))
+					l = mid + 1;
+				else
+					r = mid;
+			}
+			return l;
+		}
+
+		value_type *at(size_t i) const { return i < size() ? data() + i : nullptr; }
+
+		void copy(const small_elements &other)
+		{
+			for (size_t i = 0; i < other.size(); i++)
+			{
+				new (data() + i) value_type(other.data()[i]);
+				this->resize(i + 1);
+			}
+		}
+
+	public:
+		small_elements()
+		{
+			this->resize(0);
+			this->set_serial(0);
+		}
+
+		small_elements(const small_elements &other)
+		{
+			this->resize(0);
+			this->set_serial(0);
+			copy(other);
+		}
+
+		~small_elements() { clear(); }
+
+		void assign(const small_elements &other)
+		{
+			clear();
+			copy(other);
+		}
+
+		value_type *first() const { return at(0); }
+
+		value_type *last() const { return size() ? data() + size() - 1 : nullptr; }
+
+		value_type *next(value_type *x) const { return at(x - data() + 1); }
+
+		value_type *prev(value_type *x) const { return x == data() ? nullptr : x - 1; }
+
+		bool owns(const value_type *x) const { return x && x >= data() && x < data() + size(); }
+
+		template <class K>
+		value_type *lower_bound(const K &key) const
+		{
+			Compare cmp;
+			return at(prefix([&](const Key &x) { return cmp(x, key); }));
+		}
+
+		template <class K>
+		value_type *upper_bound(const K &key) const
+		{
+			Compare cmp;
+			return at(prefix([&](const Key &x) { return !cmp(key, x); }));
+		}
+
+		template <class K>
+		value_type *find(const K &key) const
+		{
+			value_type *x = lower_bound(key);
+			return x && !Compare()(key, x->first) ? x : nullptr;
+		}
+
+		/**
+		 * insert in order, return the element of key and whether it is new,
+		 * or nullptr if key is new but the array is full.
+		 */
+		std ::pair<value_type *, bool> insert(const Key &key, const T &val)
+		{
+			value_type *x = lower_bound(key);
+			if (x && !Compare()(key, x->first))
+				return std ::pair<value_type *, bool>(x, false);
+			if (size() == N)
+				return std ::pair<value_type *, bool>(nullptr, false);
+			value_type *p = x ? x : data() + size();
+			for (value_type *y = data() + size(); y != p; y--)
+			{
+				new (y) value_type(y[-1]);
+				y[-1].~value_type();
+			}
+			new (p) value_type(key, val);
+			this->resize(size() + 1);
+			changed();
+			return std ::pair<value_type *, bool>(p, true);
+		}
+
+		void erase(value_type *x)
+		{
+			x->~value_type();
+			for (value_type *e = data() + size() - 1; x != e; x++)
+			{
+				new (x) value_type(x[1]);
+				x[1].~value_type();
+			}
+			this->resize(size() - 1);
+			changed();
+		}
+
+		void clear()
+		{
+			for (size_t i = 0; i < size(); i++)
+				data()[i].~value_type();
+			this->resize(0);
+			changed();
+		}
+
+		bool validate() const
+		{
+			Compare cmp;
+			for (size_t i = 1; i < size(); i++)
+				if (!cmp(data()[i - 1].first, data()[i].first))
+					return false;
+			return true;
+		}
+	};
+
 	template <
 		class Key,
 		class T,
-		class Compare = std::less<Key> >
+		class Compare = std::less<Key>,
+		class Stats = tree_no_stats,
+		class Checks = iterator_checks,
+		class Balance = red_black_balance,
+		class Small = no_small_buffer>
 	class map;
 
+	template <
+		class Key,
+		class T,
+		class Compare>
+	class mapped_map;
+
+	template <
+		class Key,
+		class T,
+		class Compare>
+	class frozen_map;
+
 	template <
 		class KeyType,
 		class T,
-		class Compare = std::less<KeyType> >
+		class Compare = std::less<KeyType>,
+		class Storage = heap_storage,
+		class Stats = tree_no_stats,
+		class Checks = iterator_checks,
+		class Balance = red_black_balance>
 	class RBTree
 	{
-		friend class map<KeyType, T, Compare>;
+		template <class, class, class, class, class, class, class>
+		friend class map;
+		friend Balance;
+		friend class mapped_map<KeyType, T, Compare>;
 		typedef pair<const KeyType, T> value_type;
 
 	private:
-		struct Node
+		struct Node;
+		typedef typename Storage ::template rebind<Node>::link Link;
+
+		struct Node : Checks::serial, Balance::node
 		{
 			value_type ValueField;
-			bool Col;
-			Node *LT, *RT, *Fa, *nxt, *pre;
+			Link LT, RT, Fa, nxt, pre;
 
 			Node() = delete;
 
-			Node(const KeyType &_Key, const T &_Val, const bool _Col = Red)
-				: ValueField(value_type(_Key, _Val)), Col(_Col), LT(nullptr), RT(nullptr), Fa(nullptr), nxt(nullptr), pre(nullptr) {}
+			/**
+			 * the balancing data is set by Balance::inserted(), or copied.
+			 */
+			Node(const KeyType &_Key, const T &_Val)
+				: ValueField(value_type(_Key, _Val)), LT(nullptr), RT(nullptr), Fa(nullptr), nxt(nullptr), pre(nullptr) {}
+
+			const KeyType &Key() const { return ValueField.first; }
 
-			Node(const Node *const &other)
-				: LT(nullptr), RT(nullptr), Fa(nullptr), nxt(nullptr), pre(nullptr), Col(other->Col), ValueField(other->ValueField) {}
+			T &Val() { return ValueField.second; }
+
+			const T &Val() const { return ValueField.second; }
+		};
 
-			~Node()
+		Link Root, Begin, End;
+		int Size;
+		Compare cmp;
+		Stats St;
+		Storage Alloc;
+		Balance Bal;
+		unsigned long long Serials;
+		Node *Graveyard; // erased nodes kept for reuse under checked_iterators, linked by nxt
+		Node *Moving;	 // the next node compact() moves, nullptr once the pass is over
+
+	public:
+		RBTree() : Root(nullptr), Begin(nullptr), End(nullptr), Size(0), Serials(0), Graveyard(nullptr), Moving(nullptr) {}
+
+		~RBTree()
+		{
+			destroy();
+			// only their values were destroyed, see drop()
+			while (Graveyard)
 			{
-				delete LT;
-				delete RT;
+				Node *x = Graveyard;
+				Graveyard = x->nxt;
+				Alloc.release(x);
 			}
+		}
 
-			const KeyType Key() const { return ValueField.first; }
+		const int get_size() const { return Size; }
 
-			T &Val() { return ValueField.second; }
+		template <class A, class B>
+		bool less(const A &a, const B &b)
+		{
+			St.compare();
+			return cmp(a, b);
+		}
 
-			const T &Val() const { return ValueField.second; }
+		/**
+		 * a node with a new serial, from the graveyard if there is one.
+		 */
+		Node *make(const KeyType &Key, const T &Val)
+		{
+			Node *x;
+			if (Checks::Generations && Graveyard)
+			{
+				x = Graveyard;
+				Graveyard = x->nxt;
+				new (&x->ValueField) value_type(Key, Val);
+				x->LT = x->RT = x->Fa = x->nxt = x->pre = nullptr;
+			}
+			else
+				x = Alloc.template create<Node>(Key, Val);
+			x->set_serial(++Serials);
+			return x;
+		}
 
-			const bool get_Col() const { return Col; }
-		};
+		/**
+		 * free x, or under checked_iterators destroy its value and bury it with serial 0.
+		 */
+		void drop(Node *x)
+		{
+			if (Checks::Generations)
+			{
+				x->ValueField.~value_type();
+				x->set_serial(0);
+				x->nxt = Graveyard;
+				Graveyard = x;
+			}
+			else
+				Alloc.destroy(x);
+		}
 
-		Node *Root, *Begin, *End;
-		int Size;
-		enum ColorSet
+		/**
+		 * drop every node, along the thread: a splay tree can be too deep to recurse on.
+		 */
+		void destroy()
 		{
-			Red,
-			Black
-		};
-		Compare cmp;
+			for (Node *x = Begin; x;)
+			{
+				Node *Next = x->nxt;
+				drop(x);
+				x = Next;
+			}
+			Root = Begin = End = nullptr;
+			Moving = nullptr;
+			Size = 0;
+		}
 
-	public:
-		RBTree() : Root(nullptr), Begin(nullptr), End(nullptr), Size(0) {}
+		void clear()
+		{
+			destroy();
+		}
 
-		~RBTree() { delete Root; }
+		/**
+		 * the in-order successor of x by the shape of the tree, not the thread.
+		 */
+		static Node *successor(Node *x)
+		{
+			if (x->RT)
+				return leftmost(x->RT);
+			while (x->Fa && x->Fa->RT == x)
+				x = x->Fa;
+			return x->Fa;
+		}
 
-		const int get_size() const { return Size; }
+		static Node *leftmost(Node *x)
+		{
+			while (x->LT)
+				x = x->LT;
+			return x;
+		}
 
-		std ::pair<Node *, Node *> copy(Node *&x, const Node *const &y)
+		/**
+		 * make Root a copy of the tree of y, shape and balancing data included, then thread it.
+		 * both walks follow Fa links instead of recursing, for deep trees.
+		 */
+		void copy(const Node *y)
 		{
+			Root = Begin = End = nullptr;
 			if (!y)
-			{
-				x = nullptr;
-				return std ::pair<Node *, Node *>(nullptr, nullptr);
-			}
-
-			x = new Node(y);
+				return;
+			const Node *Top = y;
+			Node *x = Root = clone(y);
+			for (;;)
+				if (y->LT && !x->LT)
+				{
+					x->LT = clone(y = y->LT);
+					x->LT->Fa = x;
+					x = x->LT;
+				}
+				else if (y->RT && !x->RT)
+				{
+					x->RT = clone(y = y->RT);
+					x->RT->Fa = x;
+					x = x->RT;
+				}
+				else if (y == Top)
+					break;
+				else
+					y = y->Fa, x = x->Fa;
 
-			Node *ans1 = nullptr, *ans2 = nullptr;
-			if (y->LT)
-			{
-				std ::pair<Node *, Node *> ans = copy(x->LT, y->LT);
-				ans1 = ans.first;
-				x->pre = ans.second;
-				x->LT->Fa = x;
-				x->pre->nxt = x;
-			}
-			if (y->RT)
+			Node *Last = nullptr;
+			for (x = Begin = leftmost(Root); x; Last = x, x = successor(x))
 			{
-				std ::pair<Node *, Node *> ans = copy(x->RT, y->RT);
-				x->nxt = ans.first;
-				ans2 = ans.second;
-				x->RT->Fa = x;
-				x->nxt->pre = x;
+				x->pre = Last;
+				if (Last)
+					Last->nxt = x;
 			}
+			End = Last;
+		}
 
-			return std ::pair<Node *, Node *>(ans1 ? ans1 : x, ans2 ? ans2 : x);
+		Node *clone(const Node *y)
+		{
+			Node *x = make(y->Key(), y->Val());
+			static_cast<typename Balance::node &>(*x) = *y;
+			return x;
 		}
 
-		RBTree(const RBTree &other)
+		RBTree(const RBTree &other) : Serials(0), Graveyard(nullptr), Moving(nullptr)
 		{
 			cmp = other.cmp;
+			Bal = other.Bal;
+			copy(other.Root);
 			Size = other.Size;
-			Root = Begin = End = nullptr;
-
-			std ::pair<Node *, Node *> tmp = copy(Root, other.Root);
-
-			Begin = tmp.first;
-			End = tmp.second;
 		}
 
 		RBTree &operator=(const RBTree &other)
@@ -121,20 +1219,17 @@ namespace sjtu
 				return *this;
 
 			cmp = other.cmp;
+			Bal = other.Bal;
+			destroy();
+			copy(other.Root);
 			Size = other.Size;
-			delete Root;
-			Root = Begin = End = nullptr;
-
-			std ::pair<Node *, Node *> tmp = copy(Root, other.Root);
-
-			Begin = tmp.first;
-			End = tmp.second;
 
 			return *this;
 		}
 
 		void left_rotate(Node *const &x)
 		{
+			St.rotate();
 			Node *RT = x->RT;
 
 			x->RT = RT->LT;
@@ -158,6 +1253,7 @@ namespace sjtu
 
 		void right_rotate(Node *const &x)
 		{
+			St.rotate();
 			Node *LT = x->LT;
 
 			x->LT = LT->RT;
@@ -178,40 +1274,140 @@ namespace sjtu
 			LT->RT = x;
 		}
 
-		Node *find(const KeyType &Key, int ty = 0)
+		/**
+		 * K is KeyType, or anything Compare can compare with it when Compare is transparent.
+		 */
+		template <class K>
+		Node *find(const K &Key, int ty = 0)
+		{
+			St.find();
+			return found(descend(Root, Key, ty), ty);
+		}
+
+		/**
+		 * tell the balancing policy about a lookup which found x (splay_balance moves it up).
+		 */
+		Node *found(Node *x, int ty = 0)
+		{
+			if (x && !ty)
+				Bal.accessed(*this, x);
+			return x;
+		}
+
+		/**
+		 * find() starting from Finger instead of Root.
+		 * a key next to Finger is settled by the nxt / pre thread; otherwise climb while the
+		 * subtree may not hold Key and descend from there, O(log d) for a key d places away
+		 * as long as the climb stays on one side of the root.
+		 */
+		template <class K>
+		Node *find_from(Node *Finger, const K &Key, int ty = 0)
+		{
+			if (!Finger)
+				return find(Key, ty);
+			St.find();
+			Node *x = Finger;
+			if (less(x->Key(), Key))
+			{
+				Node *Next = x->nxt;
+				if (!Next || less(Key, Next->Key()))
+					return ty ? (x->RT ? Next : x) : nullptr;
+				while (x->Fa && (x == x->Fa->RT || !less(Key, x->Fa->Key())))
+					x = x->Fa;
+			}
+			else if (less(Key, x->Key()))
+			{
+				Node *Prev = x->pre;
+				if (!Prev || less(Prev->Key(), Key))
+					return ty ? (x->LT ? Prev : x) : nullptr;
+				while (x->Fa && (x == x->Fa->LT || !less(x->Fa->Key(), Key)))
+					x = x->Fa;
+			}
+			else
+				return found(x, ty);
+			return found(descend(x, Key, ty), ty);
+		}
+
+		/**
+		 * the node of Key in the subtree of x, or with ty the node under which it would go.
+		 */
+		template <class K>
+		Node *descend(Node *x, const K &Key, int ty)
 		{
-			Node *x = Root, *Fa = nullptr;
+			Node *Fa = nullptr;
 			while (x)
 			{
 				Fa = x;
-				if (!cmp(x->Key(), Key) && !cmp(Key, x->Key()))
+				if (less(x->Key(), Key))
+					x = x->RT;
+				else if (less(Key, x->Key()))
+					x = x->LT;
+				else
 					return x;
-				x = cmp(x->Key(), Key) ? x->RT : x->LT;
 			}
 
 			return ty ? Fa : nullptr;
 		}
 
-		std ::pair<Node *, bool> insert(const KeyType &Key, const T &Val)
+		/**
+		 * the first node whose key is not less than Key.
+		 */
+		template <class K>
+		Node *lower_bound(const K &Key)
+		{
+			St.find();
+			Node *x = Root, *ans = nullptr;
+			while (x)
+				if (less(x->Key(), Key))
+					x = x->RT;
+				else
+					ans = x, x = x->LT;
+			return found(ans);
+		}
+
+		/**
+		 * the first node whose key is greater than Key.
+		 */
+		template <class K>
+		Node *upper_bound(const K &Key)
+		{
+			St.find();
+			Node *x = Root, *ans = nullptr;
+			while (x)
+				if (less(Key, x->Key()))
+					ans = x, x = x->LT;
+				else
+					x = x->RT;
+			return found(ans);
+		}
+
+		/**
+		 * the search starts from Finger if there is one, see find_from().
+		 */
+		std ::pair<Node *, bool> insert(const KeyType &Key, const T &Val, Node *Finger = nullptr)
 		{
-			Node *Fa = find(Key, 1);
+			Node *Fa = find_from(Finger, Key, 1);
 
-			if (Fa && !cmp(Fa->Key(), Key) && !cmp(Key, Fa->Key()))
+			if (Fa && !less(Fa->Key(), Key) && !less(Key, Fa->Key()))
+			{
+				Bal.accessed(*this, Fa);
 				return std ::make_pair(Fa, 0);
+			}
 
 			Size++;
-			Node *x = new Node(Key, Val);
+			St.insert();
+			Node *x = make(Key, Val);
 			Node *ans = x;
 
-			if (!Begin || cmp(Key, Begin->Key()))
+			if (!Begin || less(Key, Begin->Key()))
 				Begin = x;
-			if (!End || cmp(End->Key(), Key))
+			if (!End || less(End->Key(), Key))
 				End = x;
 
 			x->Fa = Fa;
 
 			if (Fa)
-				if (cmp(Fa->Key(), Key))
+				if (less(Fa->Key(), Key))
 				{
 					Fa->RT = x;
 					x->nxt = Fa->nxt;
@@ -230,57 +1426,39 @@ namespace sjtu
 			else
 				Root = x;
 
-			while (Fa && Fa->Col == Red)
-			{
-				Node *Gfa = Fa->Fa;
-				Node *Unc = (Fa == Gfa->LT) ? Gfa->RT : Gfa->LT;
-
-				if (Unc && Unc->Col == Red)
-				{
-					Fa->Col = Unc->Col = Black;
-					Gfa->Col = Red;
-					x = Gfa;
-					Fa = x->Fa;
-				}
-				else
-				{
-					if (Fa == Gfa->LT)
-					{
-						if (x == Fa->RT)
-							left_rotate(Fa), std ::swap(x, Fa);
-
-						Fa->Col = Black;
-						Gfa->Col = Red;
-						right_rotate(Gfa);
-					}
-					else
-					{
-						if (x == Fa->LT)
-							right_rotate(Fa), std ::swap(x, Fa);
-
-						Fa->Col = Black;
-						Gfa->Col = Red;
-						left_rotate(Gfa);
-					}
-				}
-			}
-
-			if (!Fa && x->Col == Red)
-				x->Col = Black;
-
+			Bal.inserted(*this, x);
 			return std ::make_pair(ans, 1);
 		}
 
-		void erase(Node *&x)
+		void erase(Node *x)
 		{
+			if (x == Moving)
+				Moving = x->nxt;
 			if (x == Begin)
 				Begin = Begin->nxt;
 			if (x == End)
 				End = End->pre;
-
-			Node *Fa = x->Fa, *p = nullptr;
-			bool DelCol = x->Col;
 			Size--;
+			St.erase();
+
+			Bal.erase(*this, x);
+
+			(x->pre) && (x->pre->nxt = x->nxt);
+			(x->nxt) && (x->nxt->pre = x->pre);
+			x->pre = x->nxt = nullptr;
+			x->LT = x->RT = nullptr;
+			drop(x);
+		}
+
+		/**
+		 * take x out of the shape of the tree, for the balancing policies.
+		 * if x has two children its successor y takes its place and its balancing data.
+		 * Fa and p tell where a node went missing: p (maybe nullptr) now hangs under Fa
+		 * where x, or y, used to be.
+		 */
+		void unlink(Node *x, Node *&Fa, Node *&p)
+		{
+			Fa = x->Fa, p = nullptr;
 
 			if (!x->LT)
 			{
@@ -320,8 +1498,6 @@ namespace sjtu
 				while (y->LT)
 					y = y->LT;
 
-				DelCol = y->Col;
-
 				Node *RT = y->RT;
 				p = RT;
 				if (y->Fa != x)
@@ -348,108 +1524,275 @@ namespace sjtu
 				y->Fa = x->Fa;
 				y->LT = x->LT;
 				x->LT->Fa = y;
-				y->Col = x->Col;
+				static_cast<typename Balance::node &>(*y) = *x;
 			}
+		}
 
-			(x->pre) && (x->pre->nxt = x->nxt);
-			(x->nxt) && (x->nxt->pre = x->pre);
-			x->pre = x->nxt = 0;
-			x->LT = x->RT = nullptr;
-			delete x;
+		/**
+		 * cut the in-order sequence before every node less than Depth levels deep,
+		 * calling out(first, last) for each nonempty range [first, last) in order.
+		 * the pieces between two cuts are subtrees of the same depth, so they are of comparable size.
+		 */
+		template <class Out>
+		void split(int Depth, Out &out)
+		{
+			Node *Start = Begin;
+			split(Root, Depth, Start, out);
+			if (Start)
+				out(Start, static_cast<Node *>(nullptr));
+		}
 
-			if (DelCol == Black)
+		template <class Out>
+		void split(Node *x, int Depth, Node *&Start, Out &out)
+		{
+			if (!x || !Depth)
+				return;
+			split(x->LT, Depth - 1, Start, out);
+			if (Start != x)
+				out(Start, x), Start = x;
+			split(x->RT, Depth - 1, Start, out);
+		}
+
+		/**
+		 * y is the copy of x in the open arena: repoint every link to x at y and drop x.
+		 */
+		void relocate(Node *x, Node *y)
+		{
+			relink(x, y);
+			drop(x);
+		}
+
+		/**
+		 * y is a copy of x, links included: repoint every link to x at y.
+		 */
+		void relink(Node *x, Node *y)
+		{
+			if (!y->Fa)
+				Root = y;
+			else if (y->Fa->LT == x)
+				y->Fa->LT = y;
+			else
+				y->Fa->RT = y;
+			if (y->LT)
+				y->LT->Fa = y;
+			if (y->RT)
+				y->RT->Fa = y;
+			(y->pre ? y->pre->nxt : Begin) = y;
+			(y->nxt ? y->nxt->pre : End) = y;
+		}
+
+		/**
+		 * move up to Budget nodes along the thread into an arena sized for the whole tree.
+		 * a pass opens the arena and ends at the end of the thread, or early once the arena is
+		 * full of nodes inserted since it began; return whether the pass is over.
+		 * nodes inserted behind Moving meanwhile stay where they are until the next pass.
+		 */
+		bool compact(size_t Budget)
+		{
+			if (Alloc.Filling && !Moving)
+				Alloc.close_arena();
+			if (!Alloc.Filling)
+			{
+				if (!Size)
+					return true;
+				Alloc.template open_arena<Node>(Size);
+				Moving = Begin;
+			}
+			for (; Moving && Budget; Budget--)
 			{
-				x = p;
-				while (x != Root && (!x || x->Col == Black))
+				Node *x = Moving, *y = Alloc.template from_arena<Node>(std ::move(*x));
+				if (!y)
 				{
-					if (x == Fa->LT)
-					{
-						Node *Bro = Fa->RT;
-						if (Bro->Col == Red)
-						{
-							Bro->Col = Black;
-							Fa->Col = Red;
-							left_rotate(Fa);
-							Bro = Fa->RT;
-						}
+					Moving = nullptr;
+					break;
+				}
+				Moving = y->nxt;
+				relocate(x, y);
+			}
+			if (Moving)
+				return false;
+			Alloc.close_arena();
+			return true;
+		}
 
-						if ((!Bro->LT || Bro->LT->Col == Black) && (!Bro->RT || Bro->RT->Col == Black))
-						{
-							Bro->Col = Red;
-							x = Fa;
-							Fa = x->Fa;
-						}
-						else
-						{
-							if (!Bro->RT || Bro->RT->Col == Black)
-							{
-								Node *Nie = Bro->LT;
-								Nie->Col = Black;
-								Bro->Col = Red;
-								right_rotate(Bro);
-								Bro = Nie;
-							}
+		/**
+		 * move the nodes whose key is not less than Key into R, an empty tree, for treap_balance.
+		 * the shape is cut along one path; the sizes are counted by walking the thread out
+		 * from the cut on both sides until one ends, so the smaller side is counted.
+		 * a compaction pass going on is given up, and the nodes moved out of the arenas of
+		 * this tree (only a compacted tree has any) are copied onto the heap, one by one.
+		 */
+		template <class K>
+		void split_at(const K &Key, RBTree &R)
+		{
+			Moving = nullptr;
+			Alloc.close_arena();
+			Node *r;
+			Root = Bal.split(*this, static_cast<Node *>(Root), Key, r);
+			Node *First = r ? leftmost(r) : nullptr, *Last = First ? static_cast<Node *>(First->pre) : static_cast<Node *>(End);
+			int Left = 0;
+			for (Node *a = Last, *b = First;; a = a->pre, b = b->nxt, Left++)
+				if (!a)
+					break;
+				else if (!b)
+				{
+					Left = Size - Left;
+					break;
+				}
+			R.Root = r;
+			R.Begin = First;
+			R.End = First ? static_cast<Node *>(End) : nullptr;
+			R.Size = Size - Left;
+			R.Bal = Bal;
+			R.Serials = Serials; // a node keeps its serial, a later one must not meet it again
+			if (Last)
+				Last->nxt = nullptr;
+			else
+				Begin = nullptr;
+			if (First)
+				First->pre = nullptr;
+			End = Last;
+			Size = Left;
+			for (Node *x = R.Begin; x && Alloc.Arenas; )
+			{
+				Node *Next = x->nxt;
+				if (Alloc.owner(x))
+				{
+					Node *y = R.Alloc.template create<Node>(std ::move(*x));
+					R.relink(x, y);
+					drop(x);
+				}
+				x = Next;
+			}
+		}
 
-							Bro->Col = Fa->Col;
-							Fa->Col = Black;
-							Bro->RT->Col = Black;
-							left_rotate(Fa);
-							x = Root;
-						}
-					}
-					else
-					{
-						Node *Bro = Fa->LT;
-						if (Bro->Col == Red)
-						{
-							Bro->Col = Black;
-							Fa->Col = Red;
-							right_rotate(Fa);
-							Bro = Fa->LT;
-						}
-						if ((!Bro->LT || Bro->LT->Col == Black) && (!Bro->RT || Bro->RT->Col == Black))
-						{
-							Bro->Col = Red;
-							x = Fa;
-							Fa = x->Fa;
-						}
-						else
-						{
-							if (!Bro->LT || Bro->LT->Col == Black)
-							{
-								Node *Nie = Bro->RT;
-								Nie->Col = Black;
-								Bro->Col = Red;
-								left_rotate(Bro);
-								Bro = Nie;
-							}
+		/**
+		 * move every node of L, all of whose keys are greater than the ones here, to the end
+		 * of this tree, for treap_balance: O(log n) expected. L keeps nothing, its arenas
+		 * and the nodes of its graveyard included.
+		 */
+		void join(RBTree &L)
+		{
+			Root = Bal.join(static_cast<Node *>(Root), static_cast<Node *>(L.Root));
+			if (L.Begin)
+			{
+				if (End)
+					End->nxt = L.Begin, L.Begin->pre = End;
+				else
+					Begin = L.Begin;
+				End = L.End;
+			}
+			Size += L.Size;
+			Serials = Serials > L.Serials ? Serials : L.Serials;
+			L.Moving = nullptr;
+			Alloc.adopt(L.Alloc);
+			if (Node *x = L.Graveyard)
+			{
+				while (x->nxt)
+					x = x->nxt;
+				x->nxt = Graveyard;
+				Graveyard = L.Graveyard;
+			}
+			L.Root = L.Begin = L.End = nullptr;
+			L.Graveyard = nullptr;
+			L.Size = 0;
+		}
 
-							Bro->Col = Fa->Col;
-							Fa->Col = Black;
-							Bro->LT->Col = Black;
-							right_rotate(Fa);
-							x = Root;
-						}
-					}
-				}
+		/**
+		 * the height of the subtree of x, walked by Fa links instead of recursion.
+		 */
+		int height(const Node *x) const
+		{
+			if (!x)
+				return 0;
+			const Node *Top = x, *From = nullptr;
+			int d = 1, ans = 1;
+			while (x)
+			{
+				const Node *l = x->LT, *r = x->RT, *Next;
+				if (From == x->Fa || (From == nullptr && x == Top))
+					Next = l ? l : r ? r : x->Fa;
+				else if (From == l)
+					Next = r ? r : x->Fa;
+				else
+					Next = x->Fa;
+				if (x == Top && Next == x->Fa)
+					break;
+				d += Next == x->Fa ? -1 : 1;
+				ans = d > ans ? d : ans;
+				From = x, x = Next;
+			}
+			return ans;
+		}
 
-				if (x)
-					x->Col = Black;
+		/**
+		 * check every invariant of the tree:
+		 * order, parent links, Size, that the nxt/pre thread and Begin/End follow
+		 * the in-order traversal, and the rules of the balancing policy.
+		 */
+		bool validate()
+		{
+			if (Root && Root->Fa)
+				return false;
+
+			Node *x = Root, *Last = nullptr;
+			while (x && x->LT)
+				x = x->LT;
+			if (x != Begin)
+				return false;
+
+			int Cnt = 0;
+			while (x)
+			{
+				if (x->pre != Last || (Last && (Last->nxt != x || !cmp(Last->Key(), x->Key()))))
+					return false;
+				if ((x->LT && x->LT->Fa != x) || (x->RT && x->RT->Fa != x))
+					return false;
+				Cnt++;
+				Last = x;
+				if (x->RT)
+				{
+					x = x->RT;
+					while (x->LT)
+						x = x->LT;
+				}
+				else
+				{
+					while (x->Fa && x->Fa->RT == x)
+						x = x->Fa;
+					x = x->Fa;
+				}
 			}
+
+			return Last == End && (!Last || !Last->nxt) && Cnt == Size && Bal.validate(*this);
 		}
 	};
 
 	template <
 		class Key,
 		class T,
-		class Compare>
-	class map
+		class Compare,
+		class Stats,
+		class Checks,
+		class Balance,
+		class Small>
+	class map : small_elements<Key, T, Compare, Checks, Small::Capacity>
 	{
-		typedef RBTree<Key, T, Compare> RBT;
+		typedef RBTree<Key, T, Compare, heap_storage, Stats, Checks, Balance> RBT;
 		typedef typename RBT ::Node Node;
+		typedef small_elements<Key, T, Compare, Checks, Small::Capacity> Elems;
 
 	private:
-		RBT *Tr;
+		RBT *Tr; // nullptr while the elements are inline, see small_buffer
+
+		template <class It, class Out>
+		struct split_to
+		{
+			RBT *Tr;
+			Out &out;
+
+			void operator()(Node *first, Node *last) { out(It(Tr, first), It(Tr, last)); }
+		};
 
 	public:
 		/**
@@ -459,6 +1802,9 @@ namespace sjtu
 	 */
 
 		typedef pair<const Key, T> value_type;
+		typedef Key key_type;
+		typedef T mapped_type;
+		typedef Compare key_compare;
 
 		/**
 	 * see BidirectionalIterator at CppReference for help.
@@ -469,9 +1815,10 @@ namespace sjtu
 	 */
 
 		class const_iterator;
-		class iterator
+		class iterator : Checks::serial, Elems::position
 		{
 			friend class map;
+			friend class const_iterator;
 			/**
 		 * TODO add data members
 		 *   just add whatever you want.
@@ -481,12 +1828,45 @@ namespace sjtu
 			RBT *Belong;
 			Node *Ptr;
 
+			/**
+			 * whether it points to an inline element (or the end of inline elements).
+			 */
+			bool is_small() const { return Small::Capacity && !Belong; }
+
+			bool ended() const { return is_small() ? !this->elem() : !Ptr; }
+
+			/**
+			 * under checked_iterators throw if the element was erased since the iterator got to it.
+			 */
+			void check() const
+			{
+				if (Checks::Generations && (is_small() ? this->elem() && this->of()->serial() != this->serial()
+													   : Ptr && Ptr->serial() != this->serial()))
+					throw invalid_iterator();
+			}
+
+			void go(Node *x)
+			{
+				Ptr = x;
+				this->set_serial(x ? x->serial() : 0);
+			}
+
 		public:
 			iterator() : Belong(nullptr), Ptr(nullptr) {}
 
-			iterator(RBT *const &_Belong, Node *const &node) : Belong(_Belong), Ptr(node) {}
+			iterator(RBT *const &_Belong, Node *const &node) : Belong(_Belong), Ptr(node)
+			{
+				this->set_serial(node ? node->serial() : 0);
+			}
+
+			iterator(Elems *of, value_type *x) : Elems::position(of, x), Belong(nullptr), Ptr(nullptr)
+			{
+				this->set_serial(of->serial());
+			}
+
+			iterator(const iterator &other) : Checks::serial(other), Elems::position(other), Belong(other.Belong), Ptr(other.Ptr) {}
 
-			iterator(const iterator &other) : Belong(other.Belong), Ptr(other.Ptr) {}
+			iterator &operator=(const iterator &) = default;
 
 			/**
 		 * TODO iter++
@@ -494,11 +1874,8 @@ namespace sjtu
 
 			iterator operator++(int)
 			{
-				if (!Ptr)
-					throw invalid_iterator();
 				iterator tmp = *this;
-				if (Ptr)
-					Ptr = Ptr->nxt;
+				++*this;
 				return tmp;
 			}
 
@@ -508,10 +1885,13 @@ namespace sjtu
 
 			iterator &operator++()
 			{
-				if (!Ptr)
+				if (Checks::Bounds && ended())
 					throw invalid_iterator();
-				if (Ptr)
-					Ptr = Ptr->nxt;
+				check();
+				if (is_small())
+					this->set_elem(this->of()->next(this->elem()));
+				else
+					go(Ptr->nxt);
 				return *this;
 			}
 
@@ -522,14 +1902,7 @@ namespace sjtu
 			iterator operator--(int)
 			{
 				iterator tmp = *this;
-
-				if (Ptr)
-					Ptr = Ptr->pre;
-				else
-					Ptr = Belong->End;
-
-				if (!Ptr)
-					throw invalid_iterator();
+				--*this;
 				return tmp;
 			}
 
@@ -539,12 +1912,12 @@ namespace sjtu
 
 			iterator &operator--()
 			{
-				if (Ptr)
-					Ptr = Ptr->pre;
+				check();
+				if (is_small())
+					this->set_elem(this->elem() ? this->of()->prev(this->elem()) : this->of()->last());
 				else
-					Ptr = Belong->End;
-
-				if (!Ptr)
+					go(Ptr ? static_cast<Node *>(Ptr->pre) : static_cast<Node *>(Belong->End));
+				if (Checks::Bounds && ended())
 					throw invalid_iterator();
 				return *this;
 			}
@@ -553,28 +1926,36 @@ namespace sjtu
 		 * an operator to check whether two iterators are same (pointing to the same memory).
 		 */
 
-			value_type &operator*() const { return Ptr->ValueField; }
+			value_type &operator*() const
+			{
+				check();
+				return is_small() ? *this->elem() : Ptr->ValueField;
+			}
 
-			bool operator==(const iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+			bool operator==(const iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong && this->elem() == rhs.elem() && this->of() == rhs.of(); }
 
-			bool operator==(const const_iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+			bool operator==(const const_iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong && this->elem() == rhs.elem() && this->of() == rhs.of(); }
 
 			/**
 		 * some other operator for iterator.
 		 */
 
-			bool operator!=(const iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+			bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
 
-			bool operator!=(const const_iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+			bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
 
 			/**
 		 * for the support of it->first. 
 		 * See <http://kelvinh.github.io/blog/2013/11/20/overloading-of-member-access-operator-dash-greater-than-symbol-in-cpp/> for help.
 		 */
 
-			value_type *operator->() const noexcept { return &(Ptr->ValueField); }
+			value_type *operator->() const noexcept(!Checks::Generations)
+			{
+				check();
+				return is_small() ? this->elem() : &(Ptr->ValueField);
+			}
 		};
-		class const_iterator
+		class const_iterator : Checks::serial, Elems::position
 		{
 			friend class map;
 
@@ -587,14 +1968,50 @@ namespace sjtu
 			RBT *Belong;
 			Node *Ptr;
 
+			/**
+			 * whether it points to an inline element (or the end of inline elements).
+			 */
+			bool is_small() const { return Small::Capacity && !Belong; }
+
+			bool ended() const { return is_small() ? !this->elem() : !Ptr; }
+
+			/**
+			 * under checked_iterators throw if the element was erased since the iterator got to it.
+			 */
+			void check() const
+			{
+				if (Checks::Generations && (is_small() ? this->elem() && this->of()->serial() != this->serial()
+													   : Ptr && Ptr->serial() != this->serial()))
+					throw invalid_iterator();
+			}
+
+			void go(Node *x)
+			{
+				Ptr = x;
+				this->set_serial(x ? x->serial() : 0);
+			}
+
 		public:
 			const_iterator() : Belong(nullptr), Ptr(nullptr) {}
 
-			const_iterator(RBT *const &_Belong, Node *const &node) : Belong(_Belong), Ptr(node) {}
+			const_iterator(RBT *const &_Belong, Node *const &node) : Belong(_Belong), Ptr(node)
+			{
+				this->set_serial(node ? node->serial() : 0);
+			}
+
+			const_iterator(Elems *of, value_type *x) : Elems::position(of, x), Belong(nullptr), Ptr(nullptr)
+			{
+				this->set_serial(of->serial());
+			}
+
+			const_iterator(const iterator &other) : Elems::position(other), Belong(other.Belong), Ptr(other.Ptr)
+			{
+				this->set_serial(other.serial());
+			}
 
-			const_iterator(const iterator &other) : Belong(other.Belong), Ptr(other.Ptr) {}
+			const_iterator(const const_iterator &other) : Checks::serial(other), Elems::position(other), Belong(other.Belong), Ptr(other.Ptr) {}
 
-			const_iterator(const const_iterator &other) : Belong(other.Belong), Ptr(other.Ptr) {}
+			const_iterator &operator=(const const_iterator &) = default;
 
 			/**
 		 * TODO iter++
@@ -602,11 +2019,8 @@ namespace sjtu
 
 			const_iterator operator++(int)
 			{
-				if (!Ptr)
-					throw invalid_iterator();
 				const_iterator tmp = *this;
-				if (Ptr)
-					Ptr = Ptr->nxt;
+				++*this;
 				return tmp;
 			}
 
@@ -616,10 +2030,13 @@ namespace sjtu
 
 			const_iterator &operator++()
 			{
-				if (!Ptr)
+				if (Checks::Bounds && ended())
 					throw invalid_iterator();
-				if (Ptr)
-					Ptr = Ptr->nxt;
+				check();
+				if (is_small())
+					this->set_elem(this->of()->next(this->elem()));
+				else
+					go(Ptr->nxt);
 				return *this;
 			}
 
@@ -630,14 +2047,7 @@ namespace sjtu
 			const_iterator operator--(int)
 			{
 				const_iterator tmp = *this;
-
-				if (Ptr)
-					Ptr = Ptr->pre;
-				else
-					Ptr = Belong->End;
-
-				if (!Ptr)
-					throw invalid_iterator();
+				--*this;
 				return tmp;
 			}
 
@@ -647,12 +2057,12 @@ namespace sjtu
 
 			const_iterator &operator--()
 			{
-				if (Ptr)
-					Ptr = Ptr->pre;
+				check();
+				if (is_small())
+					this->set_elem(this->elem() ? this->of()->prev(this->elem()) : this->of()->last());
 				else
-					Ptr = Belong->End;
-
-				if (!Ptr)
+					go(Ptr ? static_cast<Node *>(Ptr->pre) : static_cast<Node *>(Belong->End));
+				if (Checks::Bounds && ended())
 					throw invalid_iterator();
 				return *this;
 			}
@@ -661,35 +2071,92 @@ namespace sjtu
 		 * an operator to check whether two iterators are same (pointing to the same memory).
 		 */
 
-			value_type &operator*() const { return Ptr->ValueField; }
+			value_type &operator*() const
+			{
+				check();
+				return is_small() ? *this->elem() : Ptr->ValueField;
+			}
 
-			bool operator==(const iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+			bool operator==(const iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong && this->elem() == rhs.elem() && this->of() == rhs.of(); }
 
-			bool operator==(const const_iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+			bool operator==(const const_iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong && this->elem() == rhs.elem() && this->of() == rhs.of(); }
 
 			/**
 		 * some other operator for iterator.
 		 */
 
-			bool operator!=(const iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+			bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
 
-			bool operator!=(const const_iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+			bool operator!=(const const_iterator &rhs) const { return !(*this == rhs); }
 
 			/**
 		 * for the support of it->first. 
 		 * See <http://kelvinh.github.io/blog/2013/11/20/overloading-of-member-access-operator-dash-greater-than-symbol-in-cpp/> for help.
 		 */
 
-			value_type *operator->() const noexcept { return &(Ptr->ValueField); }
+			value_type *operator->() const noexcept(!Checks::Generations)
+			{
+				check();
+				return is_small() ? this->elem() : &(Ptr->ValueField);
+			}
 		};
 
+	private:
+		/**
+		 * where a search from hint starts, nullptr (the root) for an iterator of another map.
+		 */
+		Node *finger(const const_iterator &hint) const
+		{
+			if (hint.Belong != Tr)
+				return nullptr;
+			hint.check();
+			return hint.Ptr ? hint.Ptr : static_cast<Node *>(Tr->End);
+		}
+
+		bool is_small() const { return Small::Capacity && !Tr; }
+
+		Elems *elems() const { return const_cast<map *>(this); }
+
+		/**
+		 * the element of key, inline or in the tree, nullptr if there is none.
+		 */
+		template <class K>
+		value_type *lookup(const K &key) const
+		{
+			if (is_small())
+				return Elems::find(key);
+			Node *Ptr = Tr->find(key);
+			return Ptr ? &Ptr->ValueField : nullptr;
+		}
+
+		/**
+		 * insert the elements of e into t, after the ones in t.
+		 */
+		static void append(RBT *t, const Elems &e)
+		{
+			for (value_type *x = e.first(); x; x = e.next(x))
+				t->insert(x->first, x->second, t->End);
+		}
+
+		/**
+		 * move the inline elements into a new tree, for one that does not fit.
+		 */
+		void grow()
+		{
+			RBT *t = new RBT();
+			append(t, *this);
+			Elems::clear();
+			Tr = t;
+		}
+
+	public:
 		/**
 	 * TODO two constructors
 	 */
 
-		map() : Tr(new RBT()) {}
+		map() : Tr(Small::Capacity ? nullptr : new RBT()) {}
 
-		map(const map &other) : Tr(new RBT(*(other.Tr))) {}
+		map(const map &other) : Elems(other), Tr(other.Tr ? new RBT(*(other.Tr)) : nullptr) {}
 
 		/**
 	 * TODO assignment operator
@@ -699,7 +2166,20 @@ namespace sjtu
 		{
 			if (this == &other)
 				return *this;
-			*Tr = *other.Tr;
+			if (!Tr && other.Tr)
+			{
+				Elems::clear();
+				Tr = new RBT(*other.Tr);
+			}
+			else if (!Tr)
+				Elems::assign(other);
+			else if (other.Tr)
+				*Tr = *other.Tr;
+			else
+			{
+				Tr->clear();
+				append(Tr, other);
+			}
 			return *this;
 		}
 
@@ -721,18 +2201,42 @@ namespace sjtu
 
 		T &at(const Key &key)
 		{
-			Node *Ptr = Tr->find(key);
-			if (!Ptr)
+			value_type *x = lookup(key);
+			if (!x)
 				throw index_out_of_bound();
-			return Ptr->Val();
+			return x->second;
 		}
 
 		const T &at(const Key &key) const
 		{
-			Node *Ptr = Tr->find(key);
-			if (!Ptr)
+			value_type *x = lookup(key);
+			if (!x)
+				throw index_out_of_bound();
+			return x->second;
+		}
+
+		/**
+		 * at() with anything Compare can compare with Key, no Key is constructed.
+		 * only available if Compare declares is_transparent (like std::less<>),
+		 * same for the other heterogeneous lookups below.
+		 */
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		T &at(const K &key)
+		{
+			value_type *x = lookup(key);
+			if (!x)
+				throw index_out_of_bound();
+			return x->second;
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		const T &at(const K &key) const
+		{
+			value_type *x = lookup(key);
+			if (!x)
 				throw index_out_of_bound();
-			return Ptr->Val();
+			return x->second;
 		}
 
 		/**
@@ -744,6 +2248,8 @@ namespace sjtu
 
 		T &operator[](const Key &key)
 		{
+			if (is_small())
+				return insert(value_type(key, T())).first->second;
 			return Tr->insert(key, T()).first->Val();
 		}
 
@@ -753,24 +2259,85 @@ namespace sjtu
 
 		const T &operator[](const Key &key) const
 		{
-			Node *Ptr = Tr->find(key);
-			if (!Ptr)
+			value_type *x = lookup(key);
+			if (!x)
 				throw index_out_of_bound();
-			return Ptr->Val();
+			return x->second;
+		}
+
+		/**
+		 * the mapped value of key, or nullptr if there is no such key.
+		 * at() for lookups that often miss: nothing is thrown.
+		 */
+
+		T *find_value(const Key &key)
+		{
+			value_type *x = lookup(key);
+			return x ? &x->second : nullptr;
+		}
+
+		const T *find_value(const Key &key) const
+		{
+			value_type *x = lookup(key);
+			return x ? &x->second : nullptr;
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		T *find_value(const K &key)
+		{
+			value_type *x = lookup(key);
+			return x ? &x->second : nullptr;
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		const T *find_value(const K &key) const
+		{
+			value_type *x = lookup(key);
+			return x ? &x->second : nullptr;
+		}
+
+		/**
+		 * copy the mapped value of key to out and return true,
+		 * or return false and leave out alone if there is no such key.
+		 */
+
+		bool try_at(const Key &key, T &out) const
+		{
+			value_type *x = lookup(key);
+			if (!x)
+				return false;
+			out = x->second;
+			return true;
 		}
 
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		bool try_at(const K &key, T &out) const
+		{
+			value_type *x = lookup(key);
+			if (!x)
+				return false;
+			out = x->second;
+			return true;
+		}
+
+		/**
+		 * an immutable copy laid out for lookups, defined in frozen_map.hpp.
+		 */
+
+		frozen_map<Key, T, Compare> freeze() const;
+
 		/**
 	 * return a iterator to the beginning
 	 */
 
 		iterator begin()
 		{
-			return iterator(Tr, Tr->Begin);
+			return is_small() ? iterator(elems(), Elems::first()) : iterator(Tr, Tr->Begin);
 		}
 
 		const_iterator cbegin() const
 		{
-			return const_iterator(Tr, Tr->Begin);
+			return is_small() ? const_iterator(elems(), Elems::first()) : const_iterator(Tr, Tr->Begin);
 		}
 
 		/**
@@ -780,12 +2347,12 @@ namespace sjtu
 
 		iterator end()
 		{
-			return iterator(Tr, nullptr);
+			return is_small() ? iterator(elems(), nullptr) : iterator(Tr, nullptr);
 		}
 
 		const_iterator cend() const
 		{
-			return const_iterator(Tr, nullptr);
+			return is_small() ? const_iterator(elems(), nullptr) : const_iterator(Tr, nullptr);
 		}
 
 		/**
@@ -795,7 +2362,7 @@ namespace sjtu
 
 		bool empty() const
 		{
-			return !Tr->get_size();
+			return !size();
 		}
 
 		/**
@@ -804,7 +2371,7 @@ namespace sjtu
 
 		size_t size() const
 		{
-			return Tr->get_size();
+			return is_small() ? Elems::size() : Tr->get_size();
 		}
 
 		/**
@@ -813,8 +2380,10 @@ namespace sjtu
 
 		void clear()
 		{
-			delete Tr;
-			Tr = new RBT();
+			if (is_small())
+				Elems::clear();
+			else
+				Tr->clear();
 		}
 
 		/**
@@ -826,19 +2395,52 @@ namespace sjtu
 
 		pair<iterator, bool> insert(const value_type &value)
 		{
+			if (is_small())
+			{
+				std ::pair<value_type *, bool> ans = Elems::insert(value.first, value.second);
+				if (ans.first)
+					return pair<iterator, bool>(iterator(elems(), ans.first), ans.second);
+				grow();
+			}
 			std ::pair<Node *, bool> ans = Tr->insert(value.first, value.second);
 			return pair<iterator, bool>(iterator(Tr, ans.first), ans.second);
 		}
 
+		/**
+		 * insert() searching from hint instead of the root (a finger search):
+		 * O(1) right before or after hint, O(log d) for d elements away.
+		 * hint == end() starts from the last element, the place of increasing keys.
+		 * return the iterator to the element, the new one or the one that prevented the insertion.
+		 */
+
+		iterator insert(const_iterator hint, const value_type &value)
+		{
+			if (is_small())
+				return insert(value).first;
+			return iterator(Tr, Tr->insert(value.first, value.second, finger(hint)).first);
+		}
+
 		/**
 	 * erase the element at pos.
 	 *
 	 * throw if pos pointed to a bad element (pos == this->end() || pos points an element out of this)
+	 * unless Checks is unchecked_iterators; checked_iterators needs no lookup for it.
 	 */
 
 		void erase(iterator pos)
 		{
-			if (pos.Ptr && Tr->find(pos.Ptr->Key()) == pos.Ptr)
+			if (is_small())
+			{
+				if (!Checks::Bounds || (pos.of() == elems() && (Checks::Generations ? pos.elem() && pos.serial() == Elems::serial()
+																					 : Elems::owns(pos.elem()))))
+					Elems::erase(pos.elem());
+				else
+					throw invalid_iterator();
+			}
+			else if (!Checks::Bounds)
+				Tr->erase(pos.Ptr);
+			else if (Checks::Generations ? pos.Ptr && pos.Belong == Tr && pos.Ptr->serial() == pos.serial()
+										 : pos.Ptr && Tr->find(pos.Ptr->Key()) == pos.Ptr)
 				Tr->erase(pos.Ptr);
 			else
 				throw invalid_iterator();
@@ -854,7 +2456,13 @@ namespace sjtu
 
 		size_t count(const Key &key) const
 		{
-			return Tr->find(key) != nullptr;
+			return lookup(key) != nullptr;
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		size_t count(const K &key) const
+		{
+			return lookup(key) != nullptr;
 		}
 
 		/**
@@ -866,14 +2474,239 @@ namespace sjtu
 
 		iterator find(const Key &key)
 		{
-			Node *ans = Tr->find(key);
-			return iterator(Tr, ans ? ans : nullptr);
+			return is_small() ? iterator(elems(), Elems::find(key)) : iterator(Tr, Tr->find(key));
 		}
 
 		const_iterator find(const Key &key) const
 		{
-			Node *ans = Tr->find(key);
-			return const_iterator(Tr, ans ? ans : nullptr);
+			return is_small() ? const_iterator(elems(), Elems::find(key)) : const_iterator(Tr, Tr->find(key));
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		iterator find(const K &key)
+		{
+			return is_small() ? iterator(elems(), Elems::find(key)) : iterator(Tr, Tr->find(key));
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		const_iterator find(const K &key) const
+		{
+			return is_small() ? const_iterator(elems(), Elems::find(key)) : const_iterator(Tr, Tr->find(key));
+		}
+
+		/**
+		 * find() searching from hint, like insert(hint, value).
+		 */
+
+		iterator find(const_iterator hint, const Key &key)
+		{
+			return is_small() ? iterator(elems(), Elems::find(key)) : iterator(Tr, Tr->find_from(finger(hint), key));
+		}
+
+		const_iterator find(const_iterator hint, const Key &key) const
+		{
+			return is_small() ? const_iterator(elems(), Elems::find(key)) : const_iterator(Tr, Tr->find_from(finger(hint), key));
+		}
+
+		/**
+		 * the first element whose key is not less than key, end() if none.
+		 */
+
+		iterator lower_bound(const Key &key)
+		{
+			return is_small() ? iterator(elems(), Elems::lower_bound(key)) : iterator(Tr, Tr->lower_bound(key));
+		}
+
+		const_iterator lower_bound(const Key &key) const
+		{
+			return is_small() ? const_iterator(elems(), Elems::lower_bound(key)) : const_iterator(Tr, Tr->lower_bound(key));
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		iterator lower_bound(const K &key)
+		{
+			return is_small() ? iterator(elems(), Elems::lower_bound(key)) : iterator(Tr, Tr->lower_bound(key));
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		const_iterator lower_bound(const K &key) const
+		{
+			return is_small() ? const_iterator(elems(), Elems::lower_bound(key)) : const_iterator(Tr, Tr->lower_bound(key));
+		}
+
+		/**
+		 * the first element whose key is greater than key, end() if none.
+		 */
+
+		iterator upper_bound(const Key &key)
+		{
+			return is_small() ? iterator(elems(), Elems::upper_bound(key)) : iterator(Tr, Tr->upper_bound(key));
+		}
+
+		const_iterator upper_bound(const Key &key) const
+		{
+			return is_small() ? const_iterator(elems(), Elems::upper_bound(key)) : const_iterator(Tr, Tr->upper_bound(key));
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		iterator upper_bound(const K &key)
+		{
+			return is_small() ? iterator(elems(), Elems::upper_bound(key)) : iterator(Tr, Tr->upper_bound(key));
+		}
+
+		template <class K, class C = Compare, class = typename C::is_transparent>
+		const_iterator upper_bound(const K &key) const
+		{
+			return is_small() ? const_iterator(elems(), Elems::upper_bound(key)) : const_iterator(Tr, Tr->upper_bound(key));
+		}
+
+		/**
+		 * cut the elements into at most 2^depth contiguous ranges following the shape of the tree
+		 * and call out(first, last) for each range [first, last) in order.
+		 * the cut only depends on the tree, see parallel.hpp for its use;
+		 * inline elements are one range.
+		 */
+
+		template <class Out>
+		void split(int depth, Out out)
+		{
+			if (is_small())
+			{
+				if (!empty())
+					out(begin(), end());
+				return;
+			}
+			split_to<iterator, Out> to = {Tr, out};
+			Tr->split(depth, to);
+		}
+
+		template <class Out>
+		void split(int depth, Out out) const
+		{
+			if (is_small())
+			{
+				if (!empty())
+					out(cbegin(), cend());
+				return;
+			}
+			split_to<const_iterator, Out> to = {Tr, out};
+			Tr->split(depth, to);
+		}
+
+		/**
+		 * counters of the statistics policy, see tree_stats; nothing is counted inline.
+		 */
+
+		const Stats &stats() const
+		{
+			static const Stats None = Stats();
+			return Tr ? Tr->St : None;
+		}
+
+		void reset_stats()
+		{
+			if (Tr)
+				Tr->St.reset();
+		}
+
+		/**
+		 * move up to budget elements, in key order, into one block of memory, so that a map
+		 * whose nodes got scattered over the heap by long churn walks memory forward on a scan
+		 * and touches fewer cache lines on a search. return true once a whole pass is done:
+		 *
+		 *     while (!m.compact(4096))
+		 *         serve_requests(); // the map can be used and changed between the steps
+		 *
+		 * a pass moves the elements present when it began, O(budget) per call. the memory of a
+		 * pass is freed when a later pass has moved all its elements out, or when they are erased.
+		 * iterators to a moved element are invalidated as if it was erased (checked_iterators
+		 * notices), references to it too. inline elements are never moved.
+		 */
+
+		bool compact(size_t budget = size_t(-1))
+		{
+			return is_small() || Tr->compact(budget);
+		}
+
+		/**
+		 * move the elements whose key is not less than key to out, whose elements are erased
+		 * first; for treap_balance only, whose trees are cut along one path.
+		 * O(log n + min(k, n - k)) expected for k elements moved, the smaller side being
+		 * walked to count it, plus O(k) if compact() was used on this map.
+		 * iterators to the moved elements are invalidated, the other ones stay valid;
+		 * inline elements are moved into a tree first, which invalidates all of theirs.
+		 * throw runtime_error if out is this map.
+		 */
+		void split_at(const Key &key, map &out)
+		{
+			static_assert(std ::is_same<Balance, treap_balance>::value, "split_at() needs treap_balance");
+			if (&out == this)
+				throw runtime_error("split_at() into the map itself");
+			if (is_small())
+				grow();
+			if (out.is_small())
+			{
+				out.Elems::clear();
+				out.Tr = new RBT();
+			}
+			else
+				out.Tr->clear();
+			Tr->split_at(key, *out.Tr);
+		}
+
+		/**
+		 * move every element of other to this map, leaving other empty; for treap_balance only.
+		 * every key of other has to be greater than every key here: O(log n) expected.
+		 * iterators to the moved elements are invalidated, the other ones stay valid unless
+		 * they are inline, as in split_at().
+		 * throw runtime_error if a key of other is not greater than the keys here, or other
+		 * is this map; no element is moved then.
+		 */
+		void join(map &other)
+		{
+			static_assert(std ::is_same<Balance, treap_balance>::value, "join() needs treap_balance");
+			if (&other == this)
+				throw runtime_error("join() of the map with itself");
+			if (other.empty())
+				return;
+			// the order is checked where the keys are, before anything grows
+			if (!empty())
+			{
+				const Key &Last = is_small() ? Elems::last()->first : Tr->End->Key();
+				const Key &First = other.is_small() ? other.Elems::first()->first : other.Tr->Begin->Key();
+				if (!Compare()(Last, First))
+					throw runtime_error("join() of keys out of order");
+			}
+			if (is_small())
+				grow();
+			if (other.is_small())
+				other.grow();
+			Tr->join(*other.Tr);
+		}
+
+		/**
+		 * height of the tree, a red-black tree keeps it under 2 * log2(n + 1); 0 inline.
+		 */
+
+		int height() const
+		{
+			return Tr ? Tr->height(Tr->Root) : 0;
+		}
+
+		void dump_stats(std ::ostream &os) const
+		{
+			os << "size " << size() << ", height " << height() << " (bound " << 2 * std ::log2(size() + 1.0) << ")\n";
+			stats().dump(os);
+		}
+
+		/**
+		 * check the structure of the tree, for soak tests.
+		 * return false if any red-black or threading invariant is broken.
+		 */
+
+		bool validate() const
+		{
+			return is_small() ? Elems::validate() : Tr->validate();
 		}
 	};
 }
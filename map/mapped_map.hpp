@@ -0,0 +1,501 @@
+#ifndef SJTU_MAPPED_MAP_HPP
+#define SJTU_MAPPED_MAP_HPP
+
+// a sjtu::map whose nodes live in a memory-mapped file, POSIX only.
+
+#include <functional>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+namespace sjtu
+{
+	/**
+	 * a position-independent pointer.
+	 * it stores the distance from itself to the target (0 means nullptr),
+	 * so a structure linked by offset_ptr stays valid wherever it is mapped.
+	 */
+	template <class N>
+	class offset_ptr
+	{
+	private:
+		std ::ptrdiff_t Off;
+
+		N *get() const
+		{
+			return Off ? reinterpret_cast<N *>(const_cast<char *>(reinterpret_cast<const char *>(this)) + Off) : nullptr;
+		}
+
+		void set(const N *p)
+		{
+			Off = p ? reinterpret_cast<const char *>(p) - reinterpret_cast<const char *>(this) : 0;
+		}
+
+	public:
+		offset_ptr() : Off(0) {}
+
+		offset_ptr(std ::nullptr_t) : Off(0) {}
+
+		offset_ptr(N *p) { set(p); }
+
+		offset_ptr(const offset_ptr &other) { set(other.get()); }
+
+		offset_ptr &operator=(const offset_ptr &other)
+		{
+			set(other.get());
+			return *this;
+		}
+
+		offset_ptr &operator=(N *p)
+		{
+			set(p);
+			return *this;
+		}
+
+		operator N *() const { return get(); }
+
+		N *operator->() const { return get(); }
+	};
+
+	/**
+	 * storage of RBTree inside a mapping.
+	 * it must live in the mapping itself: nodes are carved from the bytes behind it
+	 * and freed nodes are chained by their offset from the start of the mapping.
+	 * the owner is responsible for keeping at least one node of room available.
+	 */
+	struct mapped_storage
+	{
+		std ::ptrdiff_t ToBase;
+		std ::size_t Used, FreeHead;
+
+		mapped_storage() : ToBase(0), Used(0), FreeHead(0) {}
+
+		template <class N>
+		struct rebind
+		{
+			typedef offset_ptr<N> link;
+		};
+
+		char *base() { return reinterpret_cast<char *>(this) + ToBase; }
+
+		template <class N, class... Args>
+		N *create(Args &&...args)
+		{
+			char *p;
+			if (FreeHead)
+			{
+				p = base() + FreeHead;
+				std ::memcpy(&FreeHead, p, sizeof(FreeHead));
+			}
+			else
+			{
+				p = base() + Used;
+				Used += sizeof(N);
+			}
+			return new (p) N(std ::forward<Args>(args)...);
+		}
+
+		template <class N>
+		void destroy(N *x)
+		{
+			x->~N();
+			std ::memcpy(static_cast<void *>(x), &FreeHead, sizeof(FreeHead));
+			FreeHead = reinterpret_cast<char *>(x) - base();
+		}
+	};
+
+	/**
+	 * a sjtu::map stored in a file.
+	 * open() only maps the file, pages are read lazily when the tree is walked,
+	 * and several processes opening the same file share the page cache.
+	 *
+	 * Key and T must be trivially copyable (no heap-owning members).
+	 * one writer at a time. a reader opened with read_only = true shares the pages of the writer
+	 * (MAP_SHARED), it is no snapshot: it sees every change as it happens, possibly half done,
+	 * and it maps only the size the file had at open(), so a node added beyond that is out of its
+	 * mapping. readers must not run while a writer changes the file; reopen them afterwards.
+	 * the address space of `reserve' bytes is taken at open() so the mapping never moves, which bounds the file size.
+	 */
+	template <
+		class Key,
+		class T,
+		class Compare = std::less<Key> >
+	class mapped_map
+	{
+		typedef RBTree<Key, T, Compare, mapped_storage> RBT;
+		typedef typename RBT ::Node Node;
+
+		static_assert(std ::is_trivially_copyable<Key>::value && std ::is_trivially_copyable<T>::value,
+					  "mapped_map only holds trivially copyable keys and values");
+
+		struct Header
+		{
+			char Magic[8];
+			std ::size_t KeySize, ValSize, NodeSize, TreeSize;
+		};
+
+		static const std ::size_t TreeOffset = (sizeof(Header) + 63) / 64 * 64;
+		static const std ::size_t DataOffset = (TreeOffset + sizeof(RBT) + 63) / 64 * 64;
+		static const std ::size_t InitialSize = (DataOffset + 64 * sizeof(Node) + 4095) / 4096 * 4096;
+
+	public:
+		static const std ::size_t default_reserve = std ::size_t(1) << (sizeof(void *) == 8 ? 36 : 30);
+
+	private:
+		int Fd;
+		char *Base;
+		std ::size_t Reserved, FileSize;
+		bool Writable;
+		RBT *Tr;
+
+		void fill_header(Header &h) const
+		{
+			std ::memset(&h, 0, sizeof(h));
+			std ::memcpy(h.Magic, "SJTUMAP", 8);
+			h.KeySize = sizeof(Key);
+			h.ValSize = sizeof(T);
+			h.NodeSize = sizeof(Node);
+			h.TreeSize = sizeof(RBT);
+		}
+
+		void fail()
+		{
+			close();
+			throw runtime_error();
+		}
+
+		void check_writable() const
+		{
+			if (!Tr || !Writable)
+				throw runtime_error();
+		}
+
+		/**
+		 * make sure the next insertion finds room for a node, growing the file if necessary.
+		 */
+		void reserve_node()
+		{
+			check_writable();
+			if (Tr->Alloc.FreeHead || Tr->Alloc.Used + sizeof(Node) <= FileSize)
+				return;
+
+			std ::size_t NewSize = FileSize * 2;
+			if (NewSize > Reserved)
+				NewSize = Reserved;
+			if (Tr->Alloc.Used + sizeof(Node) > NewSize || ftruncate(Fd, NewSize))
+				throw runtime_error();
+			FileSize = NewSize;
+		}
+
+	public:
+		typedef pair<const Key, T> value_type;
+
+		class const_iterator;
+		class iterator
+		{
+			friend class mapped_map;
+
+		private:
+			RBT *Belong;
+			Node *Ptr;
+
+		public:
+			iterator() : Belong(nullptr), Ptr(nullptr) {}
+
+			iterator(RBT *const &_Belong, Node *const &node) : Belong(_Belong), Ptr(node) {}
+
+			iterator operator++(int)
+			{
+				iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+
+			iterator &operator++()
+			{
+				if (!Ptr)
+					throw invalid_iterator();
+				Ptr = Ptr->nxt;
+				return *this;
+			}
+
+			iterator operator--(int)
+			{
+				iterator tmp = *this;
+				--*this;
+				return tmp;
+			}
+
+			iterator &operator--()
+			{
+				Node *p = Ptr ? static_cast<Node *>(Ptr->pre) : static_cast<Node *>(Belong->End);
+				if (!p)
+					throw invalid_iterator();
+				Ptr = p;
+				return *this;
+			}
+
+			value_type &operator*() const { return Ptr->ValueField; }
+
+			bool operator==(const iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+
+			bool operator==(const const_iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+
+			bool operator!=(const iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+
+			bool operator!=(const const_iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+
+			value_type *operator->() const noexcept { return &(Ptr->ValueField); }
+		};
+		class const_iterator
+		{
+			friend class mapped_map;
+
+		private:
+			RBT *Belong;
+			Node *Ptr;
+
+		public:
+			const_iterator() : Belong(nullptr), Ptr(nullptr) {}
+
+			const_iterator(RBT *const &_Belong, Node *const &node) : Belong(_Belong), Ptr(node) {}
+
+			const_iterator(const iterator &other) : Belong(other.Belong), Ptr(other.Ptr) {}
+
+			const_iterator operator++(int)
+			{
+				const_iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+
+			const_iterator &operator++()
+			{
+				if (!Ptr)
+					throw invalid_iterator();
+				Ptr = Ptr->nxt;
+				return *this;
+			}
+
+			const_iterator operator--(int)
+			{
+				const_iterator tmp = *this;
+				--*this;
+				return tmp;
+			}
+
+			const_iterator &operator--()
+			{
+				Node *p = Ptr ? static_cast<Node *>(Ptr->pre) : static_cast<Node *>(Belong->End);
+				if (!p)
+					throw invalid_iterator();
+				Ptr = p;
+				return *this;
+			}
+
+			const value_type &operator*() const { return Ptr->ValueField; }
+
+			bool operator==(const iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+
+			bool operator==(const const_iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+
+			bool operator!=(const iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+
+			bool operator!=(const const_iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+
+			const value_type *operator->() const noexcept { return &(Ptr->ValueField); }
+		};
+
+		mapped_map() : Fd(-1), Base(nullptr), Reserved(0), FileSize(0), Writable(false), Tr(nullptr) {}
+
+		explicit mapped_map(const char *path, bool read_only = false, std ::size_t reserve = default_reserve)
+			: mapped_map()
+		{
+			open(path, read_only, reserve);
+		}
+
+		mapped_map(const mapped_map &other) = delete;
+
+		mapped_map &operator=(const mapped_map &other) = delete;
+
+		~mapped_map() { close(); }
+
+		/**
+		 * map the file at path, creating an empty map there if it does not exist (unless read_only).
+		 * this is O(1): nothing but the header is touched.
+		 * throw runtime_error if the file cannot be mapped or holds a map of other types.
+		 */
+		void open(const char *path, bool read_only = false, std ::size_t reserve = default_reserve)
+		{
+			close();
+
+			Fd = ::open(path, read_only ? O_RDONLY : O_RDWR | O_CREAT, 0644);
+			if (Fd < 0)
+				throw runtime_error();
+
+			struct stat st;
+			if (fstat(Fd, &st))
+				fail();
+			FileSize = st.st_size;
+			Writable = !read_only;
+
+			bool Fresh = FileSize == 0;
+			if (Fresh)
+			{
+				if (read_only || ftruncate(Fd, InitialSize))
+					fail();
+				FileSize = InitialSize;
+			}
+			else if (FileSize < DataOffset)
+				fail();
+
+			Reserved = read_only || reserve < FileSize ? FileSize : reserve;
+			void *p = mmap(nullptr, Reserved, read_only ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+			if (p == MAP_FAILED)
+			{
+				Base = nullptr;
+				fail();
+			}
+			Base = static_cast<char *>(p);
+
+			Header h;
+			fill_header(h);
+			if (Fresh)
+			{
+				std ::memcpy(Base, &h, sizeof(h));
+				Tr = new (Base + TreeOffset) RBT();
+				Tr->Alloc.ToBase = Base - reinterpret_cast<char *>(&Tr->Alloc);
+				Tr->Alloc.Used = DataOffset;
+			}
+			else
+			{
+				if (std ::memcmp(Base, &h, sizeof(h)))
+					fail();
+				Tr = reinterpret_cast<RBT *>(Base + TreeOffset);
+				// raw pointers of RBTree would not survive a remap; they stay null here, as the tree
+				// has no graveyard without checked_iterators and nothing calls compact() on it
+				if (Tr->Graveyard || Tr->Moving)
+					fail();
+			}
+		}
+
+		/**
+		 * unmap the file. changes are already visible in the page cache,
+		 * call sync() first if they have to reach the disk now.
+		 */
+		void close()
+		{
+			if (Base)
+				munmap(Base, Reserved);
+			if (Fd >= 0)
+				::close(Fd);
+			Fd = -1;
+			Base = nullptr;
+			Tr = nullptr;
+			Reserved = FileSize = 0;
+			Writable = false;
+		}
+
+		bool is_open() const { return Tr != nullptr; }
+
+		void sync()
+		{
+			if (Tr && Writable)
+				msync(Base, FileSize, MS_SYNC);
+		}
+
+		T &at(const Key &key)
+		{
+			Node *Ptr = Tr->find(key);
+			if (!Ptr)
+				throw index_out_of_bound();
+			return Ptr->Val();
+		}
+
+		const T &at(const Key &key) const
+		{
+			Node *Ptr = Tr->find(key);
+			if (!Ptr)
+				throw index_out_of_bound();
+			return Ptr->Val();
+		}
+
+		T &operator[](const Key &key)
+		{
+			reserve_node();
+			return Tr->insert(key, T()).first->Val();
+		}
+
+		const T &operator[](const Key &key) const
+		{
+			return at(key);
+		}
+
+		iterator begin() { return iterator(Tr, Tr->Begin); }
+
+		const_iterator cbegin() const { return const_iterator(Tr, Tr->Begin); }
+
+		iterator end() { return iterator(Tr, nullptr); }
+
+		const_iterator cend() const { return const_iterator(Tr, nullptr); }
+
+		bool empty() const { return !Tr->get_size(); }
+
+		size_t size() const { return Tr->get_size(); }
+
+		/**
+		 * drop every element and shrink the file back to its initial size.
+		 */
+		void clear()
+		{
+			check_writable();
+			Tr->Root = Tr->Begin = Tr->End = nullptr;
+			Tr->Size = 0;
+			Tr->Alloc.Used = DataOffset;
+			Tr->Alloc.FreeHead = 0;
+			if (!ftruncate(Fd, InitialSize))
+				FileSize = InitialSize;
+		}
+
+		pair<iterator, bool> insert(const value_type &value)
+		{
+			reserve_node();
+			std ::pair<Node *, bool> ans = Tr->insert(value.first, value.second);
+			return pair<iterator, bool>(iterator(Tr, ans.first), ans.second);
+		}
+
+		void erase(iterator pos)
+		{
+			check_writable();
+			if (pos.Ptr && pos.Belong == Tr && Tr->find(pos.Ptr->Key()) == pos.Ptr)
+				Tr->erase(pos.Ptr);
+			else
+				throw invalid_iterator();
+		}
+
+		size_t count(const Key &key) const
+		{
+			return Tr->find(key) != nullptr;
+		}
+
+		iterator find(const Key &key)
+		{
+			return iterator(Tr, Tr->find(key));
+		}
+
+		const_iterator find(const Key &key) const
+		{
+			return const_iterator(Tr, Tr->find(key));
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,299 @@
+#ifndef SJTU_MERGED_VIEW_HPP
+#define SJTU_MERGED_VIEW_HPP
+
+// one ordered scan over many sjtu::map shards, merged lazily.
+
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+namespace sjtu
+{
+	/**
+	 * duplicate policy of merged_view, the default: a key present in several shards is
+	 * visited once per shard, in the order of the shards.
+	 */
+	struct merge_keep_all
+	{
+		static const bool Unique = false, Last = false;
+	};
+
+	/**
+	 * duplicate policy of merged_view: a key is visited once, with the element of the first
+	 * shard that has it.
+	 */
+	struct merge_first_wins
+	{
+		static const bool Unique = true, Last = false;
+	};
+
+	/**
+	 * duplicate policy of merged_view: a key is visited once, with the element of the last
+	 * shard that has it, as if the shards were applied in order like updates.
+	 */
+	struct merge_last_wins
+	{
+		static const bool Unique = true, Last = true;
+	};
+
+	/**
+	 * the elements of k maps of the same type as one sorted sequence, without copying them.
+	 * an iterator keeps one cursor per shard in a loser tree (a tournament tree whose inner
+	 * nodes remember the loser of their match, with a pointer to its key), so the next element
+	 * costs one walk from a leaf to the root, ceil(log2 k) comparisons of keys, and no
+	 * allocation or copy of a key.
+	 * begin() and lower_bound() position every cursor, O(k log n), then the scan is lazy.
+	 *
+	 *     std::vector<sjtu::map<int, int> > Shards(256);
+	 *     sjtu::merged_view<sjtu::map<int, int> > All(Shards.begin(), Shards.end());
+	 *     for (auto it = All.lower_bound(100); it != All.end() && it->first < 200; ++it) ...
+	 *
+	 * the view holds pointers to the shards, which must outlive it; like other iterators of
+	 * a map, the iterators are invalidated by erasing the elements they are on. an iterator
+	 * holds O(k) state, so it is better passed by reference.
+	 */
+	template <class Map, class Duplicates = merge_keep_all>
+	class merged_view
+	{
+	public:
+		typedef typename Map::value_type value_type;
+		typedef typename Map::key_type key_type;
+		typedef typename Map::key_compare key_compare;
+
+	private:
+		typedef typename Map::const_iterator map_iterator;
+
+		std::vector<const Map *> Shards;
+
+	public:
+		class const_iterator
+		{
+			friend class merged_view;
+
+		private:
+			struct Cursor
+			{
+				map_iterator At, End;
+			};
+
+			/**
+			 * a shard in the tournament, with the key of its cursor, which stays put in the map
+			 * until the cursor moves; nullptr once the shard is exhausted.
+			 */
+			struct Player
+			{
+				const key_type *Key;
+				size_t Leaf;
+				bool Done;
+			};
+
+			std::vector<Cursor> Cur;
+			std::vector<Player> Tree; // Tree[0] is the winner, Tree[x] the loser of match x, leaf i plays at k + i
+			const value_type *Val;	  // nullptr at the end
+			size_t Shard;
+			key_compare cmp;
+
+			size_t k() const { return Cur.size(); }
+
+			/**
+			 * the least key wins, ties go to the first shard, exhausted shards lose.
+			 */
+			bool beats(const Player &a, const Player &b) const
+			{
+				if (a.Done || b.Done)
+					return !a.Done && (b.Done || a.Leaf < b.Leaf);
+				if (cmp(*a.Key, *b.Key))
+					return true;
+				if (cmp(*b.Key, *a.Key))
+					return false;
+				return a.Leaf < b.Leaf;
+			}
+
+			/**
+			 * play every match bottom-up.
+			 */
+			void build()
+			{
+				Tree.clear();
+				if (!k())
+					return;
+				Player Filler = {nullptr, 0, true};
+				std::vector<Player> Winner(2 * k(), Filler);
+				for (size_t i = 0; i < k(); i++)
+				{
+					Winner[k() + i].Leaf = i;
+					if (Cur[i].At != Cur[i].End)
+					{
+						Winner[k() + i].Key = &Cur[i].At->first;
+						Winner[k() + i].Done = false;
+					}
+				}
+				Tree.assign(k(), Filler);
+				for (size_t x = k() - 1; x; x--)
+				{
+					bool Left = beats(Winner[2 * x], Winner[2 * x + 1]);
+					Winner[x] = Winner[2 * x + !Left];
+					Tree[x] = Winner[2 * x + Left];
+				}
+				Tree[0] = Winner[1];
+			}
+
+			/**
+			 * advance the cursor of the winner and replay its matches up to the root.
+			 */
+			void replay()
+			{
+				Player w = Tree[0];
+				Cursor &c = Cur[w.Leaf];
+				if (++c.At == c.End)
+					w.Done = true, w.Key = nullptr;
+				else
+					w.Key = &c.At->first;
+				for (size_t x = (k() + w.Leaf) / 2; x; x /= 2)
+					if (beats(Tree[x], w))
+						std::swap(Tree[x], w);
+				Tree[0] = w;
+			}
+
+			/**
+			 * take the winner as the current element, then apply the duplicate policy.
+			 */
+			void take()
+			{
+				if (Tree.empty() || Tree[0].Done)
+				{
+					Val = nullptr;
+					return;
+				}
+				Shard = Tree[0].Leaf;
+				Val = &*Cur[Shard].At;
+				replay();
+				if (Duplicates::Unique)
+					while (!Tree[0].Done && !cmp(Val->first, *Tree[0].Key))
+					{
+						if (Duplicates::Last)
+						{
+							Shard = Tree[0].Leaf;
+							Val = &*Cur[Shard].At;
+						}
+						replay();
+					}
+			}
+
+		public:
+			const_iterator() : Val(nullptr), Shard(0) {}
+
+			const_iterator &operator++()
+			{
+				if (!Val)
+					throw invalid_iterator();
+				take();
+				return *this;
+			}
+
+			const_iterator operator++(int)
+			{
+				const_iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+
+			const value_type &operator*() const
+			{
+				if (!Val)
+					throw invalid_iterator();
+				return *Val;
+			}
+
+			const value_type *operator->() const
+			{
+				if (!Val)
+					throw invalid_iterator();
+				return Val;
+			}
+
+			/**
+			 * the index of the shard the current element comes from.
+			 */
+			size_t shard() const { return Shard; }
+
+			bool operator==(const const_iterator &rhs) const { return Val == rhs.Val; }
+
+			bool operator!=(const const_iterator &rhs) const { return Val != rhs.Val; }
+		};
+
+	private:
+		template <class Seek>
+		const_iterator start(Seek seek) const
+		{
+			const_iterator it;
+			it.Cur.resize(Shards.size());
+			for (size_t i = 0; i < Shards.size(); i++)
+			{
+				it.Cur[i].At = seek(*Shards[i]);
+				it.Cur[i].End = Shards[i]->cend();
+			}
+			it.build();
+			it.take();
+			return it;
+		}
+
+	public:
+		/**
+		 * the maps of [first, last), in this order for the duplicate policies.
+		 */
+		template <class It>
+		merged_view(It first, It last)
+		{
+			for (; first != last; ++first)
+				Shards.push_back(&*first);
+		}
+
+		merged_view(std::initializer_list<const Map *> shards) : Shards(shards) {}
+
+		const_iterator begin() const
+		{
+			return start([](const Map &m) { return m.cbegin(); });
+		}
+
+		const_iterator cbegin() const { return begin(); }
+
+		const_iterator end() const { return const_iterator(); }
+
+		const_iterator cend() const { return end(); }
+
+		/**
+		 * start the scan at the first element whose key is not less than key.
+		 */
+		const_iterator lower_bound(const key_type &key) const
+		{
+			return start([&](const Map &m) { return m.lower_bound(key); });
+		}
+
+		/**
+		 * start the scan at the first element whose key is greater than key.
+		 */
+		const_iterator upper_bound(const key_type &key) const
+		{
+			return start([&](const Map &m) { return m.upper_bound(key); });
+		}
+
+		size_t shards() const { return Shards.size(); }
+
+		/**
+		 * the number of elements of all shards, duplicates counted once per shard.
+		 */
+		size_t size() const
+		{
+			size_t n = 0;
+			for (size_t i = 0; i < Shards.size(); i++)
+				n += Shards[i]->size();
+			return n;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,304 @@
+#ifndef SJTU_PARALLEL_HPP
+#define SJTU_PARALLEL_HPP
+
+// parallel iteration and reductions over sjtu::map.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "map.hpp"
+
+namespace sjtu
+{
+	/**
+	 * a fixed set of threads running batches of numbered tasks.
+	 * every worker owns a deque holding a contiguous share of the tasks and takes from its back,
+	 * a worker whose deque is empty steals from the front of the others,
+	 * so uneven tasks are balanced without a central queue.
+	 * the thread calling run() works as worker 0, a pool of 1 thread runs everything inline.
+	 */
+	class work_stealing_pool
+	{
+	private:
+		struct task_deque
+		{
+			std::mutex Lock;
+			std::deque<std::size_t> Tasks;
+		};
+
+		std::vector<std::unique_ptr<task_deque> > Queues;
+		std::vector<std::thread> Threads;
+		std::mutex Lock, RunLock;
+		std::condition_variable Wake, Idle;
+		const std::function<void(std::size_t)> *Job;
+		std::atomic<std::size_t> Remaining;
+		unsigned long long Round; // bumped by every run()
+		unsigned Busy;			  // workers inside work()
+		bool Stop;
+		std::exception_ptr Error;
+
+		bool take(unsigned self, std::size_t &task)
+		{
+			{
+				task_deque &q = *Queues[self];
+				std::lock_guard<std::mutex> Guard(q.Lock);
+				if (!q.Tasks.empty())
+				{
+					task = q.Tasks.back();
+					q.Tasks.pop_back();
+					return true;
+				}
+			}
+			for (unsigned k = 1; k < Queues.size(); k++)
+			{
+				task_deque &q = *Queues[(self + k) % Queues.size()];
+				std::lock_guard<std::mutex> Guard(q.Lock);
+				if (!q.Tasks.empty())
+				{
+					task = q.Tasks.front();
+					q.Tasks.pop_front();
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void work(unsigned self)
+		{
+			std::size_t task;
+			while (take(self, task))
+			{
+				try
+				{
+					(*Job)(task);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> Guard(Lock);
+					if (!Error)
+						Error = std::current_exception();
+				}
+				if (--Remaining == 0)
+				{
+					std::lock_guard<std::mutex> Guard(Lock);
+					Idle.notify_all();
+				}
+			}
+		}
+
+		void loop(unsigned self)
+		{
+			unsigned long long Seen = 0;
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> Guard(Lock);
+					Wake.wait(Guard, [&] { return Stop || Round != Seen; });
+					if (Stop)
+						return;
+					Seen = Round;
+					Busy++;
+				}
+				work(self);
+				{
+					std::lock_guard<std::mutex> Guard(Lock);
+					Busy--;
+					Idle.notify_all();
+				}
+			}
+		}
+
+	public:
+		/**
+		 * 0 threads means std::thread::hardware_concurrency().
+		 */
+		explicit work_stealing_pool(unsigned threads = 0) : Job(nullptr), Remaining(0), Round(0), Busy(0), Stop(false)
+		{
+			if (!threads)
+				threads = std::max(1u, std::thread::hardware_concurrency());
+			for (unsigned i = 0; i < threads; i++)
+				Queues.emplace_back(new task_deque);
+			for (unsigned i = 1; i < threads; i++)
+				Threads.emplace_back(&work_stealing_pool::loop, this, i);
+		}
+
+		work_stealing_pool(const work_stealing_pool &) = delete;
+
+		work_stealing_pool &operator=(const work_stealing_pool &) = delete;
+
+		~work_stealing_pool()
+		{
+			{
+				std::lock_guard<std::mutex> Guard(Lock);
+				Stop = true;
+			}
+			Wake.notify_all();
+			for (std::thread &t : Threads)
+				t.join();
+		}
+
+		unsigned size() const { return unsigned(Queues.size()); }
+
+		/**
+		 * call fn(0) .. fn(tasks - 1), each exactly once and in any order, and wait for all of them.
+		 * the first exception thrown by a task is rethrown here once every task has finished.
+		 */
+		void run(std::size_t tasks, const std::function<void(std::size_t)> &fn)
+		{
+			if (!tasks)
+				return;
+			std::lock_guard<std::mutex> Serial(RunLock);
+			Job = &fn;
+			Error = nullptr;
+			Remaining = tasks;
+			std::size_t n = Queues.size();
+			for (std::size_t w = 0; w < n; w++)
+			{
+				std::lock_guard<std::mutex> Guard(Queues[w]->Lock);
+				for (std::size_t i = w * tasks / n; i < (w + 1) * tasks / n; i++)
+					Queues[w]->Tasks.push_back(i);
+			}
+			{
+				std::lock_guard<std::mutex> Guard(Lock);
+				Round++;
+			}
+			Wake.notify_all();
+			work(0);
+			{
+				std::unique_lock<std::mutex> Guard(Lock);
+				Idle.wait(Guard, [&] { return !Remaining && !Busy; });
+			}
+			if (Error)
+				std::rethrow_exception(Error);
+		}
+	};
+
+	/**
+	 * the pool used when none is given, with one thread per core.
+	 */
+	inline work_stealing_pool &default_pool()
+	{
+		static work_stealing_pool Pool;
+		return Pool;
+	}
+
+	namespace parallel_detail
+	{
+		template <class It>
+		struct collect
+		{
+			std::vector<std::pair<It, It> > &Ranges;
+
+			void operator()(It first, It last) { Ranges.push_back(std::make_pair(first, last)); }
+		};
+
+		/**
+		 * cut depth for a map of n elements: pieces of about Grain elements, at most 2^16 of them.
+		 * it depends on n only, never on the number of threads, which keeps reductions reproducible.
+		 */
+		inline int depth_for(std::size_t n)
+		{
+			const std::size_t Grain = 2048;
+			int d = 0;
+			while (d < 16 && (n >> d) > Grain)
+				d++;
+			return d;
+		}
+
+		template <class Map, class It>
+		std::vector<std::pair<It, It> > ranges(Map &m)
+		{
+			std::vector<std::pair<It, It> > ans;
+			collect<It> out = {ans};
+			m.split(depth_for(m.size()), out);
+			return ans;
+		}
+	}
+
+	/**
+	 * call f(value) for every element, in parallel over subtrees of the map.
+	 * f may modify the mapped values but must not insert or erase.
+	 */
+	template <class Key, class T, class Compare, class Stats, class Checks, class Balance, class Small, class F>
+	void parallel_for_each(map<Key, T, Compare, Stats, Checks, Balance, Small> &m, F f, work_stealing_pool &pool = default_pool())
+	{
+		typedef typename map<Key, T, Compare, Stats, Checks, Balance, Small>::iterator It;
+		std::vector<std::pair<It, It> > Ranges = parallel_detail::ranges<map<Key, T, Compare, Stats, Checks, Balance, Small>, It>(m);
+		pool.run(Ranges.size(), [&](std::size_t i) {
+			for (It it = Ranges[i].first; it != Ranges[i].second; ++it)
+				f(*it);
+		});
+	}
+
+	template <class Key, class T, class Compare, class Stats, class Checks, class Balance, class Small, class F>
+	void parallel_for_each(const map<Key, T, Compare, Stats, Checks, Balance, Small> &m, F f, work_stealing_pool &pool = default_pool())
+	{
+		typedef typename map<Key, T, Compare, Stats, Checks, Balance, Small>::const_iterator It;
+		std::vector<std::pair<It, It> > Ranges = parallel_detail::ranges<const map<Key, T, Compare, Stats, Checks, Balance, Small>, It>(m);
+		pool.run(Ranges.size(), [&](std::size_t i) {
+			for (It it = Ranges[i].first; it != Ranges[i].second; ++it)
+				f(*it);
+		});
+	}
+
+	/**
+	 * fold every piece of the map in key order starting from identity, with fold(R, const value_type &),
+	 * then combine the partial results in key order, with combine(R, R).
+	 * identity has to be neutral for combine.
+	 * the pieces only depend on the shape of the tree, so the result is the same for any
+	 * number of threads, floating point sums included.
+	 */
+	template <class Key, class T, class Compare, class Stats, class Checks, class Balance, class Small, class R, class Fold, class Combine>
+	R parallel_reduce(const map<Key, T, Compare, Stats, Checks, Balance, Small> &m, R identity, Fold fold, Combine combine, work_stealing_pool &pool = default_pool())
+	{
+		typedef typename map<Key, T, Compare, Stats, Checks, Balance, Small>::const_iterator It;
+		std::vector<std::pair<It, It> > Ranges = parallel_detail::ranges<const map<Key, T, Compare, Stats, Checks, Balance, Small>, It>(m);
+		std::vector<R> Part(Ranges.size(), identity);
+		pool.run(Ranges.size(), [&](std::size_t i) {
+			R acc = identity;
+			for (It it = Ranges[i].first; it != Ranges[i].second; ++it)
+				acc = fold(acc, *it);
+			Part[i] = acc;
+		});
+		R ans = identity;
+		for (std::size_t i = 0; i < Part.size(); i++)
+			ans = combine(ans, Part[i]);
+		return ans;
+	}
+
+	/**
+	 * reduce the mapped values with an associative op, in key order:
+	 *     long long sum = sjtu::parallel_reduce(m, 0LL, std::plus<long long>());
+	 * is op(...op(op(init, v1), v2)..., vn). init is taken once, it need not be neutral:
+	 * every piece starts from its own first value, and init is folded in front of the pieces.
+	 */
+	template <class Key, class T, class Compare, class Stats, class Checks, class Balance, class Small, class R, class Op>
+	R parallel_reduce(const map<Key, T, Compare, Stats, Checks, Balance, Small> &m, R init, Op op, work_stealing_pool &pool = default_pool())
+	{
+		typedef typename map<Key, T, Compare, Stats, Checks, Balance, Small>::const_iterator It;
+		std::vector<std::pair<It, It> > Ranges = parallel_detail::ranges<const map<Key, T, Compare, Stats, Checks, Balance, Small>, It>(m);
+		std::vector<R> Part(Ranges.size(), init);
+		pool.run(Ranges.size(), [&](std::size_t i) {
+			It it = Ranges[i].first;
+			R acc = R(it->second);
+			for (++it; it != Ranges[i].second; ++it)
+				acc = R(op(acc, it->second));
+			Part[i] = acc;
+		});
+		R ans = init;
+		for (std::size_t i = 0; i < Part.size(); i++)
+			ans = R(op(ans, Part[i]));
+		return ans;
+	}
+}
+
+#endif
@@ -0,0 +1,572 @@
+#ifndef SJTU_RADIX_MAP_HPP
+#define SJTU_RADIX_MAP_HPP
+
+// an ordered map for integer keys, and ordered_map which picks it automatically.
+
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "utility.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+namespace sjtu
+{
+	/**
+	 * whether Key ordered by Compare can be stored in a radix_map.
+	 */
+	template <class Key, class Compare>
+	struct radix_key_traits
+	{
+		static const bool value = false;
+	};
+
+	template <class Key>
+	struct radix_key_traits<Key, std::less<Key> >
+	{
+		static const bool value = std::is_integral<Key>::value && !std::is_same<Key, bool>::value;
+	};
+
+	/**
+	 * a radix tree over the bytes of the key, most significant first.
+	 * an inner node branches on one byte: a 256-bit bitmap tells which children exist
+	 * and the popcount below a bit is the index of that child in a dense array.
+	 * chains of single-child nodes are skipped (a node remembers which byte it branches on),
+	 * so a lookup costs at most sizeof(Key) steps and usually far fewer on sparse keys.
+	 *
+	 * leaves are threaded by nxt/pre in key order like the nodes of RBTree,
+	 * which gives ordered iteration, and lower_bound / predecessor / successor in one descent.
+	 * leaves never move: iterators stay valid until their element is erased.
+	 */
+	template <
+		class Key,
+		class T>
+	class radix_map
+	{
+		static_assert(radix_key_traits<Key, std::less<Key> >::value, "radix_map needs an integer key");
+
+		typedef typename std::make_unsigned<Key>::type Bits;
+		typedef std::uintptr_t Slot; // a tagged child: 0 for none, low bit set for a leaf
+
+		static const int Width = sizeof(Key) * 8, Levels = sizeof(Key);
+
+	public:
+		typedef pair<const Key, T> value_type;
+
+	private:
+		/**
+		 * signed keys get their sign bit flipped so that codes sort like the keys.
+		 */
+		static Bits encode(const Key &key)
+		{
+			return Bits(Bits(key) ^ (std::is_signed<Key>::value ? Bits(Bits(1) << (Width - 1)) : Bits(0)));
+		}
+
+		static int byte_of(Bits c, int d) { return int((c >> (Width - 8 * (d + 1))) & 255); }
+
+		/**
+		 * the first byte where a and b differ, Levels if they are equal.
+		 */
+		static int diff_byte(Bits a, Bits b)
+		{
+			unsigned long long x = (unsigned long long)(Bits)(a ^ b);
+			return x ? (__builtin_clzll(x) - (64 - Width)) / 8 : Levels;
+		}
+
+		struct Leaf
+		{
+			value_type ValueField;
+			Bits Code;
+			Leaf *nxt, *pre;
+
+			Leaf(const Key &_Key, const T &_Val) : ValueField(_Key, _Val), Code(encode(_Key)), nxt(nullptr), pre(nullptr) {}
+		};
+
+		struct Node
+		{
+			Bits Prefix; // code of some leaf below, only the bytes before Depth matter
+			int Depth;	 // the byte this node branches on
+			int Count, Cap;
+			unsigned long long Map[4];
+			Slot *Child;
+
+			Node(Bits _Prefix, int _Depth) : Prefix(_Prefix), Depth(_Depth), Count(0), Cap(2), Child(new Slot[2])
+			{
+				Map[0] = Map[1] = Map[2] = Map[3] = 0;
+			}
+
+			~Node() { delete[] Child; }
+
+			bool has(int b) const { return Map[b >> 6] >> (b & 63) & 1; }
+
+			int rank(int b) const
+			{
+				int r = 0;
+				for (int i = 0; i < (b >> 6); i++)
+					r += __builtin_popcountll(Map[i]);
+				return r + __builtin_popcountll(Map[b >> 6] & ((1ull << (b & 63)) - 1));
+			}
+
+			Slot *find(int b) { return has(b) ? Child + rank(b) : nullptr; }
+
+			/**
+			 * the first child byte greater than b, -1 if none.
+			 */
+			int next(int b) const
+			{
+				for (int i = (b + 1) >> 6; i < 4; i++)
+				{
+					unsigned long long w = Map[i];
+					if (i == (b + 1) >> 6)
+						w &= ~0ull << ((b + 1) & 63);
+					if (w)
+						return i * 64 + __builtin_ctzll(w);
+				}
+				return -1;
+			}
+
+			void add(int b, Slot s)
+			{
+				if (Count == Cap)
+				{
+					Slot *tmp = new Slot[Cap * 2];
+					std ::memcpy(tmp, Child, sizeof(Slot) * Count);
+					delete[] Child;
+					Child = tmp;
+					Cap *= 2;
+				}
+				int r = rank(b);
+				std ::memmove(Child + r + 1, Child + r, sizeof(Slot) * (Count - r));
+				Child[r] = s;
+				Count++;
+				Map[b >> 6] |= 1ull << (b & 63);
+			}
+
+			void remove(int b)
+			{
+				int r = rank(b);
+				std ::memmove(Child + r, Child + r + 1, sizeof(Slot) * (Count - r - 1));
+				Count--;
+				Map[b >> 6] &= ~(1ull << (b & 63));
+			}
+		};
+
+		static bool is_leaf(Slot s) { return s & 1; }
+		static Leaf *as_leaf(Slot s) { return reinterpret_cast<Leaf *>(s & ~Slot(1)); }
+		static Node *as_node(Slot s) { return reinterpret_cast<Node *>(s); }
+		static Slot tag(Leaf *x) { return reinterpret_cast<Slot>(x) | 1; }
+		static Slot tag(Node *x) { return reinterpret_cast<Slot>(x); }
+		static Bits code_of(Slot s) { return is_leaf(s) ? as_leaf(s)->Code : as_node(s)->Prefix; }
+
+		static Leaf *min_leaf(Slot s)
+		{
+			while (!is_leaf(s))
+				s = as_node(s)->Child[0];
+			return as_leaf(s);
+		}
+
+		Slot Root;
+		Leaf *Begin, *End;
+		size_t Size;
+
+		Leaf *locate(const Key &key) const
+		{
+			Bits c = encode(key);
+			Slot s = Root;
+			while (s && !is_leaf(s))
+			{
+				Slot *p = as_node(s)->find(byte_of(c, as_node(s)->Depth));
+				s = p ? *p : 0;
+			}
+			return s && as_leaf(s)->Code == c ? as_leaf(s) : nullptr;
+		}
+
+		/**
+		 * the first leaf of the subtree s whose code is not less than c, nullptr if none.
+		 */
+		static Leaf *lower(Slot s, Bits c)
+		{
+			if (is_leaf(s))
+				return as_leaf(s)->Code >= c ? as_leaf(s) : nullptr;
+
+			Node *x = as_node(s);
+			int m = diff_byte(x->Prefix, c);
+			if (m < x->Depth)
+				return byte_of(x->Prefix, m) > byte_of(c, m) ? min_leaf(s) : nullptr;
+
+			int b = byte_of(c, x->Depth);
+			Slot *p = x->find(b);
+			if (p)
+			{
+				Leaf *ans = lower(*p, c);
+				if (ans)
+					return ans;
+			}
+			int nb = x->next(b);
+			return nb >= 0 ? min_leaf(*x->find(nb)) : nullptr;
+		}
+
+		Leaf *lower(const Key &key) const
+		{
+			return Root ? lower(Root, encode(key)) : nullptr;
+		}
+
+		std ::pair<Leaf *, bool> insert(const Key &key, const T &val)
+		{
+			Bits c = encode(key);
+			Leaf *Succ = lower(key);
+			if (Succ && Succ->Code == c)
+				return std ::make_pair(Succ, false);
+
+			Leaf *x = new Leaf(key, val);
+			x->nxt = Succ;
+			x->pre = Succ ? Succ->pre : End;
+			(x->pre ? x->pre->nxt : Begin) = x;
+			(Succ ? Succ->pre : End) = x;
+			Size++;
+
+			Slot *p = &Root;
+			while (*p)
+			{
+				Bits oc = code_of(*p);
+				int m = diff_byte(oc, c);
+				if (is_leaf(*p) || m < as_node(*p)->Depth)
+				{
+					Node *y = new Node(c, m);
+					y->add(byte_of(oc, m), *p);
+					y->add(byte_of(c, m), tag(x));
+					*p = tag(y);
+					return std ::make_pair(x, true);
+				}
+
+				Node *y = as_node(*p);
+				int b = byte_of(c, y->Depth);
+				Slot *q = y->find(b);
+				if (!q)
+				{
+					y->add(b, tag(x));
+					return std ::make_pair(x, true);
+				}
+				p = q;
+			}
+			*p = tag(x);
+			return std ::make_pair(x, true);
+		}
+
+		void erase(Leaf *x)
+		{
+			(x->pre ? x->pre->nxt : Begin) = x->nxt;
+			(x->nxt ? x->nxt->pre : End) = x->pre;
+			Size--;
+
+			Slot *p = &Root, *pp = nullptr;
+			Node *Fa = nullptr;
+			while (!is_leaf(*p))
+			{
+				pp = p;
+				Fa = as_node(*p);
+				p = Fa->find(byte_of(x->Code, Fa->Depth));
+			}
+
+			if (!Fa)
+				Root = 0;
+			else
+			{
+				Fa->remove(byte_of(x->Code, Fa->Depth));
+				if (Fa->Count == 1)
+				{
+					*pp = Fa->Child[0];
+					delete Fa;
+				}
+			}
+			delete x;
+		}
+
+		static void destroy(Slot s)
+		{
+			if (!s)
+				return;
+			if (is_leaf(s))
+			{
+				delete as_leaf(s);
+				return;
+			}
+			Node *x = as_node(s);
+			for (int i = 0; i < x->Count; i++)
+				destroy(x->Child[i]);
+			delete x;
+		}
+
+		void copy_from(const radix_map &other)
+		{
+			for (Leaf *x = other.Begin; x; x = x->nxt)
+				insert(x->ValueField.first, x->ValueField.second);
+		}
+
+	public:
+		class const_iterator;
+		class iterator
+		{
+			friend class radix_map;
+
+		private:
+			radix_map *Belong;
+			Leaf *Ptr;
+
+		public:
+			iterator() : Belong(nullptr), Ptr(nullptr) {}
+
+			iterator(radix_map *_Belong, Leaf *node) : Belong(_Belong), Ptr(node) {}
+
+			iterator operator++(int)
+			{
+				iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+
+			iterator &operator++()
+			{
+				if (!Ptr)
+					throw invalid_iterator();
+				Ptr = Ptr->nxt;
+				return *this;
+			}
+
+			iterator operator--(int)
+			{
+				iterator tmp = *this;
+				--*this;
+				return tmp;
+			}
+
+			iterator &operator--()
+			{
+				Leaf *p = Ptr ? Ptr->pre : Belong->End;
+				if (!p)
+					throw invalid_iterator();
+				Ptr = p;
+				return *this;
+			}
+
+			value_type &operator*() const { return Ptr->ValueField; }
+
+			bool operator==(const iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+
+			bool operator==(const const_iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+
+			bool operator!=(const iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+
+			bool operator!=(const const_iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+
+			value_type *operator->() const noexcept { return &(Ptr->ValueField); }
+		};
+		class const_iterator
+		{
+			friend class radix_map;
+
+		private:
+			const radix_map *Belong;
+			Leaf *Ptr;
+
+		public:
+			const_iterator() : Belong(nullptr), Ptr(nullptr) {}
+
+			const_iterator(const radix_map *_Belong, Leaf *node) : Belong(_Belong), Ptr(node) {}
+
+			const_iterator(const iterator &other) : Belong(other.Belong), Ptr(other.Ptr) {}
+
+			const_iterator operator++(int)
+			{
+				const_iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+
+			const_iterator &operator++()
+			{
+				if (!Ptr)
+					throw invalid_iterator();
+				Ptr = Ptr->nxt;
+				return *this;
+			}
+
+			const_iterator operator--(int)
+			{
+				const_iterator tmp = *this;
+				--*this;
+				return tmp;
+			}
+
+			const_iterator &operator--()
+			{
+				Leaf *p = Ptr ? Ptr->pre : Belong->End;
+				if (!p)
+					throw invalid_iterator();
+				Ptr = p;
+				return *this;
+			}
+
+			const value_type &operator*() const { return Ptr->ValueField; }
+
+			bool operator==(const iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+
+			bool operator==(const const_iterator &rhs) const { return Ptr == rhs.Ptr && Belong == rhs.Belong; }
+
+			bool operator!=(const iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+
+			bool operator!=(const const_iterator &rhs) const { return Ptr != rhs.Ptr || Belong != rhs.Belong; }
+
+			const value_type *operator->() const noexcept { return &(Ptr->ValueField); }
+		};
+
+		radix_map() : Root(0), Begin(nullptr), End(nullptr), Size(0) {}
+
+		radix_map(const radix_map &other) : Root(0), Begin(nullptr), End(nullptr), Size(0)
+		{
+			copy_from(other);
+		}
+
+		radix_map &operator=(const radix_map &other)
+		{
+			if (this == &other)
+				return *this;
+			clear();
+			copy_from(other);
+			return *this;
+		}
+
+		~radix_map() { destroy(Root); }
+
+		T &at(const Key &key)
+		{
+			Leaf *x = locate(key);
+			if (!x)
+				throw index_out_of_bound();
+			return x->ValueField.second;
+		}
+
+		const T &at(const Key &key) const
+		{
+			Leaf *x = locate(key);
+			if (!x)
+				throw index_out_of_bound();
+			return x->ValueField.second;
+		}
+
+		T &operator[](const Key &key)
+		{
+			Leaf *x = locate(key);
+			return x ? x->ValueField.second : insert(key, T()).first->ValueField.second;
+		}
+
+		const T &operator[](const Key &key) const
+		{
+			return at(key);
+		}
+
+		iterator begin() { return iterator(this, Begin); }
+
+		const_iterator cbegin() const { return const_iterator(this, Begin); }
+
+		iterator end() { return iterator(this, nullptr); }
+
+		const_iterator cend() const { return const_iterator(this, nullptr); }
+
+		bool empty() const { return !Size; }
+
+		size_t size() const { return Size; }
+
+		void clear()
+		{
+			destroy(Root);
+			Root = 0;
+			Begin = End = nullptr;
+			Size = 0;
+		}
+
+		pair<iterator, bool> insert(const value_type &value)
+		{
+			std ::pair<Leaf *, bool> ans = insert(value.first, value.second);
+			return pair<iterator, bool>(iterator(this, ans.first), ans.second);
+		}
+
+		void erase(iterator pos)
+		{
+			if (pos.Belong == this && pos.Ptr && locate(pos.Ptr->ValueField.first) == pos.Ptr)
+				erase(pos.Ptr);
+			else
+				throw invalid_iterator();
+		}
+
+		size_t count(const Key &key) const
+		{
+			return locate(key) != nullptr;
+		}
+
+		iterator find(const Key &key)
+		{
+			return iterator(this, locate(key));
+		}
+
+		const_iterator find(const Key &key) const
+		{
+			return const_iterator(this, locate(key));
+		}
+
+		/**
+		 * the first element whose key is not less than key.
+		 */
+		iterator lower_bound(const Key &key) { return iterator(this, lower(key)); }
+
+		const_iterator lower_bound(const Key &key) const { return const_iterator(this, lower(key)); }
+
+		/**
+		 * the first element whose key is greater than key.
+		 */
+		iterator upper_bound(const Key &key) { return iterator(this, upper(key)); }
+
+		const_iterator upper_bound(const Key &key) const { return const_iterator(this, upper(key)); }
+
+		/**
+		 * the last element whose key is less than key, end() if none.
+		 */
+		iterator predecessor(const Key &key) { return iterator(this, pred(key)); }
+
+		const_iterator predecessor(const Key &key) const { return const_iterator(this, pred(key)); }
+
+		/**
+		 * the first element whose key is greater than key, end() if none.
+		 */
+		iterator successor(const Key &key) { return upper_bound(key); }
+
+		const_iterator successor(const Key &key) const { return upper_bound(key); }
+
+	private:
+		Leaf *upper(const Key &key) const
+		{
+			Leaf *x = lower(key);
+			return x && x->Code == encode(key) ? x->nxt : x;
+		}
+
+		Leaf *pred(const Key &key) const
+		{
+			Leaf *x = lower(key);
+			return x ? x->pre : End;
+		}
+	};
+
+	/**
+	 * an ordered map which picks its backend from the key:
+	 * radix_map for integer keys under std::less, sjtu::map (a red-black tree) otherwise.
+	 */
+	template <
+		class Key,
+		class T,
+		class Compare = std::less<Key> >
+	using ordered_map = typename std::conditional<radix_key_traits<Key, Compare>::value, radix_map<Key, T>, map<Key, T, Compare> >::type;
+}
+
+#endif
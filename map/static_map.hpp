@@ -0,0 +1,142 @@
+#ifndef SJTU_STATIC_MAP_HPP
+#define SJTU_STATIC_MAP_HPP
+
+// a fixed key -> value table built at compile time, needs C++14.
+
+#include <functional>
+#include <cstddef>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+#if __cplusplus < 201402L
+#error "static_map.hpp needs C++14 (relaxed constexpr)"
+#endif
+
+namespace sjtu
+{
+	/**
+	 * an immutable map of N elements kept in a sorted array.
+	 * the constructor sorts its argument and rejects duplicate keys, all in constexpr,
+	 * so a constexpr static_map costs nothing at run time.
+	 * find / at / count behave like those of sjtu::map.
+	 *
+	 *     constexpr auto Ops = sjtu::make_static_map<int, const char *>({{2, "add"}, {1, "nop"}});
+	 *     static_assert(Ops.count(2), "");
+	 *
+	 * Key, T and Compare have to be literal types for the table to be constexpr.
+	 */
+	template <
+		class Key,
+		class T,
+		std::size_t N,
+		class Compare = std::less<Key> >
+	class static_map
+	{
+	public:
+		typedef pair<Key, T> value_type;
+		typedef const value_type *const_iterator;
+
+		static_assert(N > 0, "a static_map holds at least one element");
+
+	private:
+		value_type Data[N];
+		Compare cmp;
+
+		/**
+		 * branch-free binary search: the halving always takes the same steps,
+		 * only the base moves, which compiles to a conditional move.
+		 */
+		constexpr std::size_t lower(const Key &key) const
+		{
+			std::size_t Base = 0, Len = N;
+			while (Len > 1)
+			{
+				std::size_t Half = Len / 2;
+				Base = cmp(Data[Base + Half].first, key) ? Base + Half : Base;
+				Len -= Half;
+			}
+			return Base + cmp(Data[Base].first, key);
+		}
+
+		constexpr std::size_t locate(const Key &key) const
+		{
+			std::size_t i = lower(key);
+			return i < N && !cmp(key, Data[i].first) ? i : N;
+		}
+
+	public:
+		/**
+		 * throw runtime_error on a duplicate key, which is a compile error in a constant expression.
+		 */
+		constexpr static_map(const value_type (&init)[N], const Compare &_cmp = Compare()) : Data(), cmp(_cmp)
+		{
+			for (std::size_t i = 0; i < N; i++)
+			{
+				std::size_t j = i;
+				for (; j > 0 && cmp(init[i].first, Data[j - 1].first); j--)
+					Data[j] = Data[j - 1];
+				Data[j] = init[i];
+			}
+			for (std::size_t i = 1; i < N; i++)
+				if (!cmp(Data[i - 1].first, Data[i].first))
+					throw runtime_error();
+		}
+
+		/**
+		 * throw index_out_of_bound if the key does not exist.
+		 */
+		constexpr const T &at(const Key &key) const
+		{
+			std::size_t i = locate(key);
+			if (i == N)
+				throw index_out_of_bound();
+			return Data[i].second;
+		}
+
+		constexpr const T &operator[](const Key &key) const
+		{
+			return at(key);
+		}
+
+		constexpr const_iterator find(const Key &key) const
+		{
+			return Data + locate(key);
+		}
+
+		constexpr size_t count(const Key &key) const
+		{
+			return locate(key) != N;
+		}
+
+		/**
+		 * the first element whose key is not less than key.
+		 */
+		constexpr const_iterator lower_bound(const Key &key) const
+		{
+			return Data + lower(key);
+		}
+
+		constexpr const_iterator begin() const { return Data; }
+
+		constexpr const_iterator cbegin() const { return Data; }
+
+		constexpr const_iterator end() const { return Data + N; }
+
+		constexpr const_iterator cend() const { return Data + N; }
+
+		constexpr bool empty() const { return !N; }
+
+		constexpr size_t size() const { return N; }
+	};
+
+	/**
+	 * deduce N from a braced list: make_static_map<int, int>({{1, 2}, {3, 4}}).
+	 */
+	template <class Key, class T, class Compare = std::less<Key>, std::size_t N>
+	constexpr static_map<Key, T, N, Compare> make_static_map(const pair<Key, T> (&init)[N], const Compare &cmp = Compare())
+	{
+		return static_map<Key, T, N, Compare>(init, cmp);
+	}
+}
+
+#endif
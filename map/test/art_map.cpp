@@ -0,0 +1,148 @@
+// art_map against std::map<std::string, int>: keys over a small alphabet with '\0' and
+// '\xff', so that many keys are prefixes of others and nodes branch on the extreme bytes,
+// and keys over 18, 48 and all 256 bytes, so that nodes sit around the sizes 16 and 48, or
+// grow to 256 children, and shrink back;
+// find, insert, erase, lower/upper_bound, prefix_range, iteration both ways and copies.
+
+#include <iterator>
+#include <map>
+#include <string>
+#include "test.hpp"
+#include "exceptions.hpp"
+#include "art_map.hpp"
+
+typedef sjtu::art_map<int> Art;
+
+/**
+ * a key of up to Len bytes from the first Alpha bytes of the alphabet.
+ */
+std::string key(int Alpha, int Len)
+{
+	static const char Abc[] = {'\0', '\xff', 'a', 'b', '\x7f', '\x80', 'c', '\x01'};
+	std::string k(size_t(test::below(Len + 1)), '\0');
+	for (size_t i = 0; i < k.size(); i++)
+		k[i] = Alpha <= 8 ? Abc[test::below(Alpha)] : char(test::below(Alpha));
+	return k;
+}
+
+void same(const Art &m, const std::map<std::string, int> &ref)
+{
+	CHECK(m.size() == ref.size() && m.empty() == ref.empty());
+	Art::const_iterator it = m.cbegin();
+	for (std::map<std::string, int>::const_iterator r = ref.begin(); r != ref.end(); ++r, ++it)
+		CHECK(it != m.cend() && it->first == r->first && it->second == r->second);
+	CHECK(it == m.cend());
+	for (std::map<std::string, int>::const_reverse_iterator r = ref.rbegin(); r != ref.rend(); ++r)
+		CHECK((--it)->first == r->first);
+	if (ref.empty())
+		CHECK_THROWS(--it, sjtu::invalid_iterator);
+}
+
+void soak(long long ops, int Alpha, int Len)
+{
+	Art m;
+	std::map<std::string, int> ref;
+	for (long long i = 0; i < ops; i++)
+	{
+		std::string k = key(Alpha, Len);
+		int v = int(test::below(1 << 30));
+		switch (test::below(8))
+		{
+		case 0:
+		case 1:
+			CHECK(m.insert(Art::value_type(k, v)).second == ref.insert(std::make_pair(k, v)).second);
+			break;
+		case 2:
+			m[k] = v, ref[k] = v;
+			break;
+		case 3:
+		case 4:
+		{
+			Art::iterator it = m.find(k);
+			CHECK((it == m.end()) == !ref.count(k) && m.count(k) == ref.count(k));
+			if (it != m.end())
+			{
+				CHECK(it->second == ref[k]);
+				m.erase(it), ref.erase(k);
+				CHECK_THROWS(m.erase(m.end()), sjtu::invalid_iterator);
+			}
+			else
+				CHECK_THROWS(m.at(k), sjtu::index_out_of_bound);
+			break;
+		}
+		case 5:
+		{
+			Art::const_iterator lo = m.lower_bound(k), up = m.upper_bound(k);
+			std::map<std::string, int>::iterator rlo = ref.lower_bound(k), rup = ref.upper_bound(k);
+			CHECK(rlo == ref.end() ? lo == m.cend() : lo != m.cend() && lo->first == rlo->first);
+			CHECK(rup == ref.end() ? up == m.cend() : up != m.cend() && up->first == rup->first);
+			break;
+		}
+		case 6:
+		{
+			// prefix_range of a prefix of a present key, or of a key that may be absent
+			if (test::below(2) && !ref.empty())
+			{
+				std::map<std::string, int>::iterator r = ref.lower_bound(k);
+				if (r == ref.end())
+					--r;
+				k = r->first.substr(0, size_t(test::below((long long)r->first.size() + 1)));
+			}
+			sjtu::pair<Art::iterator, Art::iterator> range = m.prefix_range(k);
+			std::map<std::string, int>::iterator r = ref.lower_bound(k);
+			if (r == ref.end() || r->first.compare(0, k.size(), k))
+				CHECK(range.first == range.second && range.first == m.lower_bound(k));
+			else
+			{
+				for (; r != ref.end() && !r->first.compare(0, k.size(), k); ++r, ++range.first)
+					CHECK(range.first != range.second && range.first->first == r->first);
+				CHECK(range.first == range.second);
+			}
+			break;
+		}
+		default:
+			if (test::below(1000) == 0)
+			{
+				Art c(m);
+				same(c, ref);
+				m.clear();
+				CHECK(m.empty() && m.begin() == m.end());
+				m = c;
+			}
+			else if (test::below(3000) == 0)
+				m.clear(), ref.clear();
+			break;
+		}
+		if (i % 4096 == 0)
+			same(m, ref);
+	}
+	same(m, ref);
+	// fill the nodes up, then empty them in random order, through every shrink
+	for (long long i = 0; i < ops / 4; i++)
+	{
+		std::string k = key(Alpha, Len);
+		m[k] = 1, ref[k] = 1;
+	}
+	same(m, ref);
+	while (!ref.empty())
+	{
+		std::map<std::string, int>::iterator r = ref.begin();
+		std::advance(r, test::below((long long)ref.size()));
+		m.erase(m.find(r->first)), ref.erase(r);
+		if (ref.size() % 512 == 0)
+			same(m, ref);
+	}
+	same(m, ref);
+}
+
+int main()
+{
+	soak(100000, 2, 12);
+	soak(100000, 3, 8);
+	soak(200000, 8, 6);
+	soak(100000, 18, 3);
+	soak(100000, 48, 2);
+	soak(100000, 256, 2);
+	soak(100000, 256, 4);
+	return 0;
+}
@@ -0,0 +1,135 @@
+// every balancing policy through the soak of sjtu::map against std::map (insert, erase, finger
+// insert, copy and assignment, compact, validate()), and split_at() / join() of treap_balance
+// against cutting and gluing std::maps, on plain, compacted and checked maps.
+
+#include <map>
+#include "soak.hpp"
+
+template <class Checks, class Small = sjtu::no_small_buffer>
+struct treap_of
+{
+	typedef sjtu::map<int, int, std::less<int>, sjtu::tree_no_stats, Checks, sjtu::treap_balance, Small> type;
+};
+
+template <class Map>
+void same_or_empty(const Map &m, const std::map<int, int> &ref)
+{
+	test::same(m, ref);
+	if (ref.empty())
+		CHECK(m.cbegin() == m.cend());
+}
+
+/**
+ * cut a map at random keys and join the pieces back, in both orders of size,
+ * with changes to the pieces in between.
+ */
+template <class Map>
+void split_join(long long rounds, int keys)
+{
+	Map m;
+	std::map<int, int> ref;
+	for (long long round = 0; round < rounds; round++)
+	{
+		for (long long n = test::below(keys / 4 + 1); n; n--)
+		{
+			int key = int(test::below(keys));
+			m[key] = key, ref[key] = key;
+		}
+		if (test::below(4) == 0)
+			m.compact(test::below(2) ? size_t(-1) : size_t(test::below(64)));
+
+		int at = int(test::below(keys + 2)) - 1;
+		Map hi;
+		hi[keys + 1] = 0; // split_at() erases what out held
+		// an iterator to an element that stays has to stay valid, unless it is inline:
+		// an inline map grows into a tree first
+		bool stays = ref.size() > 8 && ref.begin()->first < at;
+		typename Map::iterator kept = m.begin();
+		m.split_at(at, hi);
+		std::map<int, int> rhi(ref.lower_bound(at), ref.end());
+		ref.erase(ref.lower_bound(at), ref.end());
+		same_or_empty(m, ref);
+		same_or_empty(hi, rhi);
+		if (stays)
+			CHECK(kept == m.begin() && kept->first == ref.begin()->first);
+
+		// the pieces work on their own
+		for (long long n = test::below(20); n; n--)
+		{
+			int key = int(test::below(keys));
+			if (key < at)
+				m[key] = -key, ref[key] = -key;
+			else
+				hi[key] = -key, rhi[key] = -key;
+			typename Map::iterator it = hi.find(int(test::below(keys)));
+			if (it != hi.end())
+				rhi.erase(it->first), hi.erase(it);
+		}
+		same_or_empty(m, ref);
+		same_or_empty(hi, rhi);
+
+		if (!ref.empty() && !rhi.empty())
+			CHECK_THROWS(hi.join(m), sjtu::runtime_error);
+		CHECK_THROWS(m.join(m), sjtu::runtime_error);
+		if (test::below(2))
+		{
+			m.join(hi);
+			ref.insert(rhi.begin(), rhi.end());
+		}
+		else
+		{
+			// the other way round: everything is split off, and the high part joins that
+			Map lo;
+			m.split_at(-1, lo);
+			CHECK(m.empty() && lo.size() == ref.size());
+			lo.join(hi);
+			m = lo;
+			ref.insert(rhi.begin(), rhi.end());
+		}
+		CHECK(hi.empty() && hi.validate());
+		same_or_empty(m, ref);
+		if (test::below(50) == 0)
+			m.clear(), ref.clear();
+	}
+}
+
+/**
+ * a join that is refused moves nothing, inline elements stay inline with their iterators.
+ */
+template <class Map>
+void refused_join()
+{
+	Map a, b;
+	a[1] = 1, a[5] = 5, b[3] = 3, b[7] = 7;
+	typename Map::iterator x = a.begin(), y = b.begin();
+	CHECK_THROWS(a.join(b), sjtu::runtime_error);
+	CHECK_THROWS(b.join(a), sjtu::runtime_error);
+	CHECK(a.height() == 0 && b.height() == 0);
+	CHECK(x == a.begin() && y == b.begin() && x->first == 1 && y->first == 3);
+	b.erase(y);
+	a.join(b);
+	CHECK(a.size() == 3 && b.empty() && a.validate() && b.validate());
+}
+
+int main()
+{
+	for (int keys : {16, 1000, 1 << 20})
+	{
+		test::soak<sjtu::map<int, int, std::less<int>, sjtu::tree_no_stats, sjtu::iterator_checks, sjtu::red_black_balance> >(30000, keys);
+		test::soak<sjtu::map<int, int, std::less<int>, sjtu::tree_no_stats, sjtu::iterator_checks, sjtu::avl_balance> >(30000, keys);
+		test::soak<sjtu::map<int, int, std::less<int>, sjtu::tree_no_stats, sjtu::iterator_checks, sjtu::splay_balance> >(30000, keys);
+		test::soak<sjtu::map<int, int, std::less<int>, sjtu::tree_no_stats, sjtu::iterator_checks, sjtu::treap_balance> >(30000, keys);
+		test::soak<sjtu::map<int, int, std::less<int>, sjtu::tree_stats, sjtu::checked_iterators, sjtu::avl_balance> >(20000, keys);
+		test::soak<sjtu::map<int, int, std::less<int>, sjtu::tree_stats, sjtu::checked_iterators, sjtu::splay_balance> >(20000, keys);
+		test::soak<sjtu::map<int, int, std::less<int>, sjtu::tree_stats, sjtu::checked_iterators, sjtu::treap_balance> >(20000, keys);
+	}
+	refused_join<treap_of<sjtu::iterator_checks, sjtu::small_buffer<8> >::type>();
+	refused_join<treap_of<sjtu::checked_iterators, sjtu::small_buffer<8> >::type>();
+	for (int keys : {4, 100, 10000})
+	{
+		split_join<treap_of<sjtu::iterator_checks>::type>(1000, keys);
+		split_join<treap_of<sjtu::checked_iterators>::type>(1000, keys);
+		split_join<treap_of<sjtu::iterator_checks, sjtu::small_buffer<8> >::type>(1000, keys);
+	}
+	return 0;
+}
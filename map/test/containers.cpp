@@ -0,0 +1,314 @@
+// the other containers of the map suite against std::map: unordered_map (also with a hash
+// that puts many keys on one home slot), radix_map over signed and unsigned keys, static_map
+// built at compile time and at run time, frozen_map built from sjtu::map, and merged_view
+// over shards with duplicate keys.
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+#include "test.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+#include "unordered_map.hpp"
+#include "radix_map.hpp"
+#include "static_map.hpp"
+#include "frozen_map.hpp"
+#include "merged_view.hpp"
+
+/**
+ * a hash that sends all keys to 8 home slots, so that probes run long and erase shifts far.
+ */
+struct crowded_hash
+{
+	size_t operator()(long long x) const { return size_t(x) & 7; }
+};
+
+template <class Map>
+void same_elements(Map &m, const std::map<long long, long long> &ref)
+{
+	CHECK(m.size() == ref.size());
+	std::map<long long, long long> seen;
+	for (typename Map::const_iterator it = m.cbegin(); it != m.cend(); ++it)
+		CHECK(seen.insert(std::make_pair(it->first, it->second)).second);
+	CHECK(seen == ref);
+}
+
+template <class Map>
+void unordered(long long ops, long long keys)
+{
+	Map m;
+	std::map<long long, long long> ref;
+	for (long long i = 0; i < ops; i++)
+	{
+		long long key = test::below(keys) - keys / 2, val = test::below(1 << 30);
+		switch (test::below(6))
+		{
+		case 0:
+		case 1:
+			CHECK(m.insert(typename Map::value_type(key, val)).second == ref.insert(std::make_pair(key, val)).second);
+			break;
+		case 2:
+		{
+			typename Map::iterator it = m.find(key);
+			CHECK((it == m.end()) == !ref.count(key));
+			if (it != m.end())
+				m.erase(it), ref.erase(key);
+			break;
+		}
+		case 3:
+			m[key] = val, ref[key] = val;
+			break;
+		case 4:
+			if (ref.count(key))
+				CHECK(m.at(key) == ref[key]);
+			else
+				CHECK_THROWS(m.at(key), sjtu::index_out_of_bound);
+			break;
+		default:
+			if (test::below(2000) == 0)
+			{
+				Map c(m);
+				same_elements(c, ref);
+				m = c;
+			}
+			else if (test::below(5000) == 0)
+				m.clear(), ref.clear();
+			break;
+		}
+		if (i % 4096 == 0)
+			same_elements(m, ref);
+	}
+	same_elements(m, ref);
+	CHECK_THROWS(Map(1.5f), sjtu::runtime_error);
+	CHECK_THROWS(m.max_load_factor(0), sjtu::runtime_error);
+}
+
+/**
+ * radix_map in key order, including the neighbours found from keys that are absent.
+ */
+template <class Key>
+void radix(long long ops, Key lo, unsigned long long span)
+{
+	sjtu::radix_map<Key, long long> m;
+	std::map<Key, long long> ref;
+	for (long long i = 0; i < ops; i++)
+	{
+		Key key = Key(lo + Key(test::rng()() % span));
+		long long val = test::below(1 << 30);
+		switch (test::below(5))
+		{
+		case 0:
+		case 1:
+			CHECK(m.insert(typename sjtu::radix_map<Key, long long>::value_type(key, val)).second == ref.insert(std::make_pair(key, val)).second);
+			break;
+		case 2:
+		{
+			typename sjtu::radix_map<Key, long long>::iterator it = m.find(key);
+			CHECK((it == m.end()) == !ref.count(key));
+			if (it != m.end())
+				m.erase(it), ref.erase(key);
+			break;
+		}
+		case 3:
+		{
+			typename sjtu::radix_map<Key, long long>::iterator lo = m.lower_bound(key), up = m.upper_bound(key), pre = m.predecessor(key);
+			typename std::map<Key, long long>::iterator rlo = ref.lower_bound(key), rup = ref.upper_bound(key);
+			CHECK(rlo == ref.end() ? lo == m.end() : lo != m.end() && lo->first == rlo->first);
+			CHECK(rup == ref.end() ? up == m.end() : up != m.end() && up->first == rup->first);
+			CHECK(rlo == ref.begin() ? pre == m.end() : pre != m.end() && pre->first == (--rlo)->first);
+			break;
+		}
+		default:
+			if (test::below(1000) == 0)
+			{
+				sjtu::radix_map<Key, long long> c(m);
+				m.clear();
+				m = c;
+			}
+			break;
+		}
+		if (i % 4096 == 0 || i == ops - 1)
+		{
+			CHECK(m.size() == ref.size());
+			typename sjtu::radix_map<Key, long long>::const_iterator it = m.cbegin();
+			for (typename std::map<Key, long long>::iterator r = ref.begin(); r != ref.end(); ++r, ++it)
+				CHECK(it->first == r->first && it->second == r->second);
+			CHECK(it == m.cend());
+		}
+	}
+}
+
+enum opcode
+{
+	NOP, LOAD, STORE, ADD, SUB, MUL, DIV, MOD, AND, OR, XOR, NOT, SHL, SHR, JMP, JZ,
+	JNZ, CALL, RET, PUSH, POP, CMP, MOV, LEA, INC, DEC, NEG, HALT, IN, OUT, INT, IRET
+};
+
+constexpr sjtu::pair<int, int> Init[] = {
+	{HALT, 1}, {NOP, 1}, {LOAD, 3}, {STORE, 3}, {ADD, 2}, {SUB, 2}, {MUL, 4}, {DIV, 20},
+	{MOD, 20}, {AND, 1}, {OR, 1}, {XOR, 1}, {NOT, 1}, {SHL, 1}, {SHR, 1}, {JMP, 2},
+	{JZ, 2}, {JNZ, 2}, {CALL, 5}, {RET, 5}, {PUSH, 2}, {POP, 2}, {CMP, 1}, {MOV, 1},
+	{LEA, 1}, {INC, 1}, {DEC, 1}, {NEG, 1}, {IN, 50}, {OUT, 50}, {INT, 100}, {IRET, 100}};
+
+// these fail to compile if the table is not built at compile time
+constexpr auto Cycles = sjtu::make_static_map(Init);
+
+static_assert(Cycles.size() == 32, "static_map keeps every element");
+static_assert(Cycles.at(DIV) == 20 && Cycles[IRET] == 100, "at() is evaluated at compile time");
+static_assert(Cycles.count(NOP) == 1 && Cycles.count(IRET + 1) == 0, "count() is evaluated at compile time");
+static_assert(Cycles.find(IRET + 1) == Cycles.end(), "find() of a missing key is end()");
+static_assert(Cycles.lower_bound(-1) == Cycles.begin() && Cycles.lower_bound(IRET + 1) == Cycles.end(), "lower_bound() at both ends");
+static_assert(Cycles.begin()->first == NOP && (Cycles.end() - 1)->first == IRET, "the table is sorted at compile time");
+
+/**
+ * a static_map of N random distinct keys built at run time, then one with a key twice.
+ */
+template <size_t N>
+void fixed(long long keys)
+{
+	std::map<long long, long long> ref;
+	while (ref.size() < N)
+	{
+		long long key = test::below(keys);
+		ref[key] = key * 5;
+	}
+	// in an order other than sorted, which the constructor has to sort
+	sjtu::pair<long long, long long> init[N];
+	size_t i = 0;
+	for (std::map<long long, long long>::iterator it = ref.begin(); it != ref.end(); ++it, i++)
+		init[(i * 7919) % N] = sjtu::pair<long long, long long>(it->first, it->second);
+	sjtu::static_map<long long, long long, N> m(init);
+	CHECK(m.size() == N && !m.empty());
+	std::map<long long, long long>::iterator r = ref.begin();
+	for (typename sjtu::static_map<long long, long long, N>::const_iterator it = m.cbegin(); it != m.cend(); ++it, ++r)
+		CHECK(it->first == r->first && it->second == r->second);
+	for (long long j = 0; j < 2000; j++)
+	{
+		long long key = test::below(keys + 2) - 1;
+		CHECK(m.count(key) == ref.count(key));
+		CHECK(m.lower_bound(key) == m.cbegin() + std::distance(ref.begin(), ref.lower_bound(key)));
+		if (ref.count(key))
+			CHECK(m.at(key) == ref[key] && m[key] == ref[key] && m.find(key)->first == key);
+		else
+		{
+			CHECK(m.find(key) == m.cend());
+			CHECK_THROWS(m.at(key), sjtu::index_out_of_bound);
+		}
+	}
+	if (N > 1)
+	{
+		size_t a = size_t(test::below(N)), b = (a + 1 + size_t(test::below(N - 1))) % N;
+		init[a].first = init[b].first;
+		CHECK_THROWS((sjtu::static_map<long long, long long, N>(init)), sjtu::runtime_error);
+	}
+}
+
+void frozen(long long n, long long keys)
+{
+	for (long long size = 0; size < n && size <= keys; size = size * 2 + 1)
+	{
+		sjtu::map<long long, long long> m;
+		std::map<long long, long long> ref;
+		while ((long long)ref.size() < size)
+		{
+			long long key = test::below(keys);
+			m[key] = key * 3, ref[key] = key * 3;
+		}
+		sjtu::frozen_map<long long, long long, std::less<long long> > f(m), g(f), h(m.freeze());
+		CHECK(f.size() == ref.size() && g.size() == ref.size());
+		std::map<long long, long long>::iterator r = ref.begin();
+		for (sjtu::frozen_map<long long, long long, std::less<long long> >::const_iterator it = g.cbegin(); it != g.cend(); ++it, ++r)
+			CHECK(it->first == r->first && it->second == r->second);
+		// a move leaves the other map empty, and takes the arrays as they are
+		sjtu::frozen_map<long long, long long, std::less<long long> >::const_iterator first = g.cbegin();
+		h = std::move(g);
+		CHECK(g.empty() && g.cbegin() == g.cend() && h.size() == ref.size() && h.cbegin() == first);
+		g = std::move(h);
+		CHECK(h.empty() && g.size() == ref.size() && g.count(size ? ref.begin()->first : 0) == !!size);
+		for (long long i = 0; i < 2000; i++)
+		{
+			long long key = test::below(keys + 2) - 1;
+			std::map<long long, long long>::iterator rlo = ref.lower_bound(key), rup = ref.upper_bound(key);
+			CHECK(f.count(key) == ref.count(key));
+			CHECK(f.lower_bound(key) == f.cbegin() + std::distance(ref.begin(), rlo));
+			CHECK(f.upper_bound(key) == f.cbegin() + std::distance(ref.begin(), rup));
+			if (ref.count(key))
+				CHECK(f.at(key) == ref[key] && f.find(key)->first == key);
+			else
+				CHECK(f.find(key) == f.cend() && !f.find_value(key));
+		}
+	}
+}
+
+/**
+ * merged_view against a std::multimap fed in shard order, which keeps equal keys in the
+ * order they came in, for each duplicate policy.
+ */
+template <class Duplicates>
+void merged(int shards, long long keys)
+{
+	typedef sjtu::map<long long, long long> Map;
+	std::vector<Map> maps(shards);
+	std::multimap<long long, long long> all;
+	for (int s = 0; s < shards; s++)
+	{
+		long long n = test::below(2 * keys / shards + 1);
+		for (long long i = 0; i < n; i++)
+		{
+			long long key = test::below(keys);
+			if (maps[s].insert(Map::value_type(key, s)).second)
+				all.insert(std::make_pair(key, (long long)s));
+		}
+	}
+	sjtu::merged_view<Map, Duplicates> view(maps.begin(), maps.end());
+	std::vector<std::pair<long long, long long> > want;
+	for (std::multimap<long long, long long>::iterator it = all.begin(); it != all.end(); ++it)
+		if (!Duplicates::Unique || want.empty() || want.back().first != it->first)
+			want.push_back(*it);
+		else if (Duplicates::Last)
+			want.back() = *it;
+	for (int round = 0; round < 64; round++)
+	{
+		long long from = round ? test::below(keys + 2) - 1 : -1;
+		typename sjtu::merged_view<Map, Duplicates>::const_iterator it = round % 2 ? view.upper_bound(from) : view.lower_bound(from);
+		size_t i = 0;
+		while (i < want.size() && (want[i].first < from || (round % 2 && want[i].first == from)))
+			i++;
+		for (; i < want.size(); i++, ++it)
+		{
+			CHECK(it != view.end());
+			CHECK(it->first == want[i].first && it->second == want[i].second);
+		}
+		CHECK(it == view.end());
+	}
+}
+
+int main()
+{
+	unordered<sjtu::unordered_map<long long, long long> >(300000, 20000);
+	unordered<sjtu::unordered_map<long long, long long> >(300000, 1 << 30);
+	unordered<sjtu::unordered_map<long long, long long, crowded_hash> >(100000, 2000);
+
+	radix<int>(300000, -5000, 10000);
+	radix<long long>(300000, -(1LL << 40), 1ULL << 41);
+	radix<unsigned>(300000, 0, 1ULL << 32);
+	radix<std::uint8_t>(20000, 0, 256);
+
+	fixed<1>(10);
+	fixed<2>(4);
+	fixed<7>(100);
+	fixed<64>(64);
+	fixed<1000>(100000);
+
+	frozen(5000, 100000);
+	frozen(5000, 50);
+
+	for (int shards : {1, 2, 3, 7, 64})
+	{
+		merged<sjtu::merge_keep_all>(shards, 3000);
+		merged<sjtu::merge_first_wins>(shards, 3000);
+		merged<sjtu::merge_last_wins>(shards, 300);
+	}
+	return 0;
+}
@@ -0,0 +1,18 @@
+// sjtu::map against std::map under every iterator checks policy, with and without the inline
+// small buffer and with the statistics on; dense keys collide often, sparse ones grow the tree.
+
+#include "soak.hpp"
+
+int main()
+{
+	for (int keys : {16, 1000, 1 << 20})
+	{
+		test::soak<sjtu::map<int, int> >(200000, keys);
+		test::soak<sjtu::map<int, int, std::less<int>, sjtu::tree_stats> >(50000, keys);
+		test::soak<sjtu::map<int, int, std::less<int>, sjtu::tree_no_stats, sjtu::checked_iterators> >(200000, keys);
+		test::soak<sjtu::map<int, int, std::less<int>, sjtu::tree_no_stats, sjtu::unchecked_iterators>, false>(200000, keys);
+		test::soak<sjtu::map<int, int, std::less<int>, sjtu::tree_no_stats, sjtu::iterator_checks, sjtu::red_black_balance, sjtu::small_buffer<8> > >(200000, keys);
+		test::soak<sjtu::map<int, int, std::less<int>, sjtu::tree_no_stats, sjtu::checked_iterators, sjtu::red_black_balance, sjtu::small_buffer<8> > >(200000, keys);
+	}
+	return 0;
+}
@@ -0,0 +1,181 @@
+// mapped_map against a std::map kept alongside: inserts, erases and lookups with the file
+// closed and opened again now and then, also read-only, so that every check after a reopen
+// reads what the file kept; and files that are not a map of these types are refused:
+// garbage, a file too short for the header, a map of other key and value types, and a
+// tree with raw pointers set.
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include "test.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+#include "mapped_map.hpp"
+
+typedef sjtu::mapped_map<long long, long long> Mapped;
+
+// an address space of 64 MiB is plenty here, and kinder to the sanitizers than the default
+static const size_t Reserve = size_t(1) << 26;
+
+/**
+ * a new empty file in the temporary directory, removed by the destructor.
+ */
+struct temp_file
+{
+	std::string Path;
+
+	temp_file()
+	{
+		const char *Dir = std::getenv("TMPDIR");
+		Path = std::string(Dir && *Dir ? Dir : "/tmp") + "/sjtu_mapped_map_XXXXXX";
+		int fd = mkstemp(&Path[0]);
+		CHECK(fd >= 0);
+		close(fd);
+	}
+
+	~temp_file() { unlink(Path.c_str()); }
+
+	void write(const std::string &bytes) const
+	{
+		FILE *f = std::fopen(Path.c_str(), "wb");
+		CHECK(f && std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size());
+		std::fclose(f);
+	}
+};
+
+void same(const Mapped &m, const std::map<long long, long long> &ref)
+{
+	CHECK(m.size() == ref.size() && m.empty() == ref.empty());
+	Mapped::const_iterator it = m.cbegin();
+	for (std::map<long long, long long>::const_iterator r = ref.begin(); r != ref.end(); ++r, ++it)
+		CHECK(it != m.cend() && it->first == r->first && it->second == r->second);
+	CHECK(it == m.cend());
+}
+
+void soak(long long ops, long long keys)
+{
+	temp_file f;
+	Mapped m(f.Path.c_str(), false, Reserve);
+	std::map<long long, long long> ref;
+	for (long long i = 0; i < ops; i++)
+	{
+		long long key = test::below(keys), val = test::below(1 << 30);
+		switch (test::below(8))
+		{
+		case 0:
+		case 1:
+			CHECK(m.insert(Mapped::value_type(key, val)).second == ref.insert(std::make_pair(key, val)).second);
+			break;
+		case 2:
+			m[key] = val, ref[key] = val;
+			break;
+		case 3:
+		case 4:
+		{
+			Mapped::iterator it = m.find(key);
+			CHECK((it == m.end()) == !ref.count(key) && m.count(key) == ref.count(key));
+			if (it != m.end())
+			{
+				CHECK(it->second == ref[key] && m.at(key) == ref[key]);
+				m.erase(it), ref.erase(key);
+			}
+			else
+				CHECK_THROWS(m.at(key), sjtu::index_out_of_bound);
+			break;
+		}
+		default:
+			if (test::below(500) == 0)
+			{
+				// what a reader opened afterwards sees, then the writer again
+				m.sync();
+				m.close();
+				CHECK(!m.is_open());
+				{
+					Mapped r(f.Path.c_str(), true);
+					same(r, ref);
+					CHECK_THROWS(r[key] = 1, sjtu::runtime_error);
+					CHECK_THROWS(r.clear(), sjtu::runtime_error);
+				}
+				m.open(f.Path.c_str(), false, Reserve);
+				same(m, ref);
+			}
+			else if (test::below(3000) == 0)
+				m.clear(), ref.clear();
+			break;
+		}
+		if (i % 4096 == 0)
+			same(m, ref);
+	}
+	same(m, ref);
+}
+
+/**
+ * open() refuses whatever is not a map of these types, and leaves the map closed.
+ */
+void refused()
+{
+	temp_file f;
+	{
+		Mapped m(f.Path.c_str(), false, Reserve);
+		for (long long i = 0; i < 1000; i++)
+			m[i] = i * i;
+	}
+
+	// the same file as another map type
+	typedef sjtu::mapped_map<int, long long> Other;
+	Other o;
+	CHECK_THROWS(o.open(f.Path.c_str(), false, Reserve), sjtu::runtime_error);
+	CHECK(!o.is_open());
+
+	// the map itself is still fine
+	{
+		Mapped m(f.Path.c_str(), true);
+		CHECK(m.size() == 1000 && m.at(999) == 999 * 999);
+	}
+
+	// a valid header over a scrambled tree, whose raw pointers are not null;
+	// the tree starts 64 bytes in, on the cache line after the header
+	{
+		std::string Bytes;
+		FILE *in = std::fopen(f.Path.c_str(), "rb");
+		CHECK(in);
+		for (int c; (c = std::fgetc(in)) != EOF;)
+			Bytes += char(c);
+		std::fclose(in);
+		for (size_t i = 64; i < 512; i++)
+			Bytes[i] = char(test::below(255) + 1);
+		f.write(Bytes);
+		Mapped m;
+		CHECK_THROWS(m.open(f.Path.c_str(), false, Reserve), sjtu::runtime_error);
+		CHECK_THROWS(m.open(f.Path.c_str(), true), sjtu::runtime_error);
+	}
+
+	Mapped m;
+	f.write(std::string(10, 'S'));
+	CHECK_THROWS(m.open(f.Path.c_str(), false, Reserve), sjtu::runtime_error);
+	CHECK(!m.is_open());
+
+	std::string Garbage(1 << 16, '\0');
+	for (size_t i = 0; i < Garbage.size(); i++)
+		Garbage[i] = char(test::below(256));
+	f.write(Garbage);
+	CHECK_THROWS(m.open(f.Path.c_str(), false, Reserve), sjtu::runtime_error);
+	CHECK_THROWS(m.open(f.Path.c_str(), true), sjtu::runtime_error);
+	CHECK(!m.is_open());
+
+	// a missing file is not created by a reader
+	unlink(f.Path.c_str());
+	CHECK_THROWS(m.open(f.Path.c_str(), true), sjtu::runtime_error);
+	CHECK(access(f.Path.c_str(), F_OK) != 0);
+}
+
+int main()
+{
+	soak(100000, 100);
+	soak(200000, 1 << 20);
+	refused();
+	return 0;
+}
@@ -0,0 +1,44 @@
+// parallel_for_each and parallel_reduce against a sequential loop, for several pool sizes:
+// an init that is not neutral is taken once, and a reduction that is not commutative
+// (the concatenation of strings) still sees the values in key order.
+
+#include <functional>
+#include <string>
+#include "test.hpp"
+#include "map.hpp"
+#include "parallel.hpp"
+
+int main()
+{
+	for (long long n : {0LL, 1LL, 100LL, 5000LL, 300000LL})
+		for (unsigned threads : {1u, 3u, 8u})
+		{
+			sjtu::work_stealing_pool pool(threads);
+			sjtu::map<long long, long long> m;
+			for (long long i = 0; i < n; i++)
+				m[test::below(4 * n)] = test::below(1000) - 500;
+
+			long long sum = 1000000, count = 0;
+			for (sjtu::map<long long, long long>::const_iterator it = m.cbegin(); it != m.cend(); ++it)
+				sum += it->second, count++;
+			CHECK(sjtu::parallel_reduce(m, 1000000LL, std::plus<long long>(), pool) == sum);
+			CHECK(sjtu::parallel_reduce(
+					  m, 0LL, [](long long acc, const sjtu::map<long long, long long>::value_type &) { return acc + 1; },
+					  std::plus<long long>(), pool) == count);
+
+			sjtu::map<long long, std::string> s;
+			std::string all = "init:";
+			for (sjtu::map<long long, long long>::const_iterator it = m.cbegin(); it != m.cend(); ++it)
+			{
+				s[it->first] = std::to_string(it->first) + ",";
+				all += s[it->first];
+			}
+			CHECK(sjtu::parallel_reduce(s, std::string("init:"), std::plus<std::string>(), pool) == all);
+
+			sjtu::parallel_for_each(m, [](sjtu::map<long long, long long>::value_type &v) { v.second = v.first * 2; }, pool);
+			for (sjtu::map<long long, long long>::const_iterator it = m.cbegin(); it != m.cend(); ++it)
+				CHECK(it->second == it->first * 2);
+			CHECK(m.validate());
+		}
+	return 0;
+}
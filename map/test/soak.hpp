@@ -0,0 +1,145 @@
+#ifndef SJTU_TEST_SOAK_HPP
+#define SJTU_TEST_SOAK_HPP
+
+// the differential soak of sjtu::map against std::map, shared by the tests of the policies:
+// random operations on both, validate() every few steps, a full comparison now and then.
+
+#include <map>
+#include "test.hpp"
+#include "exceptions.hpp"
+#include "map.hpp"
+
+namespace test
+{
+	/**
+	 * every element of m and ref, in both directions, and the structure of m.
+	 */
+	template <class Map>
+	void same(const Map &m, const std::map<int, int> &ref)
+	{
+		CHECK(m.validate());
+		CHECK(m.size() == ref.size());
+		CHECK(m.empty() == ref.empty());
+		typename Map::const_iterator it = m.cbegin();
+		for (std::map<int, int>::const_iterator r = ref.begin(); r != ref.end(); ++r, ++it)
+		{
+			CHECK(it != m.cend());
+			CHECK(it->first == r->first && it->second == r->second);
+		}
+		CHECK(it == m.cend());
+		for (std::map<int, int>::const_reverse_iterator r = ref.rbegin(); r != ref.rend(); ++r)
+		{
+			--it;
+			CHECK(it->first == r->first && it->second == r->second);
+		}
+		CHECK(it == m.cbegin());
+	}
+
+	/**
+	 * ops random operations on keys in [0, keys), checking every result against std::map;
+	 * Bounds is false for unchecked_iterators, whose bad iterators are not caught.
+	 */
+	template <class Map, bool Bounds = true>
+	void soak(long long ops, int keys)
+	{
+		Map m;
+		std::map<int, int> ref;
+		for (long long i = 0; i < ops; i++)
+		{
+			int key = int(below(keys)), val = int(below(1 << 30));
+			switch (below(12))
+			{
+			case 0:
+			case 1:
+			{
+				sjtu::pair<typename Map::iterator, bool> ans = m.insert(typename Map::value_type(key, val));
+				std::pair<std::map<int, int>::iterator, bool> want = ref.insert(std::make_pair(key, val));
+				CHECK(ans.second == want.second);
+				CHECK(ans.first->first == key && ans.first->second == want.first->second);
+				break;
+			}
+			case 2:
+			{
+				// a finger insert from a neighbour of the key, or from a random place
+				typename Map::const_iterator hint = below(4) ? typename Map::const_iterator(m.lower_bound(key)) : m.cbegin();
+				typename Map::iterator it = m.insert(hint, typename Map::value_type(key, val));
+				std::pair<std::map<int, int>::iterator, bool> want = ref.insert(std::make_pair(key, val));
+				CHECK(it->first == key && it->second == want.first->second);
+				break;
+			}
+			case 3:
+			case 4:
+			{
+				typename Map::iterator it = m.find(key);
+				CHECK((it == m.end()) == !ref.count(key));
+				if (it != m.end())
+					m.erase(it), ref.erase(key);
+				break;
+			}
+			case 5:
+				m[key] = val, ref[key] = val;
+				break;
+			case 6:
+				if (ref.count(key))
+					CHECK(m.at(key) == ref.at(key));
+				else
+					CHECK_THROWS(m.at(key), sjtu::index_out_of_bound);
+				CHECK(m.count(key) == ref.count(key));
+				break;
+			case 7:
+			{
+				typename Map::iterator lo = m.lower_bound(key), hi = m.upper_bound(key);
+				std::map<int, int>::iterator rlo = ref.lower_bound(key), rhi = ref.upper_bound(key);
+				CHECK((lo == m.end()) == (rlo == ref.end()));
+				CHECK(lo == m.end() || lo->first == rlo->first);
+				CHECK((hi == m.end()) == (rhi == ref.end()));
+				CHECK(hi == m.end() || hi->first == rhi->first);
+				break;
+			}
+			case 8:
+				if (!m.empty())
+				{
+					typename Map::iterator e = m.end();
+					CHECK((--e)->first == ref.rbegin()->first);
+				}
+				if (Bounds)
+					CHECK_THROWS(m.erase(m.end()), sjtu::invalid_iterator);
+				break;
+			case 9:
+			{
+				// the copy is checked on its own, changed, and must not touch the original;
+				// rarer on big maps, it costs O(n)
+				if (below(int(m.size() / 64) + 1))
+					break;
+				Map c(m);
+				same(c, ref);
+				c[key] = val + 1;
+				if (below(2))
+				{
+					Map d;
+					d = c;
+					d = m;
+					same(d, ref);
+					m = c;
+					ref[key] = val + 1;
+				}
+				break;
+			}
+			case 10:
+				m.compact(below(64));
+				break;
+			default:
+				if (below(1000) == 0)
+					m.clear(), ref.clear();
+				break;
+			}
+			if (i % 64 == 0)
+				CHECK(m.validate());
+			if (i % 4096 == 0)
+				same(m, ref);
+		}
+		same(m, ref);
+	}
+}
+
+#endif
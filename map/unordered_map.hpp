@@ -0,0 +1,439 @@
+#ifndef SJTU_UNORDERED_MAP_HPP
+#define SJTU_UNORDERED_MAP_HPP
+
+// a hash map with the interface of sjtu::map, without ordered iteration.
+
+#include <functional>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu
+{
+	/**
+	 * open addressing with Robin Hood probing.
+	 * every slot remembers how far it is from its home slot, an insertion takes the slot
+	 * of any element closer to home than itself, so probe lengths stay short and even,
+	 * and a lookup stops as soon as it meets an element closer to home than the key would be.
+	 * erase shifts the following elements one slot back instead of leaving a tombstone.
+	 *
+	 * insert and erase move elements: they invalidate iterators, pointers and references.
+	 */
+	template <
+		class Key,
+		class T,
+		class Hash = std::hash<Key>,
+		class KeyEqual = std::equal_to<Key> >
+	class unordered_map
+	{
+	public:
+		typedef pair<const Key, T> value_type;
+
+	private:
+		value_type *Data;
+		unsigned *Dist; // 0 for an empty slot, otherwise 1 + the distance from the home slot
+		size_t Cap, Size;
+		int Bits;
+		float MaxLoad;
+		Hash hash;
+		KeyEqual eq;
+
+		/**
+		 * a full table would make a probe for a missing key endless, and a load of 0 or less
+		 * would never fit an element.
+		 */
+		static float checked_load(float max_load)
+		{
+			if (!(max_load > 0 && max_load < 1))
+				throw runtime_error("max_load_factor must be in (0, 1)");
+			return max_load;
+		}
+
+		/**
+		 * fibonacci hashing: spreads weak hashes such as the identity of std::hash<int> over the table.
+		 */
+		size_t home(const Key &key) const
+		{
+			return size_t((unsigned long long)hash(key) * 0x9E3779B97F4A7C15ull >> (64 - Bits));
+		}
+
+		size_t next(size_t i) const { return (i + 1) & (Cap - 1); }
+
+		size_t locate(const Key &key) const
+		{
+			if (!Size)
+				return Cap;
+			size_t i = home(key);
+			for (unsigned d = 1; Dist[i] >= d; i = next(i), d++)
+				if (Dist[i] == d && eq(Data[i].first, key))
+					return i;
+			return Cap;
+		}
+
+		static void relocate(value_type *dst, value_type *src)
+		{
+			new (dst) value_type(std ::move(*src));
+			src->~value_type();
+		}
+
+		void allocate(int _Bits)
+		{
+			Bits = _Bits;
+			Cap = size_t(1) << Bits;
+			Data = static_cast<value_type *>(::operator new(Cap * sizeof(value_type)));
+			Dist = new unsigned[Cap]();
+		}
+
+		void release()
+		{
+			for (size_t i = 0; i < Cap; i++)
+				if (Dist[i])
+					Data[i].~value_type();
+			::operator delete(Data);
+			delete[] Dist;
+			Data = nullptr;
+			Dist = nullptr;
+			Cap = Size = 0;
+		}
+
+		/**
+		 * put an element known to be absent, moving it out of *v (which is destroyed).
+		 * return the slot it ends in.
+		 */
+		size_t place(value_type *v)
+		{
+			size_t i = home(v->first), ans = Cap;
+			unsigned d = 1;
+			alignas(value_type) unsigned char Buf[sizeof(value_type)];
+			value_type *Carry = reinterpret_cast<value_type *>(Buf);
+			relocate(Carry, v);
+
+			for (;; i = next(i), d++)
+			{
+				if (!Dist[i])
+				{
+					relocate(Data + i, Carry);
+					Dist[i] = d;
+					Size++;
+					return ans == Cap ? i : ans;
+				}
+				if (Dist[i] < d)
+				{
+					alignas(value_type) unsigned char TmpBuf[sizeof(value_type)];
+					value_type *Tmp = reinterpret_cast<value_type *>(TmpBuf);
+					relocate(Tmp, Data + i);
+					relocate(Data + i, Carry);
+					relocate(Carry, Tmp);
+					std ::swap(Dist[i], d);
+					if (ans == Cap)
+						ans = i;
+				}
+			}
+		}
+
+		void rehash_to(int _Bits)
+		{
+			value_type *OldData = Data;
+			unsigned *OldDist = Dist;
+			size_t OldCap = Cap;
+
+			allocate(_Bits);
+			Size = 0;
+			for (size_t i = 0; i < OldCap; i++)
+				if (OldDist[i])
+					place(OldData + i);
+
+			::operator delete(OldData);
+			delete[] OldDist;
+		}
+
+		void reserve_one()
+		{
+			if (!Cap)
+				allocate(3);
+			else if (Size + 1 > MaxLoad * Cap)
+				rehash_to(Bits + 1);
+		}
+
+		size_t insert_absent(const Key &key, const T &val)
+		{
+			reserve_one();
+			alignas(value_type) unsigned char Buf[sizeof(value_type)];
+			return place(new (Buf) value_type(key, val));
+		}
+
+		void erase_at(size_t i)
+		{
+			Data[i].~value_type();
+			Size--;
+			for (size_t j = next(i); Dist[j] > 1; i = j, j = next(j))
+			{
+				relocate(Data + i, Data + j);
+				Dist[i] = Dist[j] - 1;
+			}
+			Dist[i] = 0;
+		}
+
+		void copy_from(const unordered_map &other)
+		{
+			MaxLoad = other.MaxLoad;
+			hash = other.hash;
+			eq = other.eq;
+			if (!other.Cap)
+				return;
+			allocate(other.Bits);
+			for (size_t i = 0; i < Cap; i++)
+				if ((Dist[i] = other.Dist[i]))
+					new (Data + i) value_type(other.Data[i]);
+			Size = other.Size;
+		}
+
+	public:
+		class const_iterator;
+		class iterator
+		{
+			friend class unordered_map;
+
+		private:
+			unordered_map *Belong;
+			size_t Pos;
+
+			void skip()
+			{
+				while (Pos < Belong->Cap && !Belong->Dist[Pos])
+					Pos++;
+			}
+
+		public:
+			iterator() : Belong(nullptr), Pos(0) {}
+
+			iterator(unordered_map *_Belong, size_t _Pos) : Belong(_Belong), Pos(_Pos) {}
+
+			iterator operator++(int)
+			{
+				iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+
+			iterator &operator++()
+			{
+				if (!Belong || Pos >= Belong->Cap)
+					throw invalid_iterator();
+				Pos++;
+				skip();
+				return *this;
+			}
+
+			value_type &operator*() const { return Belong->Data[Pos]; }
+
+			bool operator==(const iterator &rhs) const { return Pos == rhs.Pos && Belong == rhs.Belong; }
+
+			bool operator==(const const_iterator &rhs) const { return Pos == rhs.Pos && Belong == rhs.Belong; }
+
+			bool operator!=(const iterator &rhs) const { return Pos != rhs.Pos || Belong != rhs.Belong; }
+
+			bool operator!=(const const_iterator &rhs) const { return Pos != rhs.Pos || Belong != rhs.Belong; }
+
+			value_type *operator->() const noexcept { return Belong->Data + Pos; }
+		};
+		class const_iterator
+		{
+			friend class unordered_map;
+
+		private:
+			const unordered_map *Belong;
+			size_t Pos;
+
+			void skip()
+			{
+				while (Pos < Belong->Cap && !Belong->Dist[Pos])
+					Pos++;
+			}
+
+		public:
+			const_iterator() : Belong(nullptr), Pos(0) {}
+
+			const_iterator(const unordered_map *_Belong, size_t _Pos) : Belong(_Belong), Pos(_Pos) {}
+
+			const_iterator(const iterator &other) : Belong(other.Belong), Pos(other.Pos) {}
+
+			const_iterator operator++(int)
+			{
+				const_iterator tmp = *this;
+				++*this;
+				return tmp;
+			}
+
+			const_iterator &operator++()
+			{
+				if (!Belong || Pos >= Belong->Cap)
+					throw invalid_iterator();
+				Pos++;
+				skip();
+				return *this;
+			}
+
+			const value_type &operator*() const { return Belong->Data[Pos]; }
+
+			bool operator==(const iterator &rhs) const { return Pos == rhs.Pos && Belong == rhs.Belong; }
+
+			bool operator==(const const_iterator &rhs) const { return Pos == rhs.Pos && Belong == rhs.Belong; }
+
+			bool operator!=(const iterator &rhs) const { return Pos != rhs.Pos || Belong != rhs.Belong; }
+
+			bool operator!=(const const_iterator &rhs) const { return Pos != rhs.Pos || Belong != rhs.Belong; }
+
+			const value_type *operator->() const noexcept { return Belong->Data + Pos; }
+		};
+
+		/**
+		 * nothing is allocated until the first insertion.
+		 * max_load is the fraction of slots that may be used before the table doubles,
+		 * throw runtime_error unless it is in (0, 1).
+		 */
+		explicit unordered_map(float max_load = 0.8f) : Data(nullptr), Dist(nullptr), Cap(0), Size(0), Bits(0), MaxLoad(checked_load(max_load)) {}
+
+		unordered_map(const unordered_map &other) : Data(nullptr), Dist(nullptr), Cap(0), Size(0), Bits(0)
+		{
+			copy_from(other);
+		}
+
+		unordered_map &operator=(const unordered_map &other)
+		{
+			if (this == &other)
+				return *this;
+			release();
+			copy_from(other);
+			return *this;
+		}
+
+		~unordered_map() { release(); }
+
+		T &at(const Key &key)
+		{
+			size_t i = locate(key);
+			if (i == Cap)
+				throw index_out_of_bound();
+			return Data[i].second;
+		}
+
+		const T &at(const Key &key) const
+		{
+			size_t i = locate(key);
+			if (i == Cap)
+				throw index_out_of_bound();
+			return Data[i].second;
+		}
+
+		T &operator[](const Key &key)
+		{
+			size_t i = locate(key);
+			if (i == Cap)
+				i = insert_absent(key, T());
+			return Data[i].second;
+		}
+
+		const T &operator[](const Key &key) const
+		{
+			return at(key);
+		}
+
+		iterator begin()
+		{
+			iterator it(this, 0);
+			it.skip();
+			return it;
+		}
+
+		const_iterator cbegin() const
+		{
+			const_iterator it(this, 0);
+			it.skip();
+			return it;
+		}
+
+		iterator end() { return iterator(this, Cap); }
+
+		const_iterator cend() const { return const_iterator(this, Cap); }
+
+		bool empty() const { return !Size; }
+
+		size_t size() const { return Size; }
+
+		void clear() { release(); }
+
+		/**
+		 * the load factor: elements per slot.
+		 */
+		float load_factor() const { return Cap ? float(Size) / Cap : 0; }
+
+		float max_load_factor() const { return MaxLoad; }
+
+		/**
+		 * change the maximal load factor, growing the table at once if it is exceeded.
+		 * values up to about 0.9 keep Robin Hood probes short.
+		 * throw runtime_error unless max_load is in (0, 1).
+		 */
+		void max_load_factor(float max_load)
+		{
+			MaxLoad = checked_load(max_load);
+			reserve(Size);
+		}
+
+		/**
+		 * make room for n elements without further rehashing.
+		 */
+		void reserve(size_t n)
+		{
+			int b = 3;
+			while (n > MaxLoad * (size_t(1) << b))
+				b++;
+			if (b > Bits)
+			{
+				if (Cap)
+					rehash_to(b);
+				else
+					allocate(b);
+			}
+		}
+
+		pair<iterator, bool> insert(const value_type &value)
+		{
+			size_t i = locate(value.first);
+			if (i != Cap)
+				return pair<iterator, bool>(iterator(this, i), false);
+			i = insert_absent(value.first, value.second);
+			return pair<iterator, bool>(iterator(this, i), true);
+		}
+
+		/**
+		 * throw invalid_iterator if pos does not point to an element of this.
+		 */
+		void erase(iterator pos)
+		{
+			if (pos.Belong != this || pos.Pos >= Cap || !Dist[pos.Pos])
+				throw invalid_iterator();
+			erase_at(pos.Pos);
+		}
+
+		size_t count(const Key &key) const
+		{
+			return locate(key) != Cap;
+		}
+
+		iterator find(const Key &key)
+		{
+			return iterator(this, locate(key));
+		}
+
+		const_iterator find(const Key &key) const
+		{
+			return const_iterator(this, locate(key));
+		}
+	};
+}
+
+#endif
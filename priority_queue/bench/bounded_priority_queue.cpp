@@ -0,0 +1,120 @@
+// keeping the K = 1000 greatest elements of a stream of n random values:
+// bounded_priority_queue, a sjtu::priority_queue of the whole stream popped down to K,
+// and a reversed sjtu::priority_queue trimmed after every push.
+// the peak heap memory is reported next to the time, pass --max-n 1000000000 for the 1e9 stream.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "bounded_priority_queue.hpp"
+#include "priority_queue.hpp"
+
+static std::atomic<long long> Live(0), Peak(0);
+
+void *operator new(std::size_t n)
+{
+	void *p = std::malloc(n + 16);
+	if (!p)
+		throw std::bad_alloc();
+	*static_cast<std::size_t *>(p) = n;
+	long long now = Live += n;
+	if (now > Peak)
+		Peak = now;
+	return static_cast<char *>(p) + 16;
+}
+
+void operator delete(void *p) noexcept
+{
+	if (!p)
+		return;
+	p = static_cast<char *>(p) - 16;
+	Live -= *static_cast<std::size_t *>(p);
+	std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept { operator delete(p); }
+
+const size_t K = 1000;
+
+/**
+ * the stream is generated on the fly, so it takes no memory itself.
+ */
+struct stream
+{
+	unsigned long long State;
+
+	stream() : State(19260817) {}
+
+	long long next()
+	{
+		State ^= State << 13, State ^= State >> 7, State ^= State << 17;
+		return (long long)(State >> 1);
+	}
+};
+
+/**
+ * time one pass over the stream and record the peak of live heap memory above the start.
+ */
+template <class F>
+void run(const bench::options &opt, long long n, const char *impl, F body)
+{
+	long long Bytes = 0;
+	double ns = bench::measure(opt, n, [&] {
+		long long Base = Live;
+		Peak = Base;
+		body();
+		Bytes = Peak - Base;
+	});
+	bench::report("bounded_priority_queue", "top_k", impl, "int64", "uniform", n, ns, "peak_bytes", double(Bytes));
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	if (!opt.wants("top_k"))
+		return 0;
+	for (long long n : opt.sizes())
+	{
+		run(opt, n, "sjtu::bounded_priority_queue", [&] {
+			sjtu::bounded_priority_queue<long long> q(K);
+			stream s;
+			for (long long i = 0; i < n; i++)
+				q.push(s.next());
+			std::vector<long long> out;
+			out.reserve(K);
+			q.sorted_results(std::back_inserter(out));
+			bench::keep(out[0]);
+		});
+
+		run(opt, n, "sjtu::priority_queue/trimmed", [&] {
+			sjtu::priority_queue<long long, std::greater<long long> > q;
+			stream s;
+			for (long long i = 0; i < n; i++)
+			{
+				q.push(s.next());
+				if (q.size() > K)
+					q.pop();
+			}
+			bench::keep(q.top());
+		});
+
+		// holding the whole stream needs about 24 bytes per element
+		if (n <= 10000000)
+			run(opt, n, "sjtu::priority_queue/whole", [&] {
+				sjtu::priority_queue<long long> q;
+				stream s;
+				for (long long i = 0; i < n; i++)
+					q.push(s.next());
+				std::vector<long long> out;
+				for (size_t i = 0; i < K && !q.empty(); i++)
+					out.push_back(q.top()), q.pop();
+				bench::keep(out[0]);
+			});
+	}
+	return 0;
+}
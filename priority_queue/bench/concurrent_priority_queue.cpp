@@ -0,0 +1,168 @@
+// multi-producer multi-consumer throughput of concurrent_priority_queue: p producers push n
+// elements in all while p consumers pop them until the queue is closed. one element per lock
+// (push / pop_wait) against batches of 256 (push_batch of a local queue / pop_batch), with a
+// std::priority_queue behind a mutex and a condition variable as the baseline.
+
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.hpp"
+#include "concurrent_priority_queue.hpp"
+#include "exceptions.hpp"
+
+const size_t Batch = 256;
+
+typedef sjtu::concurrent_priority_queue<long long> Queue;
+
+/**
+ * the usual hand-written blocking queue.
+ */
+class locked_std_queue
+{
+	std::priority_queue<long long> Q;
+	std::mutex Lock;
+	std::condition_variable NotEmpty;
+	bool Closed = false;
+
+public:
+	void push(long long x)
+	{
+		{
+			std::lock_guard<std::mutex> Guard(Lock);
+			Q.push(x);
+		}
+		NotEmpty.notify_one();
+	}
+
+	bool pop_wait(long long &out)
+	{
+		std::unique_lock<std::mutex> Guard(Lock);
+		NotEmpty.wait(Guard, [this] { return !Q.empty() || Closed; });
+		if (Q.empty())
+			return false;
+		out = Q.top();
+		Q.pop();
+		return true;
+	}
+
+	void close()
+	{
+		{
+			std::lock_guard<std::mutex> Guard(Lock);
+			Closed = true;
+		}
+		NotEmpty.notify_all();
+	}
+};
+
+/**
+ * producer t pushes vals[t], the consumers pop until close(); return the sum popped.
+ */
+template <class Q, class Produce, class Consume>
+long long run_threads(Q &q, unsigned p, Produce produce, Consume consume)
+{
+	std::vector<std::thread> producers, consumers;
+	std::vector<long long> sums(p, 0);
+	for (unsigned t = 0; t < p; t++)
+		consumers.emplace_back([&, t] { sums[t] = consume(q); });
+	for (unsigned t = 0; t < p; t++)
+		producers.emplace_back([&, t] { produce(q, t); });
+	for (std::thread &th : producers)
+		th.join();
+	q.close();
+	for (std::thread &th : consumers)
+		th.join();
+	long long ans = 0;
+	for (long long s : sums)
+		ans += s;
+	return ans;
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	unsigned most = std::max(1u, std::thread::hardware_concurrency());
+	for (long long n : opt.sizes())
+	{
+		std::vector<long long> all = bench::make_keys<long long>("uniform", n);
+		for (unsigned p = 1; p <= 4; p *= 2)
+		{
+			if (p > 1 && p > most)
+				break;
+			std::string op = "mpmc_" + std::to_string(p) + "x" + std::to_string(p);
+			if (!opt.wants(op))
+				continue;
+			std::vector<std::vector<long long> > vals(p);
+			for (long long i = 0; i < n; i++)
+				vals[i % p].push_back(all[i]);
+
+			double ns = bench::measure(opt, n, [&] {
+				locked_std_queue q;
+				bench::keep(run_threads(
+					q, p,
+					[&](locked_std_queue &q, unsigned t) {
+						for (long long x : vals[t])
+							q.push(x);
+					},
+					[](locked_std_queue &q) {
+						long long x, sum = 0;
+						while (q.pop_wait(x))
+							sum += x;
+						return sum;
+					}));
+			});
+			bench::report("concurrent_priority_queue", op.c_str(), "std::priority_queue+mutex", "int64", "uniform", n, ns);
+
+			ns = bench::measure(opt, n, [&] {
+				Queue q;
+				bench::keep(run_threads(
+					q, p,
+					[&](Queue &q, unsigned t) {
+						for (long long x : vals[t])
+							q.push(x);
+					},
+					[](Queue &q) {
+						long long x, sum = 0;
+						while (q.pop_wait(x))
+							sum += x;
+						return sum;
+					}));
+			});
+			bench::report("concurrent_priority_queue", op.c_str(), "sjtu::concurrent_priority_queue", "int64", "uniform", n, ns);
+
+			ns = bench::measure(opt, n, [&] {
+				Queue q;
+				bench::keep(run_threads(
+					q, p,
+					[&](Queue &q, unsigned t) {
+						Queue::local_queue local;
+						for (long long x : vals[t])
+						{
+							local.push(x);
+							if (local.size() == Batch)
+								q.push_batch(local);
+						}
+						q.push_batch(local);
+					},
+					[](Queue &q) {
+						std::vector<long long> out;
+						out.reserve(Batch);
+						long long sum = 0;
+						while (q.pop_batch(Batch, std::back_inserter(out)))
+						{
+							for (long long x : out)
+								sum += x;
+							out.clear();
+						}
+						return sum;
+					}));
+			});
+			bench::report("concurrent_priority_queue", op.c_str(), "sjtu::concurrent_priority_queue/batch", "int64", "uniform", n, ns);
+		}
+	}
+	return 0;
+}
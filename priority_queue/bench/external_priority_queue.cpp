@@ -0,0 +1,60 @@
+// external_priority_queue with a memory budget of a tenth of the data, against in-memory queues
+// holding everything. every element is pushed then popped, the bytes written to disk per element
+// are reported next to the time. the temporary files go to $TMPDIR or /tmp.
+
+#include <queue>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "external_priority_queue.hpp"
+#include "priority_queue.hpp"
+
+template <class Queue>
+void push_pop(Queue &q, const std::vector<long long> &vals)
+{
+	for (long long x : vals)
+		q.push(x);
+	long long sum = 0;
+	while (!q.empty())
+		sum += q.top(), q.pop();
+	bench::keep(sum);
+}
+
+template <class Queue>
+void run_memory(const bench::options &opt, const std::vector<long long> &vals, const char *impl, const char *dist)
+{
+	long long n = (long long)vals.size();
+	double ns = bench::measure(opt, n, [&] {
+		Queue q;
+		push_pop(q, vals);
+	});
+	bench::report("external_priority_queue", "push_pop", impl, "int64", dist, n, ns);
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	if (!opt.wants("push_pop"))
+		return 0;
+	for (const char *dist : bench::dists)
+		for (long long n : opt.sizes())
+		{
+			std::vector<long long> vals = bench::make_keys<long long>(dist, n);
+			size_t Budget = n * sizeof(long long) / 10;
+			if (Budget < (64 << 10))
+				Budget = 64 << 10;
+
+			unsigned long long Spilled = 0;
+			double ns = bench::measure(opt, n, [&] {
+				sjtu::external_priority_queue<long long> q(Budget);
+				push_pop(q, vals);
+				Spilled = q.spilled_bytes();
+			});
+			bench::report("external_priority_queue", "push_pop", "sjtu::external_priority_queue", "int64", dist, n, ns,
+						  "disk_bytes_per_element", double(Spilled) / n);
+
+			run_memory<sjtu::priority_queue<long long> >(opt, vals, "sjtu::priority_queue", dist);
+			run_memory<std::priority_queue<long long> >(opt, vals, "std::priority_queue", dist);
+		}
+	return 0;
+}
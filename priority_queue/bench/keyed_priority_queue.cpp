@@ -0,0 +1,102 @@
+// 8-byte keys carrying 256-byte payloads: keyed_priority_queue, which keeps the payloads out of
+// the heap, against sjtu::priority_queue and std::priority_queue holding the whole element.
+// "hold" is the classic event-queue loop: pop the top and push an element a bit later.
+
+#include <queue>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+#include "keyed_priority_queue.hpp"
+
+struct event
+{
+	long long Time;
+	char Payload[256];
+
+	bool operator<(const event &rhs) const { return Time > rhs.Time; }
+};
+
+struct by_time
+{
+	long long operator()(const event &e) const { return e.Time; }
+};
+
+typedef sjtu::keyed_priority_queue<event, by_time, std::greater<long long> > Keyed;
+
+template <class Queue>
+void run(const bench::options &opt, const char *impl)
+{
+	for (const char *dist : bench::dists)
+		for (long long n : opt.sizes())
+		{
+			std::vector<long long> order = bench::make_order(dist, n);
+			std::vector<event> vals(n);
+			for (long long i = 0; i < n; i++)
+			{
+				vals[i].Time = order[i];
+				vals[i].Payload[0] = char(i);
+			}
+			Queue full;
+			for (long long i = 0; i < n; i++)
+				full.push(vals[i]);
+
+			if (opt.wants("push"))
+			{
+				Queue *q = nullptr;
+				double ns = bench::measure(
+					opt, n, [&] { delete q; q = new Queue(); },
+					[&] {
+						for (long long i = 0; i < n; i++)
+							q->push(vals[i]);
+					});
+				delete q;
+				bench::report("keyed_priority_queue", "push", impl, "int64+256B", dist, n, ns);
+			}
+
+			if (opt.wants("pop"))
+			{
+				Queue *q = nullptr;
+				double ns = bench::measure(
+					opt, n, [&] { delete q; q = new Queue(full); },
+					[&] {
+						long long sum = 0;
+						for (long long i = 0; i < n; i++)
+						{
+							sum += q->top().Payload[0];
+							q->pop();
+						}
+						bench::keep(sum);
+					});
+				delete q;
+				bench::report("keyed_priority_queue", "pop", impl, "int64+256B", dist, n, ns);
+			}
+
+			if (opt.wants("hold"))
+			{
+				Queue *q = nullptr;
+				double ns = bench::measure(
+					opt, n, [&] { delete q; q = new Queue(full); },
+					[&] {
+						for (long long i = 0; i < n; i++)
+						{
+							event e = q->top();
+							q->pop();
+							e.Time += order[i] + 1;
+							q->push(e);
+						}
+					});
+				delete q;
+				bench::report("keyed_priority_queue", "hold", impl, "int64+256B", dist, n, ns);
+			}
+		}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	run<Keyed>(opt, "sjtu::keyed_priority_queue");
+	run<sjtu::priority_queue<event> >(opt, "sjtu::priority_queue");
+	run<std::priority_queue<event> >(opt, "std::priority_queue");
+	return 0;
+}
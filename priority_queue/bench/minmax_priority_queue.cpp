@@ -0,0 +1,150 @@
+// minmax_priority_queue against the pair of mirrored sjtu::priority_queues it replaces.
+// the mirrored pair tags every element with an id and skips the ones already popped from the other side.
+
+#include <functional>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "minmax_priority_queue.hpp"
+#include "priority_queue.hpp"
+#include "utility.hpp"
+
+typedef sjtu::pair<long long, long long> tagged;
+
+struct tagged_less
+{
+	bool operator()(const tagged &a, const tagged &b) const { return a.first < b.first; }
+};
+
+struct tagged_greater
+{
+	bool operator()(const tagged &a, const tagged &b) const { return a.first > b.first; }
+};
+
+struct mirrored
+{
+	sjtu::priority_queue<tagged, tagged_less> Max;
+	sjtu::priority_queue<tagged, tagged_greater> Min;
+	std::vector<bool> Dead;
+
+	void push(long long x)
+	{
+		tagged t(x, (long long)Dead.size());
+		Dead.push_back(false);
+		Max.push(t);
+		Min.push(t);
+	}
+
+	long long pop_min()
+	{
+		while (Dead[Min.top().second])
+			Min.pop();
+		tagged t = Min.top();
+		Min.pop();
+		Dead[t.second] = true;
+		return t.first;
+	}
+
+	long long pop_max()
+	{
+		while (Dead[Max.top().second])
+			Max.pop();
+		tagged t = Max.top();
+		Max.pop();
+		Dead[t.second] = true;
+		return t.first;
+	}
+};
+
+void push_one(sjtu::minmax_priority_queue<long long> &q, long long x) { q.push(x); }
+
+void push_one(mirrored &q, long long x) { q.push(x); }
+
+long long pop_both(sjtu::minmax_priority_queue<long long> &q)
+{
+	long long x = q.top_min();
+	q.pop_min();
+	long long y = q.top_max();
+	q.pop_max();
+	return x + y;
+}
+
+long long pop_both(mirrored &q) { return q.pop_min() + q.pop_max(); }
+
+template <class Queue>
+void run(const bench::options &opt, const char *impl)
+{
+	for (const char *dist : bench::dists)
+		for (long long n : opt.sizes())
+		{
+			std::vector<long long> vals = bench::make_keys<long long>(dist, n);
+
+			if (opt.wants("push"))
+			{
+				Queue *q = nullptr;
+				double ns = bench::measure(
+					opt, n, [&] { delete q; q = new Queue(); },
+					[&] {
+						for (long long i = 0; i < n; i++)
+							push_one(*q, vals[i]);
+					});
+				delete q;
+				bench::report("minmax_priority_queue", "push", impl, "int64", dist, n, ns);
+			}
+
+			if (opt.wants("pop_min_max"))
+			{
+				Queue *q = nullptr;
+				double ns = bench::measure(
+					opt, n,
+					[&] {
+						delete q;
+						q = new Queue();
+						for (long long i = 0; i < n; i++)
+							push_one(*q, vals[i]);
+					},
+					[&] {
+						long long sum = 0;
+						for (long long i = 0; i + 1 < n; i += 2)
+							sum += pop_both(*q);
+						bench::keep(sum);
+					});
+				delete q;
+				bench::report("minmax_priority_queue", "pop_min_max", impl, "int64", dist, n, ns);
+			}
+		}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	run<sjtu::minmax_priority_queue<long long> >(opt, "sjtu::minmax_priority_queue");
+	run<mirrored>(opt, "sjtu::priority_queue/mirrored");
+
+	if (opt.wants("merge"))
+		for (long long n : opt.sizes())
+		{
+			std::vector<long long> vals = bench::make_keys<long long>("uniform", n);
+			sjtu::minmax_priority_queue<long long> *a = nullptr, *b = nullptr;
+			// equal halves take the rebuild, a 1% side takes the pushes
+			const int parts[] = {2, 100};
+			for (int part : parts)
+			{
+				double ns = bench::measure(
+					opt, n,
+					[&] {
+						delete a;
+						delete b;
+						a = new sjtu::minmax_priority_queue<long long>();
+						b = new sjtu::minmax_priority_queue<long long>();
+						for (long long i = 0; i < n; i++)
+							(i % part ? a : b)->push(vals[i]);
+					},
+					[&] { a->merge(*b); });
+				bench::report("minmax_priority_queue", part == 2 ? "merge_half" : "merge_small", "sjtu::minmax_priority_queue", "int64", "uniform", n, ns);
+			}
+			delete a;
+			delete b;
+		}
+	return 0;
+}
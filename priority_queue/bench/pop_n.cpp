@@ -0,0 +1,78 @@
+// batched extraction from sjtu::priority_queue: pop_n / drain_sorted against top() + pop() loops.
+// "tick" keeps a queue of n elements, pushes 256 new ones and pops the 256 greatest per round.
+
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+
+const size_t Batch = 256;
+
+template <class T>
+void run(const bench::options &opt)
+{
+	const char *key = bench::key_name<T>();
+	for (const char *dist : bench::dists)
+		for (long long n : opt.sizes())
+		{
+			std::vector<T> vals = bench::make_keys<T>(dist, n);
+			std::vector<T> more = bench::make_keys<T>("uniform", n, 998244353);
+			sjtu::priority_queue<T> full;
+			for (long long i = 0; i < n; i++)
+				full.push(vals[i]);
+			std::vector<T> out;
+			out.reserve(n);
+
+			for (int batched = 0; batched < 2; batched++)
+			{
+				const char *impl = batched ? "sjtu::priority_queue/pop_n" : "sjtu::priority_queue/pop";
+				if (opt.wants("tick"))
+				{
+					sjtu::priority_queue<T> *q = nullptr;
+					long long rounds = n / (long long)Batch + 1;
+					double ns = bench::measure(
+						opt, rounds * (long long)Batch, [&] { delete q; q = new sjtu::priority_queue<T>(full); },
+						[&] {
+							for (long long r = 0, j = 0; r < rounds; r++)
+							{
+								for (size_t i = 0; i < Batch; i++, j = j + 1 == n ? 0 : j + 1)
+									q->push(more[j]);
+								out.clear();
+								if (batched)
+									q->pop_n(Batch, std::back_inserter(out));
+								else
+									for (size_t i = 0; i < Batch; i++)
+										out.push_back(q->top()), q->pop();
+							}
+						});
+					delete q;
+					bench::report("pop_n", "tick", impl, key, dist, n, ns);
+				}
+
+				if (opt.wants("drain"))
+				{
+					sjtu::priority_queue<T> *q = nullptr;
+					double ns = bench::measure(
+						opt, n, [&] { delete q; q = new sjtu::priority_queue<T>(full); out.clear(); },
+						[&] {
+							if (batched)
+								q->drain_sorted(std::back_inserter(out));
+							else
+								while (!q->empty())
+									out.push_back(q->top()), q->pop();
+						});
+					delete q;
+					bench::report("pop_n", "drain", batched ? "sjtu::priority_queue/drain_sorted" : impl, key, dist, n, ns);
+				}
+			}
+		}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	run<int>(opt);
+	run<std::string>(opt);
+	return 0;
+}
@@ -0,0 +1,91 @@
+// push / pop / merge of sjtu::priority_queue against std::priority_queue.
+
+#include <queue>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+
+template <class T>
+void merge_into(sjtu::priority_queue<T> &a, sjtu::priority_queue<T> &b) { a.merge(b); }
+
+template <class T>
+void merge_into(std::priority_queue<T> &a, std::priority_queue<T> &b)
+{
+	for (; !b.empty(); b.pop())
+		a.push(b.top());
+}
+
+template <class T, class Queue>
+void run(const bench::options &opt, const char *impl)
+{
+	const char *key = bench::key_name<T>();
+
+	for (const char *dist : bench::dists)
+		for (long long n : opt.sizes())
+		{
+			std::vector<T> vals = bench::make_keys<T>(dist, n);
+			Queue full;
+			for (long long i = 0; i < n; i++)
+				full.push(vals[i]);
+
+			if (opt.wants("push"))
+			{
+				Queue *q = nullptr;
+				double ns = bench::measure(
+					opt, n, [&] { delete q; q = new Queue(); },
+					[&] {
+						for (long long i = 0; i < n; i++)
+							q->push(vals[i]);
+					});
+				delete q;
+				bench::report("priority_queue", "push", impl, key, dist, n, ns);
+			}
+
+			if (opt.wants("pop"))
+			{
+				Queue *q = nullptr;
+				double ns = bench::measure(
+					opt, n, [&] { delete q; q = new Queue(full); },
+					[&] {
+						for (long long i = 0; i < n; i++)
+						{
+							bench::keep(q->top());
+							q->pop();
+						}
+					});
+				delete q;
+				bench::report("priority_queue", "pop", impl, key, dist, n, ns);
+			}
+
+			if (opt.wants("merge"))
+			{
+				Queue *a = nullptr, *b = nullptr;
+				double ns = bench::measure(
+					opt, n,
+					[&] {
+						delete a;
+						delete b;
+						a = new Queue();
+						b = new Queue();
+						for (long long i = 0; i < n; i++)
+							(i & 1 ? a : b)->push(vals[i]);
+					},
+					[&] { merge_into(*a, *b); });
+				delete a;
+				delete b;
+				bench::report("priority_queue", "merge", impl, key, dist, n, ns);
+			}
+		}
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	run<int, sjtu::priority_queue<int> >(opt, "sjtu::priority_queue");
+	run<int, std::priority_queue<int> >(opt, "std::priority_queue");
+	run<std::string, sjtu::priority_queue<std::string> >(opt, "sjtu::priority_queue");
+	run<std::string, std::priority_queue<std::string> >(opt, "std::priority_queue");
+	return 0;
+}
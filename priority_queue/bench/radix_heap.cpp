@@ -0,0 +1,124 @@
+// Dijkstra on random sparse graphs with sjtu::radix_heap, sjtu::priority_queue and std::priority_queue.
+// every queue is reused across runs, the allocations per relaxed edge are reported next to the time.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <queue>
+#include <random>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+#include "radix_heap.hpp"
+
+static std::atomic<long long> Allocs(0);
+
+void *operator new(std::size_t n)
+{
+	Allocs++;
+	if (void *p = std::malloc(n ? n : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+typedef sjtu::pair<uint64_t, int> item;
+
+struct later
+{
+	bool operator()(const item &a, const item &b) const { return a.first > b.first; }
+};
+
+struct graph
+{
+	std::vector<int> Head, To, Next;
+	std::vector<uint64_t> Len;
+
+	graph(int n, int degree)
+	{
+		std::mt19937_64 rng(19260817);
+		Head.assign(n, -1);
+		for (int u = 0; u < n; u++)
+			for (int k = 0; k < degree; k++)
+			{
+				// a ring keeps every vertex reachable
+				int v = k ? int(rng() % n) : (u + 1) % n;
+				To.push_back(v);
+				Len.push_back(1 + rng() % 1000000);
+				Next.push_back(Head[u]);
+				Head[u] = int(To.size()) - 1;
+			}
+	}
+};
+
+void clear(sjtu::radix_heap<item> &q) { q.clear(); }
+
+template <class Queue>
+void clear(Queue &q)
+{
+	while (!q.empty())
+		q.pop();
+}
+
+template <class Queue>
+uint64_t dijkstra(const graph &g, Queue &q, std::vector<uint64_t> &dist)
+{
+	dist.assign(g.Head.size(), ~0ull);
+	dist[0] = 0;
+	q.push(item(0, 0));
+	while (!q.empty())
+	{
+		item x = q.top();
+		q.pop();
+		if (x.first != dist[x.second])
+			continue;
+		for (int e = g.Head[x.second]; e != -1; e = g.Next[e])
+			if (x.first + g.Len[e] < dist[g.To[e]])
+			{
+				dist[g.To[e]] = x.first + g.Len[e];
+				q.push(item(dist[g.To[e]], g.To[e]));
+			}
+	}
+	uint64_t sum = 0;
+	for (uint64_t d : dist)
+		sum += d;
+	return sum;
+}
+
+template <class Queue>
+void run(const bench::options &opt, const graph &g, long long n, const char *impl, uint64_t &expect)
+{
+	Queue q;
+	std::vector<uint64_t> dist;
+	long long edges = (long long)g.To.size();
+	uint64_t sum = 0;
+	long long Before = 0;
+	double ns = bench::measure(
+		opt, edges, [&] { clear(q); Before = Allocs; }, [&] { sum = dijkstra(g, q, dist); });
+	double allocs = double(Allocs - Before) / edges;
+	if (expect && sum != expect)
+		fprintf(stderr, "%s computed a different distance sum\n", impl);
+	expect = sum;
+	bench::report("radix_heap", "dijkstra", impl, "int64", "uniform", n, ns, "allocs_per_edge", allocs);
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	if (!opt.wants("dijkstra"))
+		return 0;
+	for (long long n : opt.sizes())
+	{
+		graph g(int(n), 4);
+		uint64_t expect = 0;
+		run<sjtu::radix_heap<item> >(opt, g, n, "sjtu::radix_heap", expect);
+		run<sjtu::priority_queue<item, later> >(opt, g, n, "sjtu::priority_queue", expect);
+		run<std::priority_queue<item, std::vector<item>, later> >(opt, g, n, "std::priority_queue", expect);
+	}
+	return 0;
+}
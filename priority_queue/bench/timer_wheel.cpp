@@ -0,0 +1,106 @@
+// idle timeouts of a server with n connections, on a 1 ms tick: every connection is active every
+// ~200 ms on average and each activity pushes its 30 s timeout back, so almost no timer fires.
+// timer_wheel cancels and reschedules; the priority_queue version pushes a new deadline with a
+// version number and skips stale entries when they reach the top (lazy cancellation).
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "bench.hpp"
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+#include "timer_wheel.hpp"
+#include "utility.hpp"
+
+const uint64_t Timeout = 30000, Ticks = 2000, Period = 200;
+
+struct entry
+{
+	uint64_t Deadline;
+	int Conn;
+	unsigned Version;
+};
+
+struct later
+{
+	bool operator()(const entry &a, const entry &b) const { return a.Deadline > b.Deadline; }
+};
+
+/**
+ * the connections active at each tick, the same for both implementations.
+ */
+std::vector<std::vector<int> > make_activity(long long n)
+{
+	std::mt19937_64 rng(19260817);
+	std::vector<std::vector<int> > ans(Ticks);
+	for (uint64_t t = 0; t < Ticks; t++)
+		for (long long k = 0; k < n / (long long)Period; k++)
+			ans[t].push_back(int(rng() % n));
+	return ans;
+}
+
+long long activities(const std::vector<std::vector<int> > &act)
+{
+	long long ans = 0;
+	for (const std::vector<int> &a : act)
+		ans += (long long)a.size();
+	return ans;
+}
+
+void run_wheel(const bench::options &opt, long long n, const std::vector<std::vector<int> > &act)
+{
+	double ns = bench::measure(opt, activities(act), [&] {
+		sjtu::timer_wheel<int> w;
+		std::vector<sjtu::timer_wheel<int>::id> Id(n);
+		for (long long c = 0; c < n; c++)
+			Id[c] = w.schedule(Timeout + c % 1000, int(c));
+		long long Fired = 0;
+		for (uint64_t t = 1; t <= Ticks; t++)
+		{
+			for (int c : act[t - 1])
+			{
+				w.cancel(Id[c]);
+				Id[c] = w.schedule(t + Timeout, c);
+			}
+			Fired += w.advance(t, [](uint64_t, int) {});
+		}
+		bench::keep(Fired);
+	});
+	bench::report("timer_wheel", "reschedule", "sjtu::timer_wheel", "int", "uniform", n, ns);
+}
+
+void run_heap(const bench::options &opt, long long n, const std::vector<std::vector<int> > &act)
+{
+	double ns = bench::measure(opt, activities(act), [&] {
+		sjtu::priority_queue<entry, later> q;
+		std::vector<unsigned> Version(n, 0);
+		for (long long c = 0; c < n; c++)
+			q.push(entry{Timeout + c % 1000, int(c), 0});
+		long long Fired = 0;
+		for (uint64_t t = 1; t <= Ticks; t++)
+		{
+			for (int c : act[t - 1])
+				q.push(entry{t + Timeout, c, ++Version[c]});
+			for (; !q.empty() && q.top().Deadline <= t; q.pop())
+				Fired += q.top().Version == Version[q.top().Conn];
+		}
+		bench::keep(Fired);
+	});
+	bench::report("timer_wheel", "reschedule", "sjtu::priority_queue/lazy", "int", "uniform", n, ns);
+}
+
+int main(int argc, char **argv)
+{
+	bench::options opt(argc, argv);
+	if (!opt.wants("reschedule"))
+		return 0;
+	for (long long n : opt.sizes())
+	{
+		if (n < (long long)Period)
+			continue;
+		std::vector<std::vector<int> > act = make_activity(n);
+		run_wheel(opt, n, act);
+		run_heap(opt, n, act);
+	}
+	return 0;
+}
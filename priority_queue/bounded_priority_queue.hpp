@@ -0,0 +1,83 @@
+#ifndef SJTU_BOUNDED_PRIORITY_QUEUE_HPP
+#define SJTU_BOUNDED_PRIORITY_QUEUE_HPP
+
+// a priority queue keeping only the K best elements pushed into it.
+
+#include <cstddef>
+#include <functional>
+#include "exceptions.hpp"
+#include "minmax_heap.hpp"
+
+namespace sjtu
+{
+	/**
+	 * a priority_queue of at most K elements: top() is the greatest element as in
+	 * sjtu::priority_queue, and when a push overflows, the least element is evicted,
+	 * which may be the pushed one. it keeps the K best elements of a stream in O(K) memory
+	 * and O(log K) per push, instead of holding the whole stream and popping it down.
+	 */
+	template <typename T, class Compare = std::less<T> >
+	class bounded_priority_queue
+	{
+	private:
+		minmax_heap<T, Compare> Heap;
+		size_t K;
+		Compare cmp;
+
+	public:
+		explicit bounded_priority_queue(size_t capacity, const Compare &_cmp = Compare()) : Heap(_cmp), K(capacity), cmp(_cmp) {}
+
+		/**
+		 * the greatest element.
+		 * throw container_is_empty if empty() returns true.
+		 */
+		const T &top() const { return Heap.max(); }
+
+		/**
+		 * the least element, the next to be evicted.
+		 * throw container_is_empty if empty() returns true.
+		 */
+		const T &bottom() const { return Heap.min(); }
+
+		/**
+		 * push e, evicting the least element if there are more than K.
+		 * return false if e itself is not kept.
+		 */
+		bool push(const T &e)
+		{
+			if (Heap.size() < K)
+			{
+				Heap.push(e);
+				return true;
+			}
+			if (!K || !cmp(Heap.min(), e))
+				return false;
+			Heap.replace_min(e);
+			return true;
+		}
+
+		/**
+		 * delete the greatest element.
+		 * throw container_is_empty if empty() returns true.
+		 */
+		void pop() { Heap.pop_max(); }
+
+		/**
+		 * move the elements out to out, greatest first, leaving the queue empty.
+		 */
+		template <class OutputIt>
+		OutputIt sorted_results(OutputIt out) { return Heap.drain_max(out); }
+
+		size_t size() const { return Heap.size(); }
+
+		size_t capacity() const { return K; }
+
+		bool empty() const { return Heap.empty(); }
+
+		bool full() const { return Heap.size() == K; }
+
+		void clear() { Heap.clear(); }
+	};
+}
+
+#endif
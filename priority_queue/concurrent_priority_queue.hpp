@@ -0,0 +1,171 @@
+#ifndef SJTU_CONCURRENT_PRIORITY_QUEUE_HPP
+#define SJTU_CONCURRENT_PRIORITY_QUEUE_HPP
+
+// a thread-safe blocking priority queue for producer / consumer pipelines.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+
+namespace sjtu
+{
+	/**
+	 * a sjtu::priority_queue behind a mutex, with consumers blocking on a condition variable.
+	 * producers with many elements fill a local priority_queue and hand it over with
+	 * push_batch(), one lock and one O(log n) merge for the whole batch; consumers take
+	 * up to k elements per lock with pop_batch().
+	 *
+	 * close() ends the queue: pushes are refused from then on, consumers get the elements
+	 * still inside and then stop blocking.
+	 */
+	template <typename T, class Compare = std::less<T> >
+	class concurrent_priority_queue
+	{
+	public:
+		typedef priority_queue<T, Compare> local_queue;
+
+	private:
+		local_queue Queue;
+		mutable std::mutex Lock;
+		std::condition_variable NotEmpty;
+		bool Closed;
+
+	public:
+		concurrent_priority_queue() : Closed(false) {}
+
+		concurrent_priority_queue(const concurrent_priority_queue &) = delete;
+
+		concurrent_priority_queue &operator=(const concurrent_priority_queue &) = delete;
+
+		/**
+		 * return false if the queue is closed.
+		 */
+		bool push(const T &e)
+		{
+			{
+				std::lock_guard<std::mutex> Guard(Lock);
+				if (Closed)
+					return false;
+				Queue.push(e);
+			}
+			NotEmpty.notify_one();
+			return true;
+		}
+
+		/**
+		 * move every element of local in, leaving it empty.
+		 * return false if the queue is closed, local is left untouched then.
+		 */
+		bool push_batch(local_queue &local)
+		{
+			size_t n = local.size();
+			if (!n)
+				return true;
+			{
+				std::lock_guard<std::mutex> Guard(Lock);
+				if (Closed)
+					return false;
+				Queue.merge(local);
+			}
+			if (n == 1)
+				NotEmpty.notify_one();
+			else
+				NotEmpty.notify_all();
+			return true;
+		}
+
+		/**
+		 * wait for an element and move the greatest one to out.
+		 * return false if the queue is closed and empty.
+		 */
+		bool pop_wait(T &out)
+		{
+			std::unique_lock<std::mutex> Guard(Lock);
+			NotEmpty.wait(Guard, [this] { return !Queue.empty() || Closed; });
+			return Queue.try_pop(out);
+		}
+
+		/**
+		 * the same as pop_wait() without waiting: return false if the queue is empty.
+		 */
+		bool try_pop(T &out)
+		{
+			std::lock_guard<std::mutex> Guard(Lock);
+			return Queue.try_pop(out);
+		}
+
+		/**
+		 * the same as pop_wait() waiting at most timeout: return false if nothing came.
+		 */
+		template <class Rep, class Period>
+		bool try_pop(T &out, const std::chrono::duration<Rep, Period> &timeout)
+		{
+			std::unique_lock<std::mutex> Guard(Lock);
+			if (!NotEmpty.wait_for(Guard, timeout, [this] { return !Queue.empty() || Closed; }) )
+				return false;
+			return Queue.try_pop(out);
+		}
+
+		/**
+		 * wait for an element and move up to k of the greatest ones to out, greatest first.
+		 * return how many were taken, 0 only if the queue is closed and empty.
+		 * throw runtime_error if k is 0, which could not tell an empty batch from the end.
+		 */
+		template <class OutputIt>
+		size_t pop_batch(size_t k, OutputIt out)
+		{
+			if (!k)
+				throw runtime_error();
+			std::unique_lock<std::mutex> Guard(Lock);
+			NotEmpty.wait(Guard, [this] { return !Queue.empty() || Closed; });
+			size_t n = k < Queue.size() ? k : Queue.size();
+			Queue.pop_n(n, out);
+			return n;
+		}
+
+		/**
+		 * refuse further pushes and wake every waiting consumer.
+		 */
+		void close()
+		{
+			{
+				std::lock_guard<std::mutex> Guard(Lock);
+				Closed = true;
+			}
+			NotEmpty.notify_all();
+		}
+
+		bool closed() const
+		{
+			std::lock_guard<std::mutex> Guard(Lock);
+			return Closed;
+		}
+
+		size_t size() const
+		{
+			std::lock_guard<std::mutex> Guard(Lock);
+			return Queue.size();
+		}
+
+		bool empty() const
+		{
+			std::lock_guard<std::mutex> Guard(Lock);
+			return Queue.empty();
+		}
+
+		/**
+		 * the nodes pop_batch() kept for later pushes, no more than the queue held.
+		 */
+		size_t spares() const
+		{
+			std::lock_guard<std::mutex> Guard(Lock);
+			return Queue.spares();
+		}
+	};
+}
+
+#endif
@@ -1,4 +1,3 @@
-
 #ifndef SJTU_EXCEPTIONS_HPP
 #define SJTU_EXCEPTIONS_HPP
 
@@ -8,32 +7,47 @@
 
 namespace sjtu {
 
+/**
+ * the messages are static strings, so making, copying and throwing an exception
+ * allocates nothing but the exception object the runtime needs anyway.
+ * a hot path that expects misses should still use the try_ / find_ functions
+ * of the containers instead of catching these.
+ */
 class exception {
 protected:
-	const std::string variant = "";
-	std::string detail = "";
+	const char *variant = "exception";
+	const char *detail = "";
+	exception(const char *variant, const char *detail) noexcept : variant(variant), detail(detail) {}
 public:
-	exception() {}
-	exception(const exception &ec) : variant(ec.variant), detail(ec.detail) {}
-	virtual std::string what() {
-		return variant + " " + detail;
+	exception() noexcept {}
+	exception(const exception &ec) noexcept : variant(ec.variant), detail(ec.detail) {}
+	virtual ~exception() {}
+	virtual const char *what() const noexcept {
+		return variant;
+	}
+	const char *reason() const noexcept {
+		return detail;
 	}
 };
 
 class index_out_of_bound : public exception {
-	/* __________________________ */
+public:
+	explicit index_out_of_bound(const char *detail = "") noexcept : exception("index_out_of_bound", detail) {}
 };
 
 class runtime_error : public exception {
-	/* __________________________ */
+public:
+	explicit runtime_error(const char *detail = "") noexcept : exception("runtime_error", detail) {}
 };
 
 class invalid_iterator : public exception {
-	/* __________________________ */
+public:
+	explicit invalid_iterator(const char *detail = "") noexcept : exception("invalid_iterator", detail) {}
 };
 
 class container_is_empty : public exception {
-	/* __________________________ */
+public:
+	explicit container_is_empty(const char *detail = "") noexcept : exception("container_is_empty", detail) {}
 };
 }
 
@@ -0,0 +1,344 @@
+#ifndef SJTU_EXTERNAL_PRIORITY_QUEUE_HPP
+#define SJTU_EXTERNAL_PRIORITY_QUEUE_HPP
+
+// a priority queue holding more elements than its memory budget by spilling sorted runs to disk, POSIX only.
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include "exceptions.hpp"
+#include "minmax_heap.hpp"
+
+namespace sjtu
+{
+	/**
+	 * a sequence heap: pushes go to an in-memory heap, which is sorted and written to a
+	 * temporary file as a run when it fills up. top() is the greatest of the heap and of the
+	 * heads of the runs, which are read back one block at a time. when there are more runs
+	 * than blocks fit in the budget, the shorter half of them is merged into one first.
+	 *
+	 * the budget is split in two halves: the in-memory heap, and one block per run plus
+	 * the write buffer. elements are written as raw bytes and have to be trivially copyable.
+	 * the files are unlinked right after creation and vanish with the queue.
+	 */
+	template <typename T, class Compare = std::less<T> >
+	class external_priority_queue
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "elements of external_priority_queue are written to disk as bytes");
+
+	private:
+		struct run
+		{
+			int Fd;
+			T *Buf;
+			size_t Pos, Len, Left; // Buf[Pos, Len) is buffered, Left more elements are on disk
+		};
+
+		minmax_heap<T, Compare> Heap;
+		size_t HeapCap, Block, MaxRuns;
+		std::string Dir;
+
+		run *Runs;
+		int *Order; // heap of run indices, the greatest head first
+		int *Merge; // the same for the runs being merged
+		size_t RunCnt;
+		T *Out;
+		size_t Size;
+		unsigned long long Spilled;
+		Compare cmp;
+
+		static void write_all(int Fd, const void *p, size_t n)
+		{
+			const char *c = static_cast<const char *>(p);
+			while (n)
+			{
+				ssize_t w = ::write(Fd, c, n);
+				if (w <= 0)
+					throw runtime_error();
+				c += w, n -= size_t(w);
+			}
+		}
+
+		static void read_all(int Fd, void *p, size_t n)
+		{
+			char *c = static_cast<char *>(p);
+			while (n)
+			{
+				ssize_t r = ::read(Fd, c, n);
+				if (r <= 0)
+					throw runtime_error();
+				c += r, n -= size_t(r);
+			}
+		}
+
+		int temp_file() const
+		{
+			std::string Path = Dir + "/sjtu-epq-XXXXXX";
+			int Fd = ::mkstemp(&Path[0]);
+			if (Fd < 0)
+				throw runtime_error();
+			::unlink(Path.c_str());
+			return Fd;
+		}
+
+		const T &head(int r) const { return Runs[r].Buf[Runs[r].Pos]; }
+
+		size_t remaining(int r) const { return Runs[r].Len - Runs[r].Pos + Runs[r].Left; }
+
+		bool before(int a, int b) const { return cmp(head(b), head(a)); }
+
+		/**
+		 * H[0, n) is a heap of run indices by their heads.
+		 */
+		void sift_up(int *H, size_t i)
+		{
+			for (; i && before(H[i], H[(i - 1) / 2]); i = (i - 1) / 2)
+				std ::swap(H[i], H[(i - 1) / 2]);
+		}
+
+		void sift_down(int *H, size_t n, size_t i)
+		{
+			for (;;)
+			{
+				size_t m = i, l = 2 * i + 1;
+				if (l < n && before(H[l], H[m]))
+					m = l;
+				if (l + 1 < n && before(H[l + 1], H[m]))
+					m = l + 1;
+				if (m == i)
+					return;
+				std ::swap(H[i], H[m]);
+				i = m;
+			}
+		}
+
+		void refill(run &r)
+		{
+			r.Len = r.Left < Block ? r.Left : Block;
+			read_all(r.Fd, r.Buf, r.Len * sizeof(T));
+			r.Left -= r.Len;
+			r.Pos = 0;
+		}
+
+		/**
+		 * step past the head of H[0], dropping it from H when its run is used up.
+		 * return false then, after closing the run.
+		 */
+		bool step(int *H, size_t &n)
+		{
+			run &r = Runs[H[0]];
+			if (++r.Pos == r.Len && r.Left)
+				refill(r);
+			bool Alive = r.Pos < r.Len;
+			if (!Alive)
+			{
+				::close(r.Fd);
+				r.Fd = -1;
+				H[0] = H[--n];
+			}
+			sift_down(H, n, 0);
+			return Alive;
+		}
+
+		/**
+		 * pack the runs still open to the front, keeping every buffer, and rebuild Order.
+		 */
+		void compact()
+		{
+			size_t n = 0;
+			for (size_t i = 0; i < RunCnt; i++)
+				if (Runs[i].Fd >= 0)
+					std ::swap(Runs[n++], Runs[i]);
+			RunCnt = n;
+			for (size_t i = 0; i < n; i++)
+				Order[i] = int(i);
+			for (size_t i = n / 2; i-- > 0;)
+				sift_down(Order, n, i);
+		}
+
+		/**
+		 * start reading a finished run from its beginning and enter it into Order.
+		 */
+		void add_run(int Fd, size_t Len)
+		{
+			if (::lseek(Fd, 0, SEEK_SET) < 0)
+				throw runtime_error();
+			run &r = Runs[RunCnt];
+			r.Fd = Fd;
+			r.Left = Len;
+			refill(r);
+			Order[RunCnt] = int(RunCnt);
+			sift_up(Order, RunCnt++);
+		}
+
+		/**
+		 * step past the head of the greatest run.
+		 */
+		void advance()
+		{
+			size_t n = RunCnt;
+			if (!step(Order, n))
+				compact();
+		}
+
+		/**
+		 * stream the smaller half of the runs into a single new one.
+		 * merging only runs of similar length keeps the lengths growing geometrically,
+		 * so an element is rewritten O(log(n / budget)) times at most.
+		 */
+		void merge_runs()
+		{
+			size_t k = RunCnt / 2 > 2 ? RunCnt / 2 : 2;
+			for (size_t i = 0; i < RunCnt; i++)
+				Merge[i] = int(i);
+			for (size_t i = 1; i < RunCnt; i++)
+				for (size_t j = i; j > 0 && remaining(Merge[j]) < remaining(Merge[j - 1]); j--)
+					std ::swap(Merge[j], Merge[j - 1]);
+			for (size_t i = k / 2; i-- > 0;)
+				sift_down(Merge, k, i);
+
+			int Fd = temp_file();
+			size_t Len = 0, n = 0;
+			while (k)
+			{
+				Out[n++] = head(Merge[0]);
+				if (n == Block)
+					write_all(Fd, Out, n * sizeof(T)), Len += n, n = 0;
+				step(Merge, k);
+			}
+			write_all(Fd, Out, n * sizeof(T));
+			Len += n;
+			Spilled += Len * sizeof(T);
+			compact();
+			add_run(Fd, Len);
+		}
+
+		/**
+		 * write the in-memory heap out as a run, greatest first.
+		 */
+		void spill()
+		{
+			if (RunCnt == MaxRuns)
+				merge_runs();
+			int Fd = temp_file();
+			size_t Len = Heap.size(), n = 0;
+			while (!Heap.empty())
+			{
+				Out[n++] = Heap.max();
+				Heap.pop_max();
+				if (n == Block)
+					write_all(Fd, Out, n * sizeof(T)), n = 0;
+			}
+			write_all(Fd, Out, n * sizeof(T));
+			Spilled += Len * sizeof(T);
+			add_run(Fd, Len);
+		}
+
+		/**
+		 * true if the top is in the in-memory heap.
+		 */
+		bool top_in_heap() const
+		{
+			return !RunCnt || (!Heap.empty() && !cmp(Heap.max(), head(Order[0])));
+		}
+
+	public:
+		/**
+		 * memory_budget is in bytes, dir holds the temporary files ($TMPDIR or /tmp by default).
+		 */
+		explicit external_priority_queue(size_t memory_budget = size_t(64) << 20, const char *dir = nullptr)
+			: RunCnt(0), Size(0), Spilled(0)
+		{
+			const char *Env = std::getenv("TMPDIR");
+			Dir = dir ? dir : Env && *Env ? Env : "/tmp";
+			size_t Half = memory_budget / 2 / sizeof(T);
+			HeapCap = Half > 16 ? Half : 16;
+			Block = Half / 16;
+			Block = Block < 16 ? 16 : Block > (size_t(1) << 20) / sizeof(T) ? (size_t(1) << 20) / sizeof(T) : Block;
+			MaxRuns = Half / Block > 3 ? Half / Block - 1 : 2;
+			Heap.reserve(HeapCap);
+			Runs = new run[MaxRuns];
+			Order = new int[MaxRuns];
+			Merge = new int[MaxRuns];
+			for (size_t i = 0; i < MaxRuns; i++)
+				Runs[i].Buf = static_cast<T *>(::operator new(Block * sizeof(T)));
+			Out = static_cast<T *>(::operator new(Block * sizeof(T)));
+		}
+
+		external_priority_queue(const external_priority_queue &) = delete;
+
+		external_priority_queue &operator=(const external_priority_queue &) = delete;
+
+		~external_priority_queue()
+		{
+			for (size_t i = 0; i < RunCnt; i++)
+				::close(Runs[i].Fd);
+			for (size_t i = 0; i < MaxRuns; i++)
+				::operator delete(Runs[i].Buf);
+			delete[] Runs;
+			delete[] Order;
+			delete[] Merge;
+			::operator delete(Out);
+		}
+
+		/**
+		 * the greatest element.
+		 * throw container_is_empty if empty() returns true.
+		 */
+		const T &top() const
+		{
+			if (empty())
+				throw container_is_empty();
+			return top_in_heap() ? Heap.max() : head(Order[0]);
+		}
+
+		/**
+		 * throw runtime_error if a run cannot be written.
+		 */
+		void push(const T &e)
+		{
+			if (Heap.size() == HeapCap)
+				spill();
+			Heap.push(e);
+			Size++;
+		}
+
+		/**
+		 * delete the greatest element.
+		 * throw container_is_empty if empty() returns true.
+		 */
+		void pop()
+		{
+			if (empty())
+				throw container_is_empty();
+			if (top_in_heap())
+				Heap.pop_max();
+			else
+				advance();
+			Size--;
+		}
+
+		size_t size() const { return Size; }
+
+		bool empty() const { return Size == 0; }
+
+		/**
+		 * the number of runs on disk.
+		 */
+		size_t runs() const { return RunCnt; }
+
+		/**
+		 * bytes written to disk so far, merges included.
+		 */
+		unsigned long long spilled_bytes() const { return Spilled; }
+	};
+}
+
+#endif
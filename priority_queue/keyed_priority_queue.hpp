@@ -0,0 +1,381 @@
+#ifndef SJTU_KEYED_PRIORITY_QUEUE_HPP
+#define SJTU_KEYED_PRIORITY_QUEUE_HPP
+
+// a priority queue of large elements ordered by a small key taken out of them.
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "exceptions.hpp"
+
+namespace sjtu
+{
+	/**
+	 * the type KeyOf gives for a const T &, without references and cv-qualifiers.
+	 */
+	template <typename T, class KeyOf>
+	struct key_of_result
+	{
+		typedef typename std::decay<decltype(std::declval<const KeyOf &>()(std::declval<const T &>()))>::type type;
+	};
+
+	/**
+	 * a priority_queue for elements too large to be compared and moved around cheaply:
+	 * KeyOf()(e) gives the priority of e, which is copied once at push() into the heap,
+	 * an array of (key, element pointer) entries in a 4-ary heap, while the element itself
+	 * stays where push() put it, in a slot of a pool of fixed blocks, until it is popped.
+	 * so the sifts compare and move only the dense entries, 4 children side by side,
+	 * and never touch or copy the elements.
+	 *
+	 *     struct by_id { long long operator()(const order &o) const { return o.Id; } };
+	 *     sjtu::keyed_priority_queue<order, by_id> q;
+	 *
+	 * the key of an element must not change while it is in the queue, and Compare orders the
+	 * keys like the Compare of priority_queue orders the elements: top() is the greatest.
+	 */
+	template <typename T, class KeyOf, class Compare = std::less<typename key_of_result<T, KeyOf>::type> >
+	class keyed_priority_queue
+	{
+	public:
+		typedef typename key_of_result<T, KeyOf>::type key_type;
+
+	private:
+		static const size_t Arity = 4;
+
+		struct Entry
+		{
+			key_type Key;
+			T *Val;
+		};
+
+		/**
+		 * an element, or a link of the free list once it is popped.
+		 */
+		union Slot
+		{
+			Slot *Next;
+			alignas(T) unsigned char Raw[sizeof(T)];
+		};
+
+		static const size_t BlockSlots = 16384 / sizeof(Slot) > 16 ? 16384 / sizeof(Slot) : 16;
+
+		struct Block
+		{
+			Block *Prev;
+			Slot Slots[BlockSlots];
+		};
+
+		Entry *Heap;
+		size_t Size, Cap;
+		Block *Blocks; // the last one allocated, linked by Prev
+		size_t Used;   // slots of Blocks ever handed out
+		Slot *Free;
+		KeyOf key;
+		Compare cmp;
+
+		static size_t parent(size_t i) { return (i - 1) / Arity; }
+
+		T *make(const T &e)
+		{
+			Slot *s = Free;
+			if (s)
+				Free = s->Next;
+			else
+			{
+				if (!Blocks || Used == BlockSlots)
+				{
+					Block *b = static_cast<Block *>(::operator new(sizeof(Block)));
+					b->Prev = Blocks;
+					Blocks = b;
+					Used = 0;
+				}
+				s = Blocks->Slots + Used++;
+			}
+			return new (s->Raw) T(e);
+		}
+
+		void recycle(T *x)
+		{
+			x->~T();
+			Slot *s = reinterpret_cast<Slot *>(x);
+			s->Next = Free;
+			Free = s;
+		}
+
+		/**
+		 * put the slots of b from From on, never handed out, on the free list in order.
+		 */
+		void free_tail(Block *b, size_t From)
+		{
+			for (size_t i = BlockSlots; i-- > From;)
+			{
+				b->Slots[i].Next = Free;
+				Free = b->Slots + i;
+			}
+		}
+
+		void push_up(size_t i)
+		{
+			Entry x = std ::move(Heap[i]);
+			for (; i && cmp(Heap[parent(i)].Key, x.Key); i = parent(i))
+				Heap[i] = std ::move(Heap[parent(i)]);
+			Heap[i] = std ::move(x);
+		}
+
+		void push_down(size_t i)
+		{
+			Entry x = std ::move(Heap[i]);
+			for (;;)
+			{
+				size_t First = Arity * i + 1;
+				if (First >= Size)
+					break;
+				size_t c = First, Last = First + Arity < Size ? First + Arity : Size;
+				for (size_t j = First + 1; j < Last; j++)
+					if (cmp(Heap[c].Key, Heap[j].Key))
+						c = j;
+				if (!cmp(x.Key, Heap[c].Key))
+					break;
+				Heap[i] = std ::move(Heap[c]);
+				i = c;
+			}
+			Heap[i] = std ::move(x);
+		}
+
+		void reserve(size_t NewCap)
+		{
+			if (NewCap <= Cap)
+				return;
+			Entry *NewHeap = static_cast<Entry *>(::operator new(NewCap * sizeof(Entry)));
+			for (size_t i = 0; i < Size; i++)
+			{
+				new (NewHeap + i) Entry(std ::move(Heap[i]));
+				Heap[i].~Entry();
+			}
+			::operator delete(Heap);
+			Heap = NewHeap;
+			Cap = NewCap;
+		}
+
+		void append(Entry &x)
+		{
+			if (Size == Cap)
+				reserve(Cap ? Cap * 2 : 8);
+			new (Heap + Size++) Entry(std ::move(x));
+		}
+
+		/**
+		 * restore the order of the whole array bottom-up, O(n).
+		 */
+		void heapify()
+		{
+			for (size_t i = Size > 1 ? parent(Size - 1) + 1 : 0; i-- > 0;)
+				push_down(i);
+		}
+
+		void copy_from(const keyed_priority_queue &other)
+		{
+			cmp = other.cmp;
+			key = other.key;
+			reserve(other.Size);
+			for (size_t i = 0; i < other.Size; i++)
+			{
+				Entry x = {other.Heap[i].Key, make(*other.Heap[i].Val)};
+				append(x);
+			}
+		}
+
+		void release()
+		{
+			clear();
+			while (Blocks)
+			{
+				Block *b = Blocks;
+				Blocks = b->Prev;
+				::operator delete(b);
+			}
+			Free = nullptr;
+			Used = 0;
+		}
+
+	public:
+		explicit keyed_priority_queue(const Compare &_cmp = Compare(), const KeyOf &_key = KeyOf())
+			: Heap(nullptr), Size(0), Cap(0), Blocks(nullptr), Used(0), Free(nullptr), key(_key), cmp(_cmp) {}
+
+		keyed_priority_queue(const keyed_priority_queue &other)
+			: Heap(nullptr), Size(0), Cap(0), Blocks(nullptr), Used(0), Free(nullptr) { copy_from(other); }
+
+		~keyed_priority_queue()
+		{
+			release();
+			::operator delete(Heap);
+		}
+
+		keyed_priority_queue &operator=(const keyed_priority_queue &other)
+		{
+			if (this == &other)
+				return *this;
+			clear();
+			copy_from(other);
+			return *this;
+		}
+
+		/**
+		 * get the top of the queue.
+		 * throw container_is_empty if empty() returns true.
+		 */
+		const T &top() const
+		{
+			if (empty())
+				throw container_is_empty();
+			return *Heap[0].Val;
+		}
+
+		/**
+		 * the key of top(), read from the heap.
+		 * throw container_is_empty if empty() returns true.
+		 */
+		const key_type &top_key() const
+		{
+			if (empty())
+				throw container_is_empty();
+			return Heap[0].Key;
+		}
+
+		void push(const T &e)
+		{
+			Entry x = {key(e), nullptr};
+			x.Val = make(e);
+			append(x);
+			push_up(Size - 1);
+		}
+
+		/**
+		 * delete the top element.
+		 * throw container_is_empty if empty() returns true.
+		 */
+		void pop()
+		{
+			if (empty())
+				throw container_is_empty();
+			recycle(Heap[0].Val);
+			if (--Size)
+			{
+				Heap[0] = std ::move(Heap[Size]);
+				push_down(0);
+			}
+			Heap[Size].~Entry();
+		}
+
+		/**
+		 * the top element, or nullptr if the queue is empty; nothing is thrown.
+		 */
+		const T *try_top() const
+		{
+			return empty() ? nullptr : Heap[0].Val;
+		}
+
+		/**
+		 * move the top element to out and delete it.
+		 * return false and leave out alone if the queue is empty.
+		 */
+		bool try_pop(T &out)
+		{
+			if (empty())
+				return false;
+			out = std ::move(*Heap[0].Val);
+			pop();
+			return true;
+		}
+
+		size_t size() const { return Size; }
+
+		bool empty() const { return Size == 0; }
+
+		/**
+		 * delete every element, the blocks of the pool are kept for later pushes.
+		 */
+		void clear()
+		{
+			for (size_t i = 0; i < Size; i++)
+			{
+				recycle(Heap[i].Val);
+				Heap[i].~Entry();
+			}
+			Size = 0;
+		}
+
+		/**
+		 * move the elements of other into this and clear other.
+		 * the elements do not move: this takes over the blocks of other. the entries of a
+		 * small other are pushed one by one, otherwise appended and the heap rebuilt,
+		 * O(min(m log(n + m), n + m)) for sizes n and m.
+		 */
+		void merge(keyed_priority_queue &other)
+		{
+			if (this == &other || other.empty())
+				return;
+			reserve(Size + other.Size);
+			bool Rebuild = other.Size > Size / 8;
+			for (size_t i = 0; i < other.Size; i++)
+			{
+				append(other.Heap[i]);
+				other.Heap[i].~Entry();
+				if (!Rebuild)
+					push_up(Size - 1);
+			}
+			if (Rebuild)
+				heapify();
+			other.Size = 0;
+
+			// splice the blocks of other behind the one we hand slots out of, and its free slots;
+			// of the two blocks slots are handed out of, the one with more room stays that, and
+			// the slots left in the other go to the free list, so that merges lose no slots
+			if (Block *b = other.Blocks)
+			{
+				if (Blocks)
+				{
+					if (other.Used < Used)
+					{
+						std::swap(Blocks, other.Blocks);
+						std::swap(Used, other.Used);
+						b = other.Blocks;
+					}
+					free_tail(other.Blocks, other.Used);
+					while (b->Prev)
+						b = b->Prev;
+					b->Prev = Blocks->Prev;
+					Blocks->Prev = other.Blocks;
+				}
+				else
+					Blocks = other.Blocks, Used = other.Used;
+			}
+			if (Slot *s = other.Free)
+			{
+				while (s->Next)
+					s = s->Next;
+				s->Next = Free;
+				Free = other.Free;
+			}
+			other.Blocks = nullptr;
+			other.Used = 0;
+			other.Free = nullptr;
+		}
+
+		/**
+		 * check that no child beats its parent and that every key is the key of its element,
+		 * for soak tests.
+		 */
+		bool validate() const
+		{
+			for (size_t i = 0; i < Size; i++)
+				if ((i && cmp(Heap[parent(i)].Key, Heap[i].Key)) || cmp(Heap[i].Key, key(*Heap[i].Val)) || cmp(key(*Heap[i].Val), Heap[i].Key))
+					return false;
+			return true;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,305 @@
+#ifndef SJTU_MINMAX_HEAP_HPP
+#define SJTU_MINMAX_HEAP_HPP
+
+// an implicit heap giving both the least and the greatest element.
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <utility>
+#include "exceptions.hpp"
+
+namespace sjtu
+{
+	/**
+	 * a min-max heap in an array: the levels alternate between min levels (the root's)
+	 * and max levels, every element is not greater than its descendants on a min level and
+	 * not less than them on a max level. the least element is the root, the greatest one of
+	 * its children, push and both pops are O(log n).
+	 */
+	template <typename T, class Compare = std::less<T> >
+	class minmax_heap
+	{
+	private:
+		T *Data;
+		size_t Size, Cap;
+		Compare cmp;
+
+		static size_t parent(size_t i) { return (i - 1) / 2; }
+
+		static bool on_min_level(size_t i)
+		{
+			int Level = 0;
+			for (i++; i > 1; i >>= 1)
+				Level++;
+			return !(Level & 1);
+		}
+
+		/**
+		 * on a min level "better" means less, on a max level greater.
+		 */
+		bool better(size_t a, size_t b, bool Min) const
+		{
+			return Min ? cmp(Data[a], Data[b]) : cmp(Data[b], Data[a]);
+		}
+
+		void push_up(size_t i, bool Min)
+		{
+			while (i > 2 && better(i, parent(parent(i)), Min))
+			{
+				std ::swap(Data[i], Data[parent(parent(i))]);
+				i = parent(parent(i));
+			}
+		}
+
+		void push_up(size_t i)
+		{
+			if (!i)
+				return;
+			bool Min = on_min_level(i);
+			size_t p = parent(i);
+			if (better(p, i, Min))
+			{
+				std ::swap(Data[i], Data[p]);
+				push_up(p, !Min);
+			}
+			else
+				push_up(i, Min);
+		}
+
+		void trickle_down(size_t i)
+		{
+			bool Min = on_min_level(i);
+			for (;;)
+			{
+				size_t First = 2 * i + 1;
+				if (First >= Size)
+					return;
+				// the best of the children and grandchildren
+				size_t m = First;
+				if (First + 1 < Size && better(First + 1, m, Min))
+					m = First + 1;
+				for (size_t g = 2 * First + 1; g < 2 * First + 5 && g < Size; g++)
+					if (better(g, m, Min))
+						m = g;
+				if (!better(m, i, Min))
+					return;
+				std ::swap(Data[m], Data[i]);
+				if (m <= First + 1)
+					return;
+				if (better(parent(m), m, Min))
+					std ::swap(Data[m], Data[parent(m)]);
+				i = m;
+			}
+		}
+
+		size_t max_index() const
+		{
+			if (Size < 3)
+				return Size - 1;
+			return cmp(Data[1], Data[2]) ? 2 : 1;
+		}
+
+		void remove(size_t i)
+		{
+			if (i != --Size)
+				Data[i] = std ::move(Data[Size]);
+			Data[Size].~T();
+			if (i < Size)
+				trickle_down(i);
+		}
+
+		void grow(size_t NewCap)
+		{
+			T *NewData = static_cast<T *>(::operator new(NewCap * sizeof(T)));
+			for (size_t i = 0; i < Size; i++)
+			{
+				new (NewData + i) T(std ::move(Data[i]));
+				Data[i].~T();
+			}
+			::operator delete(Data);
+			Data = NewData;
+			Cap = NewCap;
+		}
+
+		/**
+		 * restore the order of the whole array bottom-up, O(n).
+		 */
+		void heapify()
+		{
+			for (size_t i = Size / 2; i-- > 0;)
+				trickle_down(i);
+		}
+
+		void copy_from(const minmax_heap &other)
+		{
+			cmp = other.cmp;
+			if (other.Size > Cap)
+				grow(other.Size);
+			for (size_t i = 0; i < other.Size; i++)
+				new (Data + i) T(other.Data[i]);
+			Size = other.Size;
+		}
+
+	public:
+		explicit minmax_heap(const Compare &_cmp = Compare()) : Data(nullptr), Size(0), Cap(0), cmp(_cmp) {}
+
+		minmax_heap(const minmax_heap &other) : Data(nullptr), Size(0), Cap(0) { copy_from(other); }
+
+		~minmax_heap()
+		{
+			clear();
+			::operator delete(Data);
+		}
+
+		minmax_heap &operator=(const minmax_heap &other)
+		{
+			if (this == &other)
+				return *this;
+			clear();
+			copy_from(other);
+			return *this;
+		}
+
+		/**
+		 * throw container_is_empty if empty() returns true.
+		 */
+		const T &min() const
+		{
+			if (empty())
+				throw container_is_empty();
+			return Data[0];
+		}
+
+		const T &max() const
+		{
+			if (empty())
+				throw container_is_empty();
+			return Data[max_index()];
+		}
+
+		void push(const T &e)
+		{
+			if (Size == Cap)
+				grow(Cap ? Cap * 2 : 8);
+			new (Data + Size) T(e);
+			push_up(Size++);
+		}
+
+		void pop_min()
+		{
+			if (empty())
+				throw container_is_empty();
+			remove(0);
+		}
+
+		void pop_max()
+		{
+			if (empty())
+				throw container_is_empty();
+			remove(max_index());
+		}
+
+		/**
+		 * pop_min() then push(e) in one pass down the heap.
+		 */
+		void replace_min(const T &e)
+		{
+			if (empty())
+				throw container_is_empty();
+			Data[0] = e;
+			trickle_down(0);
+		}
+
+		/**
+		 * move every element of other into this, leaving other empty.
+		 * a small other is pushed one by one, otherwise the arrays are concatenated
+		 * and rebuilt: O(min(m log(n + m), n + m)) for sizes n and m.
+		 */
+		void merge(minmax_heap &other)
+		{
+			if (this == &other || !other.Size)
+				return;
+			if (other.Size > Size)
+			{
+				std ::swap(Data, other.Data);
+				std ::swap(Size, other.Size);
+				std ::swap(Cap, other.Cap);
+			}
+			size_t Total = Size + other.Size, Log = 0;
+			while (size_t(1) << Log < Total)
+				Log++;
+			if (Size + other.Size > Cap)
+				grow(Cap * 2 >= Total ? Cap * 2 : Total);
+			for (size_t i = 0; i < other.Size; i++)
+			{
+				new (Data + Size) T(std ::move(other.Data[i]));
+				other.Data[i].~T();
+				if (other.Size * Log < Total)
+					push_up(Size);
+				Size++;
+			}
+			if (other.Size * Log >= Total)
+				heapify();
+			other.Size = 0;
+		}
+
+		/**
+		 * move the greatest element out to out, and so on, until the heap is empty.
+		 */
+		template <class OutputIt>
+		OutputIt drain_max(OutputIt out)
+		{
+			while (Size)
+			{
+				size_t i = max_index();
+				*out++ = std ::move(Data[i]);
+				remove(i);
+			}
+			return out;
+		}
+
+		/**
+		 * make room for n elements.
+		 */
+		void reserve(size_t n)
+		{
+			if (n > Cap)
+				grow(n);
+		}
+
+		/**
+		 * destroy the elements, keeping the storage.
+		 */
+		void clear()
+		{
+			for (size_t i = 0; i < Size; i++)
+				Data[i].~T();
+			Size = 0;
+		}
+
+		size_t size() const { return Size; }
+
+		size_t capacity() const { return Cap; }
+
+		bool empty() const { return Size == 0; }
+
+		/**
+		 * check the order of every level, for soak tests.
+		 */
+		bool validate() const
+		{
+			for (size_t i = 1; i < Size; i++)
+				for (size_t a = parent(i);; a = parent(a))
+				{
+					if (better(i, a, on_min_level(a)))
+						return false;
+					if (!a)
+						break;
+				}
+			return true;
+		}
+	};
+}
+
+#endif
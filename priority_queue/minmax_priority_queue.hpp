@@ -0,0 +1,67 @@
+#ifndef SJTU_MINMAX_PRIORITY_QUEUE_HPP
+#define SJTU_MINMAX_PRIORITY_QUEUE_HPP
+
+// a double-ended priority queue: both the least and the greatest element in one structure.
+
+#include <cstddef>
+#include <functional>
+#include "exceptions.hpp"
+#include "minmax_heap.hpp"
+
+namespace sjtu
+{
+	/**
+	 * replaces a pair of mirrored priority_queues (std::less and std::greater) with a single
+	 * min-max heap: every element is stored once and push / pop_min / pop_max are O(log n).
+	 */
+	template <typename T, class Compare = std::less<T> >
+	class minmax_priority_queue
+	{
+	private:
+		minmax_heap<T, Compare> Heap;
+
+	public:
+		explicit minmax_priority_queue(const Compare &cmp = Compare()) : Heap(cmp) {}
+
+		/**
+		 * the least element.
+		 * throw container_is_empty if empty() returns true.
+		 */
+		const T &top_min() const { return Heap.min(); }
+
+		/**
+		 * the greatest element.
+		 * throw container_is_empty if empty() returns true.
+		 */
+		const T &top_max() const { return Heap.max(); }
+
+		void push(const T &e) { Heap.push(e); }
+
+		/**
+		 * throw container_is_empty if empty() returns true.
+		 */
+		void pop_min() { Heap.pop_min(); }
+
+		void pop_max() { Heap.pop_max(); }
+
+		size_t size() const { return Heap.size(); }
+
+		bool empty() const { return Heap.empty(); }
+
+		void clear() { Heap.clear(); }
+
+		/**
+		 * move the elements of other into this and clear other, like priority_queue::merge.
+		 * an array heap cannot be merged in O(log n): a small other is pushed element by element
+		 * and a large one is appended and rebuilt, O(min(m log(n + m), n + m)) for sizes n and m.
+		 */
+		void merge(minmax_priority_queue &other) { Heap.merge(other.Heap); }
+
+		/**
+		 * check the order of every level, for soak tests.
+		 */
+		bool validate() const { return Heap.validate(); }
+	};
+}
+
+#endif
@@ -7,32 +7,47 @@
 
 namespace sjtu {
 
+/**
+ * the messages are static strings, so making, copying and throwing an exception
+ * allocates nothing but the exception object the runtime needs anyway.
+ * a hot path that expects misses should still use the try_ / find_ functions
+ * of the containers instead of catching these.
+ */
 class exception {
 protected:
-	const std::string variant = "";
-	std::string detail = "";
+	const char *variant = "exception";
+	const char *detail = "";
+	exception(const char *variant, const char *detail) noexcept : variant(variant), detail(detail) {}
 public:
-	exception() {}
-	exception(const exception &ec) : variant(ec.variant), detail(ec.detail) {}
-	virtual std::string what() {
-		return variant + " " + detail;
+	exception() noexcept {}
+	exception(const exception &ec) noexcept : variant(ec.variant), detail(ec.detail) {}
+	virtual ~exception() {}
+	virtual const char *what() const noexcept {
+		return variant;
+	}
+	const char *reason() const noexcept {
+		return detail;
 	}
 };
 
 class index_out_of_bound : public exception {
-	/* __________________________ */
+public:
+	explicit index_out_of_bound(const char *detail = "") noexcept : exception("index_out_of_bound", detail) {}
 };
 
 class runtime_error : public exception {
-	/* __________________________ */
+public:
+	explicit runtime_error(const char *detail = "") noexcept : exception("runtime_error", detail) {}
 };
 
 class invalid_iterator : public exception {
-	/* __________________________ */
+public:
+	explicit invalid_iterator(const char *detail = "") noexcept : exception("invalid_iterator", detail) {}
 };
 
 class container_is_empty : public exception {
-	/* __________________________ */
+public:
+	explicit container_is_empty(const char *detail = "") noexcept : exception("container_is_empty", detail) {}
 };
 }
 
@@ -43,14 +58,68 @@ class container_is_empty : public exception {
 
 #include <cstddef>
 #include <functional>
+#include <new>
+#include <ostream>
+#include <utility>
 // #include "exceptions.hpp"
 
 namespace sjtu
 {
 	/**
+	 * statistics policy of priority_queue which counts nothing.
+	 * every hook is empty so the counting calls vanish.
+	 */
+	struct heap_no_stats
+	{
+		void compare() {}
+		void enter() {}
+		void leave() {}
+		void alloc() {}
+		void free() {}
+		void reset() {}
+		void dump(std ::ostream &) const {}
+	};
+
+	/**
+	 * statistics policy of priority_queue which counts what Heap_Merge does.
+	 */
+	struct heap_stats
+	{
+		unsigned long long Comparisons, MergeSteps, Allocated, Freed;
+		int Depth, MaxDepth;
+
+		heap_stats() { reset(); }
+
+		void compare() { Comparisons++; }
+
+		void enter()
+		{
+			MergeSteps++;
+			if (++Depth > MaxDepth)
+				MaxDepth = Depth;
+		}
+
+		void leave() { Depth--; }
+		void alloc() { Allocated++; }
+		void free() { Freed++; }
+
+		void reset()
+		{
+			Comparisons = MergeSteps = Allocated = Freed = 0;
+			Depth = MaxDepth = 0;
+		}
+
+		void dump(std ::ostream &os) const
+		{
+			os << "comparisons " << Comparisons << ", merge steps " << MergeSteps << ", max merge depth " << MaxDepth << "\n"
+			   << "nodes allocated " << Allocated << ", freed " << Freed << "\n";
+		}
+	};
+
+	/**
  * a container like std::priority_queue which is a heap internal.
  */
-	template <typename T, class Compare = std::less<T> >
+	template <typename T, class Compare = std::less<T>, class Stats = heap_no_stats>
 	// typedef int T;
 	class priority_queue
 	{
@@ -66,34 +135,129 @@ namespace sjtu
 
 		public:
 			Node(const T &_Val) : Val(_Val), Left(nullptr), Right(nullptr) {}
+		};
 
-			~Node()
-			{
-				delete Left;
-				delete Right;
-			}
+		/**
+		 * a node taken out by pop_n / drain_sorted, kept for the next push.
+		 * no more are kept than the queue holds when they are taken out, the rest is freed,
+		 * so nodes that came in by merge() do not pile up. for the statistics a kept node
+		 * counts as freed, and as allocated again when a push takes it.
+		 */
+		struct Spare
+		{
+			Spare *Next;
 		};
 
 		Node *Root;
 		int Size;
 		Compare cmp;
+		Stats St;
+		Spare *Spares;
+		size_t SpareCnt;
+
+		Node *make(const T &e)
+		{
+			St.alloc();
+			if (!Spares)
+				return new Node(e);
+			Spare *s = Spares;
+			Spares = s->Next;
+			SpareCnt--;
+			return new (s) Node(e);
+		}
+
+		void recycle(Node *x)
+		{
+			x->~Node();
+			St.free();
+			if (SpareCnt >= size_t(Size))
+			{
+				::operator delete(x);
+				return;
+			}
+			Spares = new (x) Spare{Spares};
+			SpareCnt++;
+		}
+
+		/**
+		 * F[0, Cnt) is an array heap of the roots of subtrees, the greatest value first.
+		 */
+		void frontier_push(Node **F, size_t &Cnt, Node *x)
+		{
+			size_t i = Cnt++;
+			for (; i && cmp(F[(i - 1) / 2]->Val, x->Val); i = (i - 1) / 2)
+				F[i] = F[(i - 1) / 2];
+			F[i] = x;
+		}
+
+		Node *frontier_pop(Node **F, size_t &Cnt)
+		{
+			Node *Top = F[0], *x = F[--Cnt];
+			size_t i = 0;
+			for (;;)
+			{
+				size_t c = 2 * i + 1;
+				if (c >= Cnt)
+					break;
+				if (c + 1 < Cnt && cmp(F[c]->Val, F[c + 1]->Val))
+					c++;
+				if (!cmp(x->Val, F[c]->Val))
+					break;
+				F[i] = F[c];
+				i = c;
+			}
+			if (Cnt)
+				F[i] = x;
+			return Top;
+		}
 
 	public:
 		/**
 		 * TODO constructors
 		 */
-		priority_queue() : Root(nullptr), Size(0) {}
+		priority_queue() : Root(nullptr), Size(0), Spares(nullptr), SpareCnt(0) {}
 
-		void Copy(Node *&x, const Node *const &y)
+		/**
+		 * the left paths of a skew heap can be as long as the heap (sorted pushes),
+		 * so they are walked in a loop and only right children recurse.
+		 */
+		void Copy(Node *&x, const Node *y)
 		{
-			if (!y)
-				return;
-			x = new Node(y->Val);
-			Copy(x->Left, y->Left);
-			Copy(x->Right, y->Right);
+			Node **p = &x;
+			for (; y; y = y->Left)
+			{
+				*p = new Node(y->Val);
+				St.alloc();
+				Copy((*p)->Right, y->Right);
+				p = &(*p)->Left;
+			}
+			*p = nullptr;
+		}
+
+		/**
+		 * free a tree without recursion: rotate left children up until there is none.
+		 */
+		void Destroy(Node *x)
+		{
+			while (x)
+			{
+				if (Node *l = x->Left)
+				{
+					x->Left = l->Right;
+					l->Right = x;
+					x = l;
+				}
+				else
+				{
+					Node *r = x->Right;
+					delete x;
+					St.free();
+					x = r;
+				}
+			}
 		}
 
-		priority_queue(const priority_queue &other)
+		priority_queue(const priority_queue &other) : Spares(nullptr), SpareCnt(0)
 		{
 			Size = other.Size;
 			cmp = other.cmp;
@@ -102,7 +266,16 @@ namespace sjtu
 		/**
 		 * TODO deconstructor
 		 */
-		~priority_queue() { delete Root; }
+		~priority_queue()
+		{
+			Destroy(Root);
+			while (Spares)
+			{
+				Spare *s = Spares;
+				Spares = s->Next;
+				::operator delete(s);
+			}
+		}
 		/**
 		 * TODO Assignment operator
 		 */
@@ -112,7 +285,7 @@ namespace sjtu
 				return *this;
 			Size = other.Size;
 			cmp = other.cmp;
-			delete Root;
+			Destroy(Root);
 			Copy(Root, other.Root);
 			return *this;
 		}
@@ -133,6 +306,8 @@ namespace sjtu
 			if (!x || !y)
 				return x ? x : y;
 
+			St.enter();
+			St.compare();
 			if (cmp(x->Val, y->Val))
 				std ::swap(x, y);
 
@@ -141,6 +316,7 @@ namespace sjtu
 			
 				std ::swap(x->Left, x->Right);
 
+			St.leave();
 			return x;
 		}
 
@@ -151,7 +327,7 @@ namespace sjtu
 		void push(const T &e)
 		{
 			Size++;
-			Node *NewNode = new Node(e);
+			Node *NewNode = make(e);
 			Root = Heap_Merge(Root, NewNode);
 		}
 		/**
@@ -166,11 +342,91 @@ namespace sjtu
 				
 			Size--;
 			Node *Left = Root->Left, *Right = Root->Right;
-			Root->Left = Root->Right = nullptr;
 			delete Root;
+			St.free();
 
 			Root = Heap_Merge(Left, Right);
 		}
+		/**
+		 * the top element, or nullptr if the queue is empty; nothing is thrown.
+		 */
+		const T *try_top() const
+		{
+			return empty() ? nullptr : &Root->Val;
+		}
+		/**
+		 * move the top element to out and delete it.
+		 * return false and leave out alone if the queue is empty.
+		 */
+		bool try_pop(T &out)
+		{
+			if (empty())
+				return false;
+			out = std ::move(Root->Val);
+			pop();
+			return true;
+		}
+		/**
+		 * pop() returning false instead of throwing if the queue is empty.
+		 */
+		bool try_pop()
+		{
+			if (empty())
+				return false;
+			pop();
+			return true;
+		}
+		/**
+		 * move the k greatest elements out to out, greatest first (all of them if there are fewer),
+		 * the same as k times top() and pop(), but the values are moved instead of copied
+		 * and the nodes are kept for later pushes, so a queue refilled every tick stops allocating.
+		 * taking everything is left to drain_sorted(), which needs no merge at all.
+		 */
+		template <class OutputIt>
+		OutputIt pop_n(size_t k, OutputIt out)
+		{
+			if (k >= size())
+				return drain_sorted(out);
+			for (; k; k--)
+			{
+				Node *x = Root, *Left = x->Left, *Right = x->Right;
+				*out++ = std ::move(x->Val);
+				recycle(x);
+				Root = Heap_Merge(Left, Right);
+				Size--;
+			}
+			return out;
+		}
+
+		/**
+		 * move every element out to out, greatest first, leaving the queue empty.
+		 * the nodes are visited best-first through an array heap of the subtrees not yet taken,
+		 * so nothing is merged, and they are kept for later pushes as in pop_n.
+		 */
+		template <class OutputIt>
+		OutputIt drain_sorted(OutputIt out)
+		{
+			if (!Root)
+				return out;
+			Node **F = static_cast<Node **>(::operator new((size() + 1) * sizeof(Node *)));
+			size_t Cnt = 0;
+			frontier_push(F, Cnt, Root);
+			while (Cnt)
+			{
+				Node *x = frontier_pop(F, Cnt);
+				*out++ = std ::move(x->Val);
+				if (x->Left)
+					frontier_push(F, Cnt, x->Left);
+				if (x->Right)
+					frontier_push(F, Cnt, x->Right);
+				recycle(x);
+			}
+			::operator delete(F);
+			Root = nullptr;
+			Size = 0;
+			return out;
+		}
+
 		/**
 		 * return the number of the elements.
 		 */
@@ -196,6 +452,59 @@ namespace sjtu
 			other.Root = nullptr;
 			other.Size = 0;
 		}
+
+		/**
+		 * the nodes kept by pop_n / drain_sorted for later pushes.
+		 */
+		size_t spares() const
+		{
+			return SpareCnt;
+		}
+
+		/**
+		 * counters of the statistics policy, see heap_stats.
+		 */
+		const Stats &stats() const
+		{
+			return St;
+		}
+
+		void reset_stats()
+		{
+			St.reset();
+		}
+
+		void dump_stats(std ::ostream &os) const
+		{
+			os << "size " << Size << "\n";
+			St.dump(os);
+		}
+
+		/**
+		 * check that no child beats its parent and that Size matches the nodes, for soak tests.
+		 */
+		bool validate() const
+		{
+			int Cnt = 0;
+			return validate(Root, Cnt) && Cnt == Size;
+		}
+
+	private:
+		/**
+		 * the left path in a loop, only right children recurse, as in Copy.
+		 */
+		bool validate(const Node *x, int &Cnt) const
+		{
+			for (; x; x = x->Left)
+			{
+				Cnt++;
+				if ((x->Left && cmp(x->Val, x->Left->Val)) || (x->Right && cmp(x->Val, x->Right->Val)))
+					return false;
+				if (!validate(x->Right, Cnt))
+					return false;
+			}
+			return true;
+		}
 	};
 
 }
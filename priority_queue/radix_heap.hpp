@@ -0,0 +1,272 @@
+#ifndef SJTU_RADIX_HEAP_HPP
+#define SJTU_RADIX_HEAP_HPP
+
+// a priority queue for unsigned integer priorities that are extracted in increasing order.
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "utility.hpp"
+#include "exceptions.hpp"
+
+namespace sjtu
+{
+	/**
+	 * the priority of an element of radix_heap as an unsigned integer, smaller comes first.
+	 * integers are their own priority (signed ones with the sign bit flipped to keep the order),
+	 * a pair is prioritized by its first member, as in (distance, vertex) for Dijkstra.
+	 */
+	template <class T, class = void>
+	struct radix_heap_key;
+
+	template <class T>
+	struct radix_heap_key<T, typename std::enable_if<std::is_integral<T>::value>::type>
+	{
+		typedef typename std::make_unsigned<T>::type type;
+
+		type operator()(const T &x) const
+		{
+			return std::is_signed<T>::value ? type(x) ^ type(type(1) << (std::numeric_limits<type>::digits - 1)) : type(x);
+		}
+	};
+
+	template <class K, class V>
+	struct radix_heap_key<pair<K, V> >
+	{
+		typedef typename radix_heap_key<K>::type type;
+
+		type operator()(const pair<K, V> &x) const { return radix_heap_key<K>()(x.first); }
+	};
+
+	/**
+	 * a monotone radix heap: top() is the element of the smallest priority,
+	 * and no element may be pushed with a priority below the last one seen at the top,
+	 * as in Dijkstra or an event simulation whose clock never goes back.
+	 *
+	 * bucket 0 holds the elements equal to Last, the current minimum, bucket i those whose
+	 * highest bit differing from Last is bit i - 1. when bucket 0 runs dry, the first nonempty
+	 * bucket is emptied into lower ones around its minimum, and an element only ever moves down,
+	 * so push is O(1) and pop amortized O(log C) for priorities below C.
+	 * buckets keep their storage when emptied, so a heap of steady size stops allocating.
+	 */
+	template <class T, class KeyOf = radix_heap_key<T> >
+	class radix_heap
+	{
+	private:
+		typedef typename std::decay<decltype(std::declval<KeyOf>()(std::declval<const T &>()))>::type Key;
+
+		static_assert(std::is_unsigned<Key>::value, "the priority of a radix_heap has to be an unsigned integer");
+		static_assert(std::numeric_limits<Key>::digits <= 64, "priorities up to 64 bits");
+
+		static const int Bits = std::numeric_limits<Key>::digits;
+
+		struct bucket
+		{
+			T *Data;
+			size_t Size, Cap;
+
+			bucket() : Data(nullptr), Size(0), Cap(0) {}
+
+			void grow()
+			{
+				size_t NewCap = Cap ? Cap * 2 : 8;
+				T *NewData = static_cast<T *>(::operator new(NewCap * sizeof(T)));
+				for (size_t i = 0; i < Size; i++)
+				{
+					new (NewData + i) T(std ::move(Data[i]));
+					Data[i].~T();
+				}
+				::operator delete(Data);
+				Data = NewData;
+				Cap = NewCap;
+			}
+
+			void push(T &&x)
+			{
+				if (Size == Cap)
+					grow();
+				new (Data + Size++) T(std ::move(x));
+			}
+
+			/**
+			 * destroy the elements but keep the storage.
+			 */
+			void clear()
+			{
+				for (size_t i = 0; i < Size; i++)
+					Data[i].~T();
+				Size = 0;
+			}
+
+			void release()
+			{
+				clear();
+				::operator delete(Data);
+				Data = nullptr;
+				Cap = 0;
+			}
+		};
+
+		// top() settles the buckets lazily and stays const to the outside
+		mutable bucket B[Bits + 1];
+		mutable Key Last;
+		mutable unsigned long long Used; // bit i is set when B[i] is not empty
+		mutable bool Far;				 // the same for B[64], which only exists for 64 bit priorities
+		size_t Size;
+		KeyOf key;
+
+		/**
+		 * 1 + the highest bit where k differs from Last, 0 if it does not.
+		 */
+		int slot(Key k) const
+		{
+			return k == Last ? 0 : 64 - __builtin_clzll((unsigned long long)(k ^ Last));
+		}
+
+		void put(T &&x, int i) const
+		{
+			B[i].push(std ::move(x));
+			mark(i);
+		}
+
+		void mark(int i) const
+		{
+			if (i < 64)
+				Used |= 1ull << i;
+			else
+				Far = true;
+		}
+
+		void unmark(int i) const
+		{
+			if (i < 64)
+				Used &= ~(1ull << i);
+			else
+				Far = false;
+		}
+
+		/**
+		 * make sure B[0] holds the smallest elements.
+		 */
+		void settle() const
+		{
+			if (B[0].Size)
+				return;
+			int i = Used ? __builtin_ctzll(Used) : Bits;
+			bucket &b = B[i];
+			Key Min = key(b.Data[0]);
+			for (size_t j = 1; j < b.Size; j++)
+			{
+				Key k = key(b.Data[j]);
+				if (k < Min)
+					Min = k;
+			}
+			Last = Min;
+			unmark(i);
+			for (size_t j = 0; j < b.Size; j++)
+				put(std ::move(b.Data[j]), slot(key(b.Data[j])));
+			b.clear();
+		}
+
+		void copy_from(const radix_heap &other)
+		{
+			Last = other.Last;
+			Used = other.Used;
+			Far = other.Far;
+			Size = other.Size;
+			key = other.key;
+			for (int i = 0; i <= Bits; i++)
+				for (size_t j = 0; j < other.B[i].Size; j++)
+				{
+					T x(other.B[i].Data[j]);
+					B[i].push(std ::move(x));
+				}
+		}
+
+	public:
+		radix_heap() : Last(0), Used(0), Far(false), Size(0) {}
+
+		radix_heap(const radix_heap &other) { copy_from(other); }
+
+		~radix_heap()
+		{
+			for (int i = 0; i <= Bits; i++)
+				B[i].release();
+		}
+
+		radix_heap &operator=(const radix_heap &other)
+		{
+			if (this == &other)
+				return *this;
+			clear();
+			copy_from(other);
+			return *this;
+		}
+
+		/**
+		 * the element of the smallest priority.
+		 * throw container_is_empty if empty() returns true.
+		 */
+		const T &top() const
+		{
+			if (empty())
+				throw container_is_empty();
+			settle();
+			return B[0].Data[B[0].Size - 1];
+		}
+
+		/**
+		 * throw runtime_error if the priority of e is below the last top.
+		 */
+		void push(const T &e)
+		{
+			T x(e);
+			push(std ::move(x));
+		}
+
+		void push(T &&e)
+		{
+			Key k = key(e);
+			if (k < Last)
+				throw runtime_error();
+			put(std ::move(e), slot(k));
+			Size++;
+		}
+
+		/**
+		 * delete the top element.
+		 * throw container_is_empty if empty() returns true.
+		 */
+		void pop()
+		{
+			if (empty())
+				throw container_is_empty();
+			settle();
+			B[0].Data[--B[0].Size].~T();
+			if (!B[0].Size)
+				unmark(0);
+			Size--;
+		}
+
+		size_t size() const { return Size; }
+
+		bool empty() const { return Size == 0; }
+
+		/**
+		 * remove every element, keeping the bucket storage; the priority floor goes back to 0.
+		 */
+		void clear()
+		{
+			for (int i = 0; i <= Bits; i++)
+				B[i].clear();
+			Used = 0;
+			Far = false;
+			Size = 0;
+			Last = 0;
+		}
+	};
+}
+
+#endif
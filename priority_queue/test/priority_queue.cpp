@@ -0,0 +1,459 @@
+// the heaps of the suite against a std::multiset of the same elements: priority_queue,
+// minmax_priority_queue, keyed_priority_queue, bounded_priority_queue, radix_heap,
+// external_priority_queue with a budget small enough to spill, and concurrent_priority_queue
+// fed by several producers.
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <thread>
+#include <vector>
+#include "test.hpp"
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+#include "minmax_priority_queue.hpp"
+#include "keyed_priority_queue.hpp"
+#include "bounded_priority_queue.hpp"
+#include "radix_heap.hpp"
+#include "external_priority_queue.hpp"
+#include "concurrent_priority_queue.hpp"
+
+void heap(long long ops, int values)
+{
+	sjtu::priority_queue<int> q;
+	std::multiset<int> ref;
+	for (long long i = 0; i < ops; i++)
+	{
+		int x = int(test::below(values));
+		switch (test::below(10))
+		{
+		case 0:
+		case 1:
+		case 2:
+		case 3:
+			q.push(x), ref.insert(x);
+			break;
+		case 4:
+		case 5:
+			if (ref.empty())
+			{
+				CHECK_THROWS(q.pop(), sjtu::container_is_empty);
+				CHECK(!q.try_top());
+			}
+			else
+			{
+				int out = -1;
+				CHECK(q.top() == *ref.rbegin() && *q.try_top() == q.top());
+				CHECK(q.try_pop(out) && out == *ref.rbegin());
+				ref.erase(std::prev(ref.end()));
+			}
+			break;
+		case 6:
+		{
+			// a merge with a second queue built on the side, which is left empty;
+			// merges only add while the queue is small, so that validate() stays cheap
+			sjtu::priority_queue<int> other;
+			for (long long n = ref.size() < 4096 ? test::below(50) : 0; n; n--)
+			{
+				int y = int(test::below(values));
+				other.push(y), ref.insert(y);
+			}
+			q.merge(other);
+			CHECK(other.empty() && other.validate());
+			break;
+		}
+		case 7:
+		{
+			std::vector<int> out;
+			size_t k = size_t(test::below(20));
+			q.pop_n(k, std::back_inserter(out));
+			CHECK(out.size() == std::min(k, ref.size()));
+			for (size_t j = 0; j < out.size(); j++)
+			{
+				CHECK(out[j] == *ref.rbegin());
+				ref.erase(std::prev(ref.end()));
+			}
+			break;
+		}
+		case 8:
+			if (test::below(200) == 0)
+			{
+				sjtu::priority_queue<int> c(q), d;
+				d = c;
+				std::vector<int> out;
+				d.drain_sorted(std::back_inserter(out));
+				CHECK(d.empty() && out.size() == ref.size());
+				CHECK(std::equal(out.begin(), out.end(), ref.rbegin()));
+			}
+			break;
+		default:
+			CHECK(q.size() == ref.size() && q.empty() == ref.empty());
+			break;
+		}
+		if (i % 64 == 0)
+			CHECK(q.validate() && q.size() == ref.size());
+	}
+}
+
+/**
+ * the statistics of priority_queue count a node as allocated when a push takes it, new or
+ * kept from an earlier pop_n / drain_sorted, and as freed when a pop gives it up, kept or
+ * not, so their difference is the size; no more nodes are kept than the queue ever held.
+ */
+void counted(long long ops)
+{
+	sjtu::priority_queue<int, std::less<int>, sjtu::heap_stats> q;
+	size_t Peak = 0;
+	std::vector<int> out;
+	for (long long i = 0; i < ops; i++)
+	{
+		switch (test::below(4))
+		{
+		case 0:
+		case 1:
+			q.push(int(test::below(1000)));
+			break;
+		case 2:
+			q.try_pop();
+			break;
+		default:
+			out.clear();
+			if (test::below(50) == 0)
+				q.drain_sorted(std::back_inserter(out));
+			else
+				q.pop_n(size_t(test::below(20)), std::back_inserter(out));
+			break;
+		}
+		Peak = std::max(Peak, q.size());
+		CHECK(q.stats().Allocated - q.stats().Freed == q.size() && q.spares() <= Peak);
+	}
+}
+
+/**
+ * sorted pushes make the left path as long as the heap, which validate(), copies and
+ * the destructor have to walk without running out of stack.
+ */
+void sorted(int n)
+{
+	for (int dir : {1, -1})
+	{
+		sjtu::priority_queue<int> q;
+		for (int i = 0; i < n; i++)
+			q.push(dir * i);
+		CHECK(q.validate() && q.size() == size_t(n));
+		sjtu::priority_queue<int> c(q);
+		CHECK(c.validate() && c.top() == (dir > 0 ? n - 1 : 0));
+		for (int i = 0; i < 1000; i++)
+			c.pop();
+		CHECK(c.validate() && c.size() == size_t(n - 1000));
+	}
+}
+
+void minmax(long long ops, int values)
+{
+	sjtu::minmax_priority_queue<int> q;
+	std::multiset<int> ref;
+	for (long long i = 0; i < ops; i++)
+	{
+		int x = int(test::below(values));
+		switch (test::below(6))
+		{
+		case 0:
+		case 1:
+			q.push(x), ref.insert(x);
+			break;
+		case 2:
+			if (ref.empty())
+				CHECK_THROWS(q.pop_min(), sjtu::container_is_empty);
+			else
+			{
+				CHECK(q.top_min() == *ref.begin());
+				q.pop_min(), ref.erase(ref.begin());
+			}
+			break;
+		case 3:
+			if (ref.empty())
+				CHECK_THROWS(q.top_max(), sjtu::container_is_empty);
+			else
+			{
+				CHECK(q.top_max() == *ref.rbegin());
+				q.pop_max(), ref.erase(std::prev(ref.end()));
+			}
+			break;
+		case 4:
+		{
+			sjtu::minmax_priority_queue<int> other;
+			for (long long n = ref.size() < 4096 ? test::below(test::below(8) ? 10 : 2000) : 0; n; n--)
+			{
+				int y = int(test::below(values));
+				other.push(y), ref.insert(y);
+			}
+			q.merge(other);
+			CHECK(other.empty());
+			break;
+		}
+		default:
+			if (test::below(500) == 0)
+				q.clear(), ref.clear();
+			break;
+		}
+		if (i % 64 == 0)
+			CHECK(q.validate() && q.size() == ref.size());
+	}
+}
+
+/**
+ * an element too big to move around, ordered by Id.
+ */
+struct order
+{
+	long long Id, Payload[7];
+};
+
+struct by_id
+{
+	long long operator()(const order &o) const { return o.Id; }
+};
+
+void keyed(long long ops, int values)
+{
+	typedef sjtu::keyed_priority_queue<order, by_id> Queue;
+	Queue q;
+	std::multiset<long long> ref;
+	for (long long i = 0; i < ops; i++)
+	{
+		order o = {test::below(values), {}};
+		o.Payload[6] = o.Id * 7;
+		switch (test::below(6))
+		{
+		case 0:
+		case 1:
+			q.push(o), ref.insert(o.Id);
+			break;
+		case 2:
+		case 3:
+			if (ref.empty())
+				CHECK_THROWS(q.pop(), sjtu::container_is_empty);
+			else
+			{
+				order out;
+				CHECK(q.top_key() == *ref.rbegin() && q.top().Id == q.top_key());
+				CHECK(q.try_pop(out) && out.Id == *ref.rbegin() && out.Payload[6] == out.Id * 7);
+				ref.erase(std::prev(ref.end()));
+			}
+			break;
+		case 4:
+		{
+			// a merge, small or big, also from a queue that popped some of its elements
+			Queue other;
+			for (long long n = ref.size() < 4096 ? test::below(test::below(4) ? 10 : 500) : 0; n; n--)
+			{
+				order p = {test::below(values), {}};
+				p.Payload[6] = p.Id * 7;
+				other.push(p);
+			}
+			for (long long n = test::below(5); n && !other.empty(); n--)
+				other.pop();
+			Queue copy(other);
+			while (!copy.empty())
+				ref.insert(copy.top_key()), copy.pop();
+			q.merge(other);
+			CHECK(other.empty() && other.validate());
+			break;
+		}
+		default:
+			if (test::below(500) == 0)
+			{
+				Queue c(q);
+				q.clear();
+				CHECK(q.empty());
+				q = c;
+			}
+			break;
+		}
+		if (i % 64 == 0)
+			CHECK(q.validate() && q.size() == ref.size());
+	}
+}
+
+void bounded(long long ops, int values)
+{
+	for (size_t k : {size_t(0), size_t(1), size_t(7), size_t(100)})
+	{
+		sjtu::bounded_priority_queue<int> q(k);
+		std::multiset<int> ref;
+		for (long long i = 0; i < ops; i++)
+		{
+			int x = int(test::below(values));
+			if (test::below(8))
+			{
+				ref.insert(x);
+				bool kept = ref.size() <= k || x > *ref.begin();
+				if (ref.size() > k)
+					ref.erase(ref.begin());
+				CHECK(q.push(x) == kept);
+			}
+			else if (!ref.empty())
+			{
+				CHECK(q.top() == *ref.rbegin() && q.bottom() == *ref.begin());
+				q.pop(), ref.erase(std::prev(ref.end()));
+			}
+			CHECK(q.size() == ref.size());
+		}
+	}
+}
+
+void radix(long long ops, unsigned long long step)
+{
+	sjtu::radix_heap<unsigned long long> q;
+	std::multiset<unsigned long long> ref;
+	unsigned long long last = 0;
+	for (long long i = 0; i < ops; i++)
+	{
+		if (test::below(5) < 3)
+		{
+			// up to step past the floor, without wrapping around past the greatest priority
+			unsigned long long room = ~0ULL - last;
+			unsigned long long x = last + (room < step ? test::rng()() % (room + 1) : test::rng()() % step);
+			q.push(x), ref.insert(x);
+		}
+		else if (!ref.empty())
+		{
+			CHECK(q.top() == *ref.begin());
+			last = q.top();
+			q.pop(), ref.erase(ref.begin());
+		}
+		else
+			CHECK_THROWS(q.top(), sjtu::container_is_empty);
+		if (last)
+			CHECK_THROWS(q.push(last - 1), sjtu::runtime_error);
+		CHECK(q.size() == ref.size());
+	}
+}
+
+void external(long long n)
+{
+	// 16 KiB of budget for a few hundred thousand elements: many runs, and merges of runs
+	sjtu::external_priority_queue<long long> q(1 << 14);
+	std::multiset<long long> ref;
+	for (long long i = 0; i < n; i++)
+	{
+		if (test::below(3))
+		{
+			long long x = test::below(1LL << 40);
+			q.push(x), ref.insert(x);
+		}
+		else if (!ref.empty())
+		{
+			CHECK(q.top() == *ref.rbegin());
+			q.pop(), ref.erase(std::prev(ref.end()));
+		}
+	}
+	for (; !ref.empty(); ref.erase(std::prev(ref.end())))
+	{
+		CHECK(q.top() == *ref.rbegin());
+		q.pop();
+	}
+	CHECK(q.empty());
+	CHECK_THROWS(q.pop(), sjtu::container_is_empty);
+}
+
+/**
+ * every element pushed by the producers comes out exactly once, and each consumer sees
+ * the elements of one pop_batch in order.
+ */
+void concurrent(int producers, int consumers, int per_producer)
+{
+	sjtu::concurrent_priority_queue<long long> q;
+	std::vector<long long> none;
+	CHECK_THROWS(q.pop_batch(0, std::back_inserter(none)), sjtu::runtime_error);
+	std::vector<std::vector<long long> > got(consumers);
+	std::vector<std::thread> threads;
+	for (int c = 0; c < consumers; c++)
+		threads.emplace_back([&, c] {
+			std::vector<long long> batch;
+			for (;;)
+			{
+				batch.clear();
+				size_t n = c % 2 ? q.pop_batch(16, std::back_inserter(batch)) : 0;
+				long long x;
+				if (c % 2 == 0 && q.pop_wait(x))
+					batch.push_back(x), n = 1;
+				if (!n)
+					return;
+				CHECK(n == batch.size() && std::is_sorted(batch.rbegin(), batch.rend()));
+				got[c].insert(got[c].end(), batch.begin(), batch.end());
+			}
+		});
+	std::vector<std::thread> pushers;
+	for (int p = 0; p < producers; p++)
+		pushers.emplace_back([&, p] {
+			sjtu::priority_queue<long long> local;
+			for (int i = 0; i < per_producer; i++)
+			{
+				long long x = (long long)p * per_producer + i;
+				if (i % 3)
+					CHECK(q.push(x));
+				else
+					local.push(x);
+				if (local.size() == 50)
+					CHECK(q.push_batch(local) && local.empty());
+			}
+			CHECK(q.push_batch(local));
+		});
+	for (std::thread &t : pushers)
+		t.join();
+	q.close();
+	CHECK(!q.push(-1));
+	for (std::thread &t : threads)
+		t.join();
+	std::vector<long long> all;
+	for (int c = 0; c < consumers; c++)
+		all.insert(all.end(), got[c].begin(), got[c].end());
+	std::sort(all.begin(), all.end());
+	CHECK(all.size() == size_t(producers) * per_producer);
+	for (size_t i = 0; i < all.size(); i++)
+		CHECK(all[i] == (long long)i);
+}
+
+/**
+ * rounds of batches handed in by push_batch() and taken out by pop_batch(): the nodes of
+ * the batches are kept as spares at most up to the size of a round, not once per round.
+ */
+void batch_rounds(int rounds, int per_round)
+{
+	sjtu::concurrent_priority_queue<long long> q;
+	std::vector<long long> out;
+	for (int round = 0; round < rounds; round++)
+	{
+		sjtu::concurrent_priority_queue<long long>::local_queue local;
+		for (int i = 0; i < per_round; i++)
+			local.push(test::below(1 << 30));
+		CHECK(q.push_batch(local) && local.empty());
+		out.clear();
+		while (!q.empty())
+			q.pop_batch(size_t(test::below(200)) + 1, std::back_inserter(out));
+		CHECK(out.size() == size_t(per_round) && std::is_sorted(out.rbegin(), out.rend()));
+		CHECK(q.spares() <= size_t(per_round));
+	}
+}
+
+int main()
+{
+	heap(300000, 1000);
+	heap(300000, 1 << 30);
+	counted(100000);
+	sorted(1000000);
+	minmax(300000, 100);
+	minmax(300000, 1 << 30);
+	keyed(300000, 1000);
+	keyed(300000, 1 << 30);
+	bounded(100000, 1000);
+	radix(300000, 1000);
+	radix(300000, 1ULL << 62);
+	external(200000);
+	concurrent(4, 4, 20000);
+	batch_rounds(200, 5000);
+	return 0;
+}
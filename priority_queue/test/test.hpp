@@ -0,0 +1,63 @@
+#ifndef SJTU_TEST_HPP
+#define SJTU_TEST_HPP
+
+// a tiny test harness.
+// a test drives a container with random operations, mirrors them on a reference container
+// from the standard library and checks that both agree; test.py at the top of the repository
+// builds every test with the sanitizers and runs it.
+// the first broken check prints where it is and exits with status 1.
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#define CHECK(cond)                                                                     \
+	do                                                                                  \
+	{                                                                                   \
+		if (!(cond))                                                                    \
+		{                                                                               \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			std::exit(1);                                                               \
+		}                                                                               \
+	} while (0)
+
+/**
+ * CHECK that an expression throws E.
+ */
+#define CHECK_THROWS(expr, E)   \
+	do                          \
+	{                           \
+		bool Thrown = false;    \
+		try                     \
+		{                       \
+			expr;               \
+		}                       \
+		catch (const E &)       \
+		{                       \
+			Thrown = true;      \
+		}                       \
+		CHECK(Thrown && #expr); \
+	} while (0)
+
+namespace test
+{
+	/**
+	 * the generator of a test, seeded from TEST_SEED in the environment when it is set so that
+	 * a failure found with another seed can be replayed.
+	 */
+	inline std::mt19937_64 &rng()
+	{
+		static std::mt19937_64 Rng(std::getenv("TEST_SEED") ? std::strtoull(std::getenv("TEST_SEED"), nullptr, 10) : 19260817);
+		return Rng;
+	}
+
+	/**
+	 * a uniform integer in [0, n).
+	 */
+	inline long long below(long long n)
+	{
+		return (long long)(rng()() % (unsigned long long)n);
+	}
+}
+
+#endif
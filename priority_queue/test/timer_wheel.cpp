@@ -0,0 +1,162 @@
+// timer_wheel against a std::map of the timers still pending: advance() fires exactly the
+// timers due, in the order of their deadlines, with deadlines from the next tick to 2^40
+// ticks ahead (past the wheels, in the far queue) and already passed ones, clock jumps of
+// any size, callbacks that schedule and cancel, and ids kept after their timer fired or was
+// cancelled, whose slot is reused by later timers.
+
+#include <map>
+#include <vector>
+#include "test.hpp"
+#include "exceptions.hpp"
+#include "timer_wheel.hpp"
+
+typedef sjtu::timer_wheel<long long> Wheel;
+
+/**
+ * a pending timer of the reference: when it is due, and its id in the wheel.
+ */
+struct pending
+{
+	Wheel::tick Due;
+	Wheel::id Id;
+};
+
+struct model
+{
+	Wheel w;
+	std::map<long long, pending> Ref; // by value, every timer gets its own
+	std::vector<Wheel::id> Gone;	   // ids of timers that fired or were cancelled
+	long long Serial = 0;
+
+	/**
+	 * a deadline from overdue to far past the wheels.
+	 */
+	Wheel::tick deadline()
+	{
+		static const Wheel::tick Spans[] = {4, 300, 70000, Wheel::tick(1) << 26, Wheel::tick(1) << 34, Wheel::tick(1) << 40};
+		Wheel::tick Now = w.now();
+		long long r = test::below(8);
+		if (r == 7)
+			return Now - Wheel::tick(test::below(Now < 100 ? Now + 1 : 100));
+		if (r == 6)
+			return Now + (Wheel::tick(1) << 32) + test::rng()() % (Wheel::tick(1) << 36);
+		return Now + test::rng()() % Spans[r];
+	}
+
+	void schedule(Wheel::tick d)
+	{
+		long long v = Serial++;
+		pending p = {d < w.now() ? w.now() : d, w.schedule(d, v)};
+		Ref[v] = p;
+	}
+
+	/**
+	 * cancel a pending timer, or try an id that is gone, which has to change nothing.
+	 */
+	void cancel()
+	{
+		if (!Gone.empty() && (Ref.empty() || test::below(3) == 0))
+		{
+			CHECK(!w.cancel(Gone[test::below((long long)Gone.size())]));
+			return;
+		}
+		if (Ref.empty())
+			return;
+		std::map<long long, pending>::iterator it = Ref.lower_bound(test::below(Serial));
+		if (it == Ref.end())
+			it = Ref.begin();
+		CHECK(w.cancel(it->second.Id));
+		Gone.push_back(it->second.Id);
+		Ref.erase(it);
+	}
+
+	void advance(Wheel::tick to)
+	{
+		Wheel::tick Last = w.now();
+		size_t Fired = 0;
+		size_t Cnt = w.advance(to, [&](Wheel::tick d, long long v) {
+			std::map<long long, pending>::iterator it = Ref.find(v);
+			CHECK(it != Ref.end());
+			CHECK(it->second.Due >= Last && it->second.Due <= to);
+			CHECK(w.now() == it->second.Due && (d == it->second.Due || d < it->second.Due));
+			Last = it->second.Due;
+			Gone.push_back(it->second.Id);
+			Ref.erase(it);
+			Fired++;
+			// now and then the callback schedules a timer due soon, or cancels another one
+			if (test::below(8) == 0)
+				schedule(w.now() + Wheel::tick(test::below(500)));
+			else if (test::below(8) == 0)
+				cancel();
+		});
+		CHECK(Cnt == Fired && w.now() == to);
+		for (std::map<long long, pending>::iterator it = Ref.begin(); it != Ref.end(); ++it)
+			CHECK(it->second.Due > to);
+	}
+};
+
+void soak(long long ops)
+{
+	static const Wheel::tick Steps[] = {1, 10, 300, 70000, Wheel::tick(1) << 26, Wheel::tick(1) << 33};
+	model m;
+	for (long long i = 0; i < ops; i++)
+	{
+		switch (test::below(8))
+		{
+		case 0:
+		case 1:
+		case 2:
+			m.schedule(m.deadline());
+			break;
+		case 3:
+		case 4:
+			m.cancel();
+			break;
+		case 5:
+		{
+			// the next due timer exactly, or the tick before it
+			Wheel::tick Due = ~Wheel::tick(0);
+			for (std::map<long long, pending>::iterator it = m.Ref.begin(); it != m.Ref.end(); ++it)
+				Due = it->second.Due < Due ? it->second.Due : Due;
+			if (Due != ~Wheel::tick(0))
+				m.advance(Due - (Due > m.w.now() ? Wheel::tick(test::below(2)) : 0));
+			break;
+		}
+		default:
+			m.advance(m.w.now() + test::rng()() % Steps[test::below(6)]);
+			break;
+		}
+		CHECK(m.w.size() == m.Ref.size());
+		if (m.Gone.size() > 100000)
+			m.Gone.erase(m.Gone.begin(), m.Gone.begin() + 50000);
+	}
+	CHECK_THROWS(m.w.advance(m.w.now() - 1, [](Wheel::tick, long long) {}), sjtu::runtime_error);
+	m.advance(m.w.now() + (Wheel::tick(1) << 41));
+	CHECK(m.w.empty());
+}
+
+/**
+ * far timers that are mostly cancelled, then the few kept ones fire in order.
+ */
+void far_cancel(long long n)
+{
+	model m;
+	std::vector<Wheel::id> Ids;
+	for (long long round = 0; round < 20; round++)
+	{
+		for (long long i = 0; i < n; i++)
+			m.schedule(m.w.now() + (Wheel::tick(1) << 33) + test::rng()() % (Wheel::tick(1) << 36));
+		while (m.Ref.size() > size_t(n / 50))
+			m.cancel();
+	}
+	m.advance(m.w.now() + (Wheel::tick(1) << 37));
+	CHECK(m.w.empty());
+}
+
+int main()
+{
+	for (int round = 0; round < 4; round++)
+		soak(100000);
+	far_cancel(20000);
+	return 0;
+}
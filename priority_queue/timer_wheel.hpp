@@ -0,0 +1,349 @@
+#ifndef SJTU_TIMER_WHEEL_HPP
+#define SJTU_TIMER_WHEEL_HPP
+
+// a timer queue with O(1) schedule and cancel, for many timers that are mostly cancelled.
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include "exceptions.hpp"
+#include "priority_queue.hpp"
+
+namespace sjtu
+{
+	/**
+	 * hierarchical timing wheels over integer ticks: 4 wheels of 256 slots, the first one a slot
+	 * per tick, each next one a slot per turn of the previous. a timer sits in the lowest wheel
+	 * whose turn contains its deadline and moves down a wheel when its slot comes up, so it is
+	 * touched at most 4 times before firing; schedule and cancel only link or unlink it.
+	 * deadlines 2^32 ticks or more ahead wait in a sjtu::priority_queue until they come in range;
+	 * a cancelled one is left there and skipped, until they are half of the queue and it is rebuilt.
+	 *
+	 * the timers are kept in a pool and named by an id, which stays safe to cancel after the
+	 * timer has fired or the slot is reused. advance() jumps over empty slots with bitmaps.
+	 */
+	template <typename T>
+	class timer_wheel
+	{
+	public:
+		typedef uint64_t tick;
+		typedef uint64_t id;
+
+	private:
+		static const int Bits = 8, Slots = 1 << Bits, Levels = 4;
+		static const uint32_t Nil = ~uint32_t(0);
+		static const uint16_t Free = 0xFFFF, Far = 0xFFFE;
+
+		struct timer
+		{
+			tick Deadline;
+			uint32_t Prev, Next, Gen;
+			uint16_t Where; // Level * Slots + slot, Far or Free
+			alignas(T) unsigned char Val[sizeof(T)];
+
+			T &val() { return *reinterpret_cast<T *>(Val); }
+		};
+
+		struct far_timer
+		{
+			tick Deadline;
+			uint32_t Index, Gen;
+		};
+
+		struct later
+		{
+			bool operator()(const far_timer &a, const far_timer &b) const { return a.Deadline > b.Deadline; }
+		};
+
+		timer *Pool;
+		uint32_t Cap, Used, FreeHead;
+		uint32_t Head[Levels * Slots];
+		uint64_t Busy[Levels][Slots / 64]; // bit s of level L is set when its slot s is not empty
+		priority_queue<far_timer, later> FarQueue;
+		size_t FarDead; // entries of FarQueue whose timer was cancelled
+		tick Now;
+		size_t Size;
+
+		static id make_id(uint32_t Index, uint32_t Gen) { return (id(Gen) << 32) | Index; }
+
+		void link(uint32_t i, int Where)
+		{
+			timer &t = Pool[i];
+			t.Where = uint16_t(Where);
+			t.Prev = Nil;
+			t.Next = Head[Where];
+			if (t.Next != Nil)
+				Pool[t.Next].Prev = i;
+			Head[Where] = i;
+			Busy[Where / Slots][Where % Slots / 64] |= uint64_t(1) << (Where % 64);
+		}
+
+		void unlink(uint32_t i)
+		{
+			timer &t = Pool[i];
+			if (t.Prev != Nil)
+				Pool[t.Prev].Next = t.Next;
+			else if ((Head[t.Where] = t.Next) == Nil)
+				Busy[t.Where / Slots][t.Where % Slots / 64] &= ~(uint64_t(1) << (t.Where % 64));
+			if (t.Next != Nil)
+				Pool[t.Next].Prev = t.Prev;
+		}
+
+		/**
+		 * put timer i in the wheel of its deadline relative to Now, or in the far queue.
+		 */
+		void place(uint32_t i)
+		{
+			tick d = Pool[i].Deadline < Now ? Now : Pool[i].Deadline;
+			for (int L = 0; L < Levels; L++)
+				if (!((d ^ Now) >> (Bits * (L + 1))))
+				{
+					link(i, L * Slots + int(d >> (Bits * L) & (Slots - 1)));
+					return;
+				}
+			Pool[i].Where = Far;
+			far_timer f = {d, i, Pool[i].Gen};
+			FarQueue.push(f);
+		}
+
+		uint32_t allocate()
+		{
+			if (FreeHead != Nil)
+			{
+				uint32_t i = FreeHead;
+				FreeHead = Pool[i].Next;
+				return i;
+			}
+			if (Used == Cap)
+			{
+				uint32_t NewCap = Cap ? Cap * 2 : 64;
+				timer *NewPool = static_cast<timer *>(::operator new(size_t(NewCap) * sizeof(timer)));
+				for (uint32_t j = 0; j < Used; j++)
+				{
+					new (NewPool + j) timer(Pool[j]);
+					if (Pool[j].Where != Free)
+					{
+						new (&NewPool[j].val()) T(std ::move(Pool[j].val()));
+						Pool[j].val().~T();
+					}
+				}
+				::operator delete(Pool);
+				Pool = NewPool;
+				Cap = NewCap;
+			}
+			Pool[Used].Gen = 0;
+			return Used++;
+		}
+
+		void release(uint32_t i)
+		{
+			timer &t = Pool[i];
+			t.val().~T();
+			t.Where = Free;
+			t.Gen++;
+			t.Next = FreeHead;
+			FreeHead = i;
+			Size--;
+		}
+
+		/**
+		 * the first slot of level L after the current one holding timers, as the tick it starts at.
+		 * return ~0 if there is none before the wheel turns.
+		 */
+		tick next_busy(int L) const
+		{
+			int Cur = int(Now >> (Bits * L) & (Slots - 1));
+			for (int s = Cur + 1; s < Slots;)
+			{
+				uint64_t w = Busy[L][s / 64] >> (s % 64);
+				if (w)
+				{
+					s += __builtin_ctzll(w);
+					tick Base = Now >> (Bits * (L + 1)) << (Bits * (L + 1));
+					return Base + (tick(s) << (Bits * L));
+				}
+				s = (s / 64 + 1) * 64;
+			}
+			return ~tick(0);
+		}
+
+		/**
+		 * false for an entry of the far queue whose timer was cancelled, its slot maybe reused.
+		 */
+		bool live(const far_timer &f) const { return Pool[f.Index].Gen == f.Gen && Pool[f.Index].Where == Far; }
+
+		/**
+		 * move timers of the far queue whose deadline came within 2^32 ticks into the wheels.
+		 */
+		void pull_far()
+		{
+			while (!FarQueue.empty() && !((FarQueue.top().Deadline ^ Now) >> (Bits * Levels)))
+			{
+				far_timer f = FarQueue.top();
+				FarQueue.pop();
+				if (live(f))
+					place(f.Index);
+				else
+					FarDead--;
+			}
+		}
+
+		/**
+		 * rebuild the far queue without the cancelled timers, O(m log m) for m entries once
+		 * m / 2 of them were cancelled, so that a workload cancelling most of its far timers
+		 * keeps the queue at twice the live ones.
+		 */
+		void trim_far()
+		{
+			priority_queue<far_timer, later> Kept;
+			far_timer f;
+			while (FarQueue.try_pop(f))
+				if (live(f))
+					Kept.push(f);
+			FarQueue.merge(Kept);
+			FarDead = 0;
+		}
+
+		/**
+		 * Now just moved: move down the slots that came up, highest wheel first.
+		 */
+		void cascade()
+		{
+			pull_far();
+			for (int L = Levels - 1; L > 0; L--)
+			{
+				if (Now & ((tick(1) << (Bits * L)) - 1))
+					continue;
+				int Where = L * Slots + int(Now >> (Bits * L) & (Slots - 1));
+				uint32_t i = Head[Where];
+				Head[Where] = Nil;
+				Busy[L][Where % Slots / 64] &= ~(uint64_t(1) << (Where % 64));
+				while (i != Nil)
+				{
+					uint32_t Next = Pool[i].Next;
+					place(i);
+					i = Next;
+				}
+			}
+		}
+
+		template <class F>
+		size_t fire(F &f)
+		{
+			int Where = int(Now & (Slots - 1));
+			size_t Cnt = 0;
+			while (Head[Where] != Nil)
+			{
+				uint32_t i = Head[Where];
+				unlink(i);
+				T Val(std ::move(Pool[i].val()));
+				tick Deadline = Pool[i].Deadline;
+				release(i);
+				Cnt++;
+				f(Deadline, Val);
+			}
+			return Cnt;
+		}
+
+	public:
+		/**
+		 * the clock starts at now.
+		 */
+		explicit timer_wheel(tick now = 0) : Pool(nullptr), Cap(0), Used(0), FreeHead(Nil), FarDead(0), Now(now), Size(0)
+		{
+			for (int i = 0; i < Levels * Slots; i++)
+				Head[i] = Nil;
+			for (int L = 0; L < Levels; L++)
+				for (int w = 0; w < Slots / 64; w++)
+					Busy[L][w] = 0;
+		}
+
+		timer_wheel(const timer_wheel &) = delete;
+
+		timer_wheel &operator=(const timer_wheel &) = delete;
+
+		~timer_wheel()
+		{
+			for (uint32_t i = 0; i < Used; i++)
+				if (Pool[i].Where != Free)
+					Pool[i].val().~T();
+			::operator delete(Pool);
+		}
+
+		/**
+		 * fire val at deadline; a deadline already passed fires at the next advance().
+		 */
+		id schedule(tick deadline, const T &val)
+		{
+			uint32_t i = allocate();
+			new (&Pool[i].val()) T(val);
+			Pool[i].Deadline = deadline;
+			place(i);
+			Size++;
+			return make_id(i, Pool[i].Gen);
+		}
+
+		/**
+		 * return false if the timer already fired or was cancelled.
+		 */
+		bool cancel(id t)
+		{
+			uint32_t i = uint32_t(t);
+			if (i >= Used || Pool[i].Gen != uint32_t(t >> 32) || Pool[i].Where == Free)
+				return false;
+			// a far timer stays in the far queue and is skipped there by its generation
+			bool InFar = Pool[i].Where == Far;
+			if (!InFar)
+				unlink(i);
+			release(i);
+			if (InFar && ++FarDead > FarQueue.size() / 2)
+				trim_far();
+			return true;
+		}
+
+		/**
+		 * move the clock to now and call f(deadline, value) for every timer due,
+		 * tick after tick; a callback may schedule and cancel timers.
+		 * throw runtime_error if now is before the clock.
+		 * return the number of timers fired.
+		 */
+		template <class F>
+		size_t advance(tick now, F f)
+		{
+			if (now < Now)
+				throw runtime_error();
+			size_t Cnt = fire(f);
+			while (Now < now)
+			{
+				tick Next = ~tick(0);
+				for (int L = 0; L < Levels; L++)
+				{
+					tick t = next_busy(L);
+					Next = t < Next ? t : Next;
+				}
+				// the next turn of the top wheel, when far timers may come in range
+				tick Turn = (Now >> (Bits * Levels) << (Bits * Levels)) + (tick(1) << (Bits * Levels));
+				if (!FarQueue.empty() && Turn < Next)
+					Next = Turn;
+				if (Next > now)
+				{
+					Now = now;
+					break;
+				}
+				Now = Next;
+				cascade();
+				Cnt += fire(f);
+			}
+			return Cnt;
+		}
+
+		tick now() const { return Now; }
+
+		size_t size() const { return Size; }
+
+		bool empty() const { return Size == 0; }
+	};
+}
+
+#endif
@@ -13,13 +13,15 @@ public:
 	constexpr pair() : first(), second() {}
 	pair(const pair &other) = default;
 	pair(pair &&other) = default;
-	pair(const T1 &x, const T2 &y) : first(x), second(y) {}
+	pair &operator=(const pair &other) = default;
+	pair &operator=(pair &&other) = default;
+	constexpr pair(const T1 &x, const T2 &y) : first(x), second(y) {}
 	template<class U1, class U2>
-	pair(U1 &&x, U2 &&y) : first(x), second(y) {}
+	constexpr pair(U1 &&x, U2 &&y) : first(x), second(y) {}
 	template<class U1, class U2>
-	pair(const pair<U1, U2> &other) : first(other.first), second(other.second) {}
+	constexpr pair(const pair<U1, U2> &other) : first(other.first), second(other.second) {}
 	template<class U1, class U2>
-	pair(pair<U1, U2> &&other) : first(other.first), second(other.second) {}
+	constexpr pair(pair<U1, U2> &&other) : first(other.first), second(other.second) {}
 };
 
 }
@@ -0,0 +1,58 @@
+#!/usr/bin/python3
+
+# build and run every test under map/test and priority_queue/test with AddressSanitizer and
+# UndefinedBehaviorSanitizer. a test is a program that checks itself, prints the first broken
+# check and exits with a nonzero status.
+#
+#     ./test.py                                    run everything
+#     ./test.py --only map --test art_map          a subset
+#     ./test.py --no-sanitize                      plain -O2 builds, faster and more iterations per second
+
+import argparse
+import glob
+import os
+import subprocess
+import sys
+
+root = os.path.dirname(os.path.abspath(__file__))
+build = os.path.join(root, '_test_build')
+suites = ('map', 'priority_queue')
+sanitize = ['-O1', '-g', '-fsanitize=address,undefined', '-fno-sanitize-recover=undefined', '-fno-omit-frame-pointer']
+
+
+def compile_test(suite, src, args):
+    exe = os.path.join(build, suite + '_' + os.path.splitext(os.path.basename(src))[0])
+    flags = ['-O2'] if args.no_sanitize else sanitize
+    cmd = ['g++'] + flags + ['-std=c++14', '-pthread', '-Wall', '-I' + os.path.join(root, suite), src, '-o', exe]
+    if subprocess.call(cmd) != 0:
+        return None
+    return exe
+
+
+def run():
+    p = argparse.ArgumentParser()
+    p.add_argument('--only', choices=suites)
+    p.add_argument('--test', help='only run tests whose file name contains this')
+    p.add_argument('--no-sanitize', action='store_true')
+    args = p.parse_args()
+
+    os.makedirs(build, exist_ok=True)
+    failed = []
+    for suite in suites:
+        if args.only and args.only != suite:
+            continue
+        for src in sorted(glob.glob(os.path.join(root, suite, 'test', '*.cpp'))):
+            if args.test and args.test not in os.path.basename(src):
+                continue
+            name = suite + '/' + os.path.basename(src)
+            exe = compile_test(suite, src, args)
+            ok = exe is not None and subprocess.call([exe], cwd=build) == 0
+            print('%-40s %s' % (name, 'ok' if ok else 'FAILED'))
+            if not ok:
+                failed.append(name)
+
+    if failed:
+        sys.exit('%d test(s) failed: %s' % (len(failed), ' '.join(failed)))
+
+
+run()